@@ -18,11 +18,19 @@
 #include <fstream>
 #include <iomanip>
 #include <sstream>
-#include <regex>
+#include <string_view>
 #include <map>
 #include <array>
 #include <unordered_map>
 
+#include "FX8010Bytecode.h"
+#include "FX8010Events.h"
+#include "FX8010Fixed.h"
+#include "FX8010JIT.h"
+#include "FX8010LogExp.h"
+#include "FX8010Resampler.h"
+#include "helpers.h"
+
 using namespace std;
 
 // Unterdrücke Warnungen:
@@ -44,22 +52,43 @@ using namespace std;
 namespace Klangraum
 {
 
+    class FX8010Lanes;
+    class FX8010HotSwap;
+
     class FX8010
     {
+        // Vektor-Engine fuer mehrere Instanzen (liest Programm und Registerlayout)
+        friend class FX8010Lanes;
+        // Programmwechsel im laufenden Betrieb (uebernimmt Register und TRAM)
+        friend class FX8010HotSwap;
+
     public:
         FX8010();
         FX8010(int numChannels);
         ~FX8010();
 
-        // Method to initialize lookup tables and other initialization tasks
+        // Method to initialize error map, special registers and other initialization tasks
         void initialize();
-        // Der eigentliche Prozess-Loop
+        // Der eigentliche Prozess-Loop, 1 Sample je Aufruf (Kompatibilitaets-Wrapper)
         std::vector<float> process(const std::vector<float> &inputSamples);
+        // Verarbeitet einen ganzen Hostblock, planar: inputs[Kanal][Sample], outputs[Kanal][Sample]
+        void processBlock(const float *const *inputs, float *const *outputs, int numFrames);
 
         // Gibt Anzahl der ausgeführten Instructions zurück
         int getInstructionCounter();
         // Sourcecode laden
         bool loadFile(const string &path);
+        // Sourcecode aus dem Speicher (z.B. Presets), sonst wie loadFile()
+        bool loadFromString(const std::string &source);
+        bool loadFromMemory(const char *data, size_t size);
+        // Vorübersetztes Programm (include/FX8010Bytecode.h, tools/da-compile.cpp), ohne Parser und
+        // Optimierer. Nur auf einer neuen Instanz. Die Datei wird per mmap gelesen, fuer viele Instanzen
+        // einmal mit BytecodeFile einblenden und loadBytecodeFromMemory() aufrufen.
+        bool loadBytecode(const std::string &path);
+        bool loadBytecodeFromMemory(const void *data, size_t size);
+        // Geladenes Programm als Bytecode, leer bzw. false ohne erfolgreich geladenes Programm
+        std::vector<uint8_t> getBytecode();
+        bool saveBytecode(const std::string &path);
         struct MyError // Vorwärtsdeklaration notwendig!
         {
             std::string errorDescription = "";
@@ -69,11 +98,145 @@ namespace Klangraum
         int setRegisterValue(const std::string &key, float value);
         float getRegisterValue(const std::string &key);
         vector<string> getControlRegisters();
+        // Kanal (IOIndex) eines INPUT/OUTPUT Registers, -1 wenn es keins ist
+        int getIOIndex(const std::string &registerName);
+
+        // Handle = Werteindex eines beschreibbaren Registers, -1 wenn es das Register nicht gibt oder es
+        // read-only ist (Literal, CONST). Einmal aufloesen, dann ohne Namenssuche lesen und schreiben.
+        // Gueltig bis zum naechsten loadFile().
+        int getRegisterHandle(const std::string &registerName);
+        // Ungueltige Handles (z.B. -1 aus getRegisterHandle()) werden ignoriert
+        inline void setRegisterValue(int handle, float value)
+        {
+            if (handle < 0 || handle >= constantSegmentStart)
+                return;
+            if (!smootherOf.empty() && smootherOf[handle] >= 0)
+                setSmoothingTarget(smootherOf[handle], value);
+            else
+                storeRegisterValue(handle, value);
+        }
+        // Ungueltige Handles liefern 0.0
+        inline float getRegisterValue(int handle)
+        {
+            if (handle < 0 || handle >= constantSegmentStart)
+                return 0.0f;
+            return loadRegisterValue(handle);
+        }
+        void setRegisterValues(const int *handles, const float *values, int count);
+
+        // Sample-genaue Automation: Events aus einem Thread (UI, Automation), processBlock() teilt den
+        // Block an den Zeitpunkten der Events.
+        // Wert gilt ab Host-Sample sampleTime (getSampleTime()), < 0 = ab dem naechsten processBlock().
+        // Events in aufsteigender Zeit schicken, ein verspaetetes Event gilt ab Blockanfang.
+        // false, wenn die Queue voll ist.
+        bool pushParameterEvent(int handle, float value, int64_t sampleTime = -1);
+        // Von processBlock() verarbeitete Host-Samples (seit Erzeugung der Instanz)
+        inline int64_t getSampleTime() { return sampleTime.load(std::memory_order_relaxed); }
+
+        // Glaettung von CONTROL Registern (source/FX8010Smoothing.cpp) gegen Zipper-Rauschen, ohne
+        // interp im Programm. Deklaration: "control volume = 1.0, ramp 20" (linear in 20 ms) oder
+        // "control cutoff = 0.5, lag 20" (Tiefpass 1. Ordnung, Zeitkonstante 20 ms).
+        // Neue Werte (setRegisterValue(), Events) werden zum Ziel, processBlock() fuehrt die laufenden
+        // Controls alle SMOOTHING_STEP Host-Samples in einem Durchlauf nach. Ruhende Controls kosten nichts.
+        enum SmoothingType
+        {
+            SMOOTHING_NONE = 0,
+            SMOOTHING_LINEAR,  // Rampe, erreicht das Ziel nach der angegebenen Zeit
+            SMOOTHING_ONE_POLE // exponentiell, Zeitkonstante
+        };
+        static const int SMOOTHING_STEP = 8;
+        // Nur fuer CONTROL Register, nicht waehrend processBlock(). false bei ungueltigem Handle.
+        bool setRegisterSmoothing(int handle, SmoothingType type, float milliseconds);
         std::unordered_map<std::string, std::string> getMetaData();
-        inline void setChannels(int numChannels_) { numChannels = numChannels_; }
+        inline void setChannels(int numChannels_)
+        {
+            numChannels = numChannels_;
+            outputBuffer.resize(numChannels, 0.0);
+            inputFrame.resize(numChannels, 0.0);
+            eventInputs.resize(numChannels);
+            eventOutputs.resize(numChannels);
+            setupResampler();
+        }
         inline int getChannels() { return numChannels; }
+
+        // Samplerate des Hosts. Weicht sie von SAMPLERATE ab, laeuft processBlock() ueber je einen
+        // Polyphase Resampler vor und hinter dem Programm, das Programm sieht immer 48 kHz.
+        // process() rechnet immer direkt mit 48 kHz. false bei ungueltiger Rate.
+        bool setHostSampleRate(int sampleRate);
+        inline int getHostSampleRate() { return hostSampleRate; }
+        // Latenz der Samplerate-Wandlung in Host-Samples (0 ohne Resampler)
+        inline int getLatency() { return resamplerLatency; }
         bool getReadyStatus(){return isReady;}
 
+        // Interpreter-Auswahl (A/B Vergleich)
+        enum EngineType
+        {
+            ENGINE_SWITCH = 0, // Referenz-Interpreter mit Befehlsdecoder (switch)
+            ENGINE_DECODED,    // vorab dekodierter Befehlsstrom (direct threaded)
+            ENGINE_JIT,        // x86-64 Maschinencode, Fallback: ENGINE_DECODED
+            ENGINE_FIXED       // int32 Q31 GPR/TRAM, 67 Bit Akkumulator (wie der Chip)
+        };
+        // false, wenn der gewuenschte Interpreter nicht verfuegbar ist (z.B. JIT auf anderer Architektur)
+        // ENGINE_FIXED uebernimmt Register und TRAM beim Umschalten (float <-> Festkomma).
+        // NOTE: Bitgenau zum Chip nur mit setOptimizerEnabled(false), der Optimierer faltet in float.
+        bool setEngineType(EngineType type);
+        inline EngineType getEngineType() { return engineType; }
+
+        // Rechengenauigkeit (dekodierter Interpreter, Auswahl je Instanz zur Laufzeit)
+        // NOTE: Liest das Programm CCR nicht, wird es nicht mehr gefuehrt (auch nicht fuer getRegisterValue("ccr")).
+        enum Precision
+        {
+            PRECISION_REFERENCE = 0, // float Arithmetik, double Akkumulator (wie ENGINE_SWITCH)
+            PRECISION_FAST,          // float Arithmetik, float Akkumulator
+            PRECISION_ACCURATE       // double Arithmetik, double Akkumulator
+        };
+        // Nicht-Referenz Genauigkeit schaltet ENGINE_JIT auf ENGINE_DECODED zurueck
+        void setPrecision(Precision precision);
+        inline Precision getPrecision() { return precision; }
+
+        // Optimierer (source/FX8010Optimizer.cpp), laeuft in loadFile() zwischen Parser und decode()
+        // NOTE: STATIC Register, die keine Instruktion liest, werden evtl. nicht mehr beschrieben
+        // (getRegisterValue() liefert dann den Startwert).
+        struct OptimizerEntry
+        {
+            int row = 0;             // Zeile im Sourcecode
+            std::string action = ""; // "fold", "copy", "reduce", "dead"
+            std::string before = ""; // Instruktion vorher
+            std::string after = "";  // Instruktion nachher (leer = entfernt)
+        };
+        struct OptimizerReport
+        {
+            bool enabled = false;
+            std::string skippedReason = ""; // nicht leer: Programm wurde nicht optimiert
+            int instructionsBefore = 0;
+            int instructionsAfter = 0;
+            int foldedConstants = 0;
+            int propagatedCopies = 0; // ersetzte Operanden
+            int reducedInstructions = 0;
+            int removedDeadWrites = 0;
+            int elidedCCR = 0;        // Instruktionen ohne setCCR()
+            int elidedSaturation = 0; // Instruktionen ohne saturate()
+            std::vector<OptimizerEntry> entries;
+        };
+        // Wirkt ab dem naechsten loadFile()
+        inline void setOptimizerEnabled(bool enabled) { optimizerEnabled = enabled; }
+        inline bool getOptimizerEnabled() { return optimizerEnabled; }
+        inline const OptimizerReport &getOptimizerReport() { return optimizerReport; }
+
+        // Speicherbedarf der Instanz in Bytes (Kapazitaetsplanung)
+        // NOTE: Maps und Strings sind geschaetzt (Knoten + Heap-Anteil), Allokator-Overhead fehlt.
+        struct MemoryFootprint
+        {
+            size_t object = 0;       // sizeof(FX8010)
+            size_t registers = 0;    // GPR, Registerwerte (float und Festkomma)
+            size_t instructions = 0; // Instruktionen, dekodiert, Festkomma, JIT Maschinencode
+            size_t tables = 0;       // Fehler-Map, Metadaten, Controlregister (Opcode-/Typ-Map sind gemeinsam)
+            size_t tram = 0;         // Delaylines (float und Festkomma), Tap-Puffer
+            size_t buffers = 0;      // I/O Frames, Resampler
+            size_t total = 0;
+        };
+        MemoryFootprint getMemoryFootprint();
+
     private:
         // Enum for FX8010 opcodes
         enum Opcode
@@ -96,11 +259,17 @@ namespace Klangraum
             SKIP = 0xf,
             IDELAY,
             XDELAY,
-            END
+            END,
+            // Interne Opcodes des Optimierers (nicht im Sourcecode verfuegbar)
+            // Wie MACS: Akkumulator = unsaturiertes Ergebnis, R saturiert, CCR nach R
+            MOVS, // R = A         (MACS R, A, X, 0)
+            ADDS, // R = A + X     (MACS R, A, X, 1.0)
+            MULS  // R = X * Y     (MACS R, 0, X, Y)
         };
 
         // This Map holds Key/Value pairs to assign instructions(strings) to Opcode(enum/int)
-        std::map<std::string, Opcode> opcodeMap = {
+        // Gemeinsam fuer alle Instanzen (der Konstruktor baut keine Tabellen)
+        static inline const std::map<std::string, Opcode> opcodeMap = {
             {"macs", MACS},
             {"macsn", MACSN},
             {"macw", MACW},
@@ -142,7 +311,7 @@ namespace Klangraum
         };
 
         // This Map holds Key/Value pairs to assign registertypes(strings) to RegisterType(enum/int)
-        std::map<std::string, RegisterType> typeMap = {
+        static inline const std::map<std::string, RegisterType> typeMap = {
             {"static", STATIC},
             {"temp", TEMP},
             {"control", CONTROL},
@@ -162,20 +331,41 @@ namespace Klangraum
         double accumulator = 0; // 63 Bit, 4 Guard Bits, Long type?
         int instructionCounter = 0;
         std::vector<float> outputBuffer;
+        std::vector<float> inputFrame; // Eingangssamples des aktuellen Samplezyklus
+
+        // 1 Samplezyklus: alle Instruktionen bis END ausfuehren
+        inline void processSample(const float *inputFrame);
 
         // GPR - General Purpose Register
+        // Nur Metadaten fuer Parser und get/setRegisterValue(). Die Werte liegen in registerValues.
         struct GPR
         {
             int registerType = 0;          // Typ des Registers (z.B. STATIC, TEMP, CONTROL, INPUT_, OUTPUT_)
             std::string registerName = ""; // Name des Registers
-            float registerValue = 0;       // Wert des Registers
+            float initValue = 0;           // Startwert aus der Deklaration bzw. Zahlenwert des Literals
             int IOIndex = 0;               // 0 - Links, 1 - Rechts
             bool isBorrow = false;         // fuer CCR, Was tut das?
+            int valueIndex = -1;           // Index in registerValues (nach layoutRegisters())
+            bool isLiteral = false;        // Zahl aus dem Sourcecode, von mapRegisterToIndex() angelegt
+            int smoothingType = 0;         // SmoothingType (ramp/lag in der Deklaration)
+            float smoothingTime = 0;       // ms
         };
 
-        // Vector, der die GPR enthaelt
+        // Vector, der die GPR enthaelt (kalte Daten)
         std::vector<GPR> registers;
 
+        // Registerwerte fuer den Samplezyklus (heisse Daten), 64 Byte aligned:
+        // [CCR, STATIC/TEMP/CONTROL/IO ... | Konstantensegment: Literale, nach Wert dedupliziert]
+        // Das Konstantensegment wird von keiner Instruktion beschrieben.
+        std::vector<float, AlignedAllocator<float, 64>> registerValues;
+        int constantSegmentStart = 0;
+
+        // Wert eines GPR
+        inline float &valueOf(int registerIndex) { return registerValues[registers[registerIndex].valueIndex]; }
+
+        // registers -> registerValues, vergibt valueIndex (nach dem Parsen, vor decode())
+        void layoutRegisters();
+
         // Struct, die eine Instruktion repraesentiert
         struct Instruction
         {
@@ -188,14 +378,221 @@ namespace Klangraum
             // hasOutput nicht sinnvoll, Doppelcheck (Instruktion und R)
             bool hasOutput = false; // um nicht alle Instructions auf OUTPUT testen zu muessen
             bool hasNoise = false;
+            int row = 0; // Zeile im Sourcecode (Optimierer-Report)
+            // Vom Optimierer bestimmt (Liveness bzw. Wertebereich), sonst immer true
+            bool writesCCR = true; // CCR Ergebnis wird evtl. gelesen
+            bool saturates = true; // Ergebnis kann [-1.0, 1.0] verlassen
+            int delayTap = -1;     // IDELAY/XDELAY READ/WRITE: Index in delayTaps
         };
 
         // Vector, der die Instruktionen enthaelt
         std::vector<Instruction> instructions;
 
-        // Mehrere Lookup Tables in einem Vector, LOG, EXP jeweils mit 31 Exponenten
-        vector<vector<double>> lookupTablesLog;
-        vector<vector<double>> lookupTablesExp;
+        // Dekodierter Interpreter
+        //----------------------------------------------------------------
+        EngineType engineType = ENGINE_DECODED;
+        Precision precision = PRECISION_REFERENCE;
+
+        // Handler fuehrt eine Instruktion aus und gibt die naechste zurueck (END: nullptr)
+        struct DecodedInstruction;
+        typedef const DecodedInstruction *(*Handler)(FX8010 &dsp, const DecodedInstruction *ip);
+
+        // Instruktion mit aufgeloesten Operanden (Pointer auf die Registerwerte)
+        struct DecodedInstruction
+        {
+            Handler handler = nullptr; // Einsprung (bei NOISE mit Vorstufe)
+            Handler exec = nullptr;    // eigentliche Operation
+            float *R = nullptr;
+            float *A = nullptr;
+            float *X = nullptr;
+            float *Y = nullptr;
+            float *N = nullptr; // NOISE Operand
+            int opcode = 0;     // fuer die Registerausgabe (PRINT_REGISTERS)
+            int delayTap = -1;  // IDELAY/XDELAY: Index in delayTaps
+        };
+
+        // I/O Register mit Kanalindex
+        struct IOBinding
+        {
+            float *value;
+            int IOIndex;
+            int registerIndex;
+        };
+
+        std::vector<DecodedInstruction> decodedInstructions;
+        std::vector<IOBinding> inputRegisters;
+        std::vector<IOBinding> outputRegisters;
+
+        // Handler der Opcodes, instanziiert je Policy (Rechentyp, Akkumulator, Tracing, CCR)
+        template <typename Policy>
+        struct Ops;
+
+        // Handler einer Policy-Instanz, arithmetische Opcodes je Instruktion in 4 Varianten:
+        // [writesCCR][saturates] (ohne Saturation wie mit, wenn der Opcode nicht saturiert)
+        typedef Handler HandlerVariants[2][2];
+        struct HandlerTable
+        {
+            HandlerVariants macs, macsn, acc3, log, exp, macw, macwn, macintw, macmv, andxor, tstneg,
+                limit, limitn, interp, movs, adds, muls;
+            Handler skip, idelayRead, idelayWrite, xdelayRead, xdelayWrite, nop, end, noise;
+        };
+
+        // Factory: schnellste Instanz fuer Programm, Genauigkeit und Build
+        HandlerTable selectHandlers();
+
+        // Liest irgendeine Instruktion CCR? (SKIP oder CCR als Operand)
+        bool programReadsCCR();
+
+        // instructions -> decodedInstructions
+        void decode();
+
+        // 1 Samplezyklus je Interpreter
+        inline void processSampleSwitch(const float *inputFrame);
+        inline void processSampleDecoded(const float *inputFrame);
+
+        // Optimierer (source/FX8010Optimizer.cpp)
+        //----------------------------------------------------------------
+        bool optimizerEnabled = true;
+        OptimizerReport optimizerReport;
+        struct Optimizer;
+
+        // Konstantenfaltung, Copy Propagation, Strength Reduction, tote Schreibzugriffe (vor layoutRegisters())
+        void optimize();
+
+        // Nach layoutRegisters() bzw. dem Bytecode: Glaettung, Delaylines, decode(), JIT/Festkomma
+        void finishLoad();
+        void bytecodeError(const std::string &reason);
+
+        // Festkomma-Engine (source/FX8010Fixed.cpp)
+        //----------------------------------------------------------------
+        struct FixedInstruction;
+        typedef const FixedInstruction *(*FixedHandler)(FX8010 &dsp, const FixedInstruction *ip);
+
+        // Wie DecodedInstruction, Operanden zeigen in fixedValues
+        struct FixedInstruction
+        {
+            FixedHandler handler = nullptr; // Einsprung (bei NOISE mit Vorstufe)
+            FixedHandler exec = nullptr;    // eigentliche Operation
+            int32_t *R = nullptr;
+            int32_t *A = nullptr;
+            int32_t *X = nullptr;
+            int32_t *Y = nullptr;
+            int32_t *N = nullptr; // NOISE Operand
+            int opcode = 0;
+            bool writesCCR = true;
+            int length = 1; // Anzahl Instruktionen (MAC-Kette aus MACMV: alle Glieder ab hier)
+        };
+
+        struct FixedIOBinding
+        {
+            int32_t *value;
+            int IOIndex;
+        };
+
+        // Registerwerte der Festkomma-Engine, Index wie registerValues, dahinter Integer-Kopien von
+        // Literalen, die als Zaehler/Adresse gelesen werden (Q31 und Integer unterscheiden sich bei |x| <= 1)
+        std::vector<int32_t, AlignedAllocator<int32_t, 64>> fixedValues;
+        std::vector<bool> fixedIsInteger; // je Wert: Integer statt Q31
+        std::vector<FixedInstruction> fixedInstructions;
+        std::vector<FixedIOBinding> fixedInputs;
+        std::vector<FixedIOBinding> fixedOutputs;
+        std::vector<int32_t, AlignedAllocator<int32_t, 64>> fixedSmallDelay; // nur solange ENGINE_FIXED aktiv ist
+        std::vector<int32_t, AlignedAllocator<int32_t, 64>> fixedLargeDelay;
+        FixedWide fixedAccumulator = 0;
+
+        struct FixedOps;
+
+        // instructions -> fixedInstructions, uebernimmt Register/TRAM aus registerValues bzw. den Delaylines
+        void decodeFixed();
+        // Festkomma-Zustand zurueck nach registerValues/TRAM (beim Verlassen von ENGINE_FIXED)
+        void syncFromFixed();
+        void processBlockFixed(const float *const *inputs, float *const *outputs, int numFrames);
+        int32_t toFixed(int valueIndex, float value);
+        float fromFixed(int valueIndex);
+
+        // x86-64 JIT (source/FX8010JIT.cpp)
+        //----------------------------------------------------------------
+        ExecutableMemory jitMemory;
+        JITFunction jitFunction = nullptr;
+        JITContext jitContext;
+        std::vector<const float *> jitFrameInputs; // 1 Frame aus inputFrame fuer process()
+        std::vector<float *> jitFrameOutputs;      // 1 Frame nach outputBuffer fuer process()
+
+        // Uebersetzt die dekodierten Instruktionen, false wenn nicht moeglich
+        bool compileJIT();
+        void processBlockJIT(const float *const *inputs, float *const *outputs, int numFrames);
+
+        // Samplerate-Wandlung (source/FX8010Resampler.cpp)
+        //----------------------------------------------------------------
+        static const int RESAMPLER_CHUNK = 256; // Host-Frames je Durchlauf
+        static const int RESAMPLER_PRIMING = 4; // 48 kHz Frames Vorlauf, damit der Ausgang nie leerlaeuft
+        int hostSampleRate = SAMPLERATE;
+        int resamplerLatency = 0;
+        int resamplerCoreFrames = 0; // hoechstens so viele 48 kHz Frames je Durchlauf
+        PolyphaseResampler inputResampler;  // Host -> 48 kHz
+        PolyphaseResampler outputResampler; // 48 kHz -> Host
+        std::vector<float, AlignedAllocator<float, 64>> resamplerBuffer;
+        std::vector<float *> resamplerCoreInputs;
+        std::vector<float *> resamplerCoreOutputs;
+        std::vector<const float *> resamplerHostInputs;
+        std::vector<float *> resamplerHostOutputs;
+
+        void setupResampler();
+        // processBlock() ohne Samplerate-Wandlung (48 kHz)
+        void processBlockCore(const float *const *inputs, float *const *outputs, int numFrames);
+        void processBlockResampled(const float *const *inputs, float *const *outputs, int numFrames);
+
+        // Parameter-Glaettung (source/FX8010Smoothing.cpp)
+        //----------------------------------------------------------------
+        // Ein Smoother je geglaettetem Control, Arrays parallel (SoA). Die laufenden Smoother liegen
+        // vorne (0..numActiveSmoothers-1), damit der Durchlauf ueber zusammenhaengende Arrays geht.
+        std::vector<int> smootherOf; // Werteindex -> Smoother, -1 = ungeglaettet (leer ohne Glaettung)
+        std::vector<int> smootherHandle;
+        std::vector<int> smootherType;
+        std::vector<float> smootherTime;
+        std::vector<int> smootherRemaining;
+        std::vector<float, AlignedAllocator<float, 64>> smootherCurrent;
+        std::vector<float, AlignedAllocator<float, 64>> smootherTarget;
+        std::vector<float, AlignedAllocator<float, 64>> smootherIncrement;   // linear: je Schritt
+        std::vector<float, AlignedAllocator<float, 64>> smootherCoefficient; // Tiefpass: je Schritt
+        std::vector<float, AlignedAllocator<float, 64>> smootherLinear;      // 1 = linear, 0 = Tiefpass
+        int numActiveSmoothers = 0;
+        int smoothingCountdown = 0; // Host-Samples bis zum naechsten Schritt
+
+        inline void storeRegisterValue(int handle, float value)
+        {
+            registerValues[handle] = value;
+            if (engineType == ENGINE_FIXED && isReady)
+                fixedValues[handle] = toFixed(handle, value);
+        }
+        // Beliebiger Werteindex, auch im Konstantensegment (getRegisterValue(name))
+        inline float loadRegisterValue(int valueIndex)
+        {
+            return (engineType == ENGINE_FIXED && isReady) ? fromFixed(valueIndex) : registerValues[valueIndex];
+        }
+        // Smoother aus den Deklarationen anlegen (nach layoutRegisters())
+        void setupSmoothing();
+        void setSmoothingTarget(int smoother, float value);
+        // Ein Schritt fuer alle laufenden Smoother
+        void advanceSmoothing();
+        void swapSmoothers(int a, int b);
+
+        // Parameter-Events
+        //----------------------------------------------------------------
+        ParameterEventQueue eventQueue;
+        std::atomic<int64_t> sampleTime{0};
+        std::vector<const float *> eventInputs; // Teilblock ab einem Event
+        std::vector<float *> eventOutputs;
+
+        // Teilblock [offset, offset + numFrames) ohne Events
+        void processSegment(const float *const *inputs, float *const *outputs, int offset, int numFrames);
+
+        // Hot Swap (source/FX8010HotSwap.cpp)
+        //----------------------------------------------------------------
+        // Zustand des vorherigen Programms uebernehmen: Registerwerte (Paare Werteindex alt -> neu),
+        // TRAM Inhalt und Samplezeit. Im Audio-Thread, allokiert nicht.
+        void migrateStateFrom(FX8010 &previous, const std::vector<std::pair<int, int>> &registerMap);
+        void migrateDelayLine(FX8010 &previous, bool isLarge);
 
         // TRAM Engine
         //----------------------------------------------------------------
@@ -204,23 +601,55 @@ namespace Klangraum
         int iTRAMSize = 0;
         int xTRAMSize = 0;
 
-        // Create a circular buffer for each delay line. You can use a std::vector to represent the buffer.
-        // std::vector<float> smallDelayBuffer; // ATTENTION: Vektoren scheinen trotz reserve() und resize() Probleme mit zufaelligen Werten zu machen!
-        // std::vector<float> largeDelayBuffer; //
-        float smallDelayBuffer[MAX_IDELAY_SIZE];
-        float largeDelayBuffer[MAX_XDELAY_SIZE];
-
-        // Schreib-/Lesepointer
-        int smallDelayWritePos = 0;
-        int smallDelayReadPos = 0;
-        int largeDelayWritePos = 0;
-        int largeDelayReadPos = 0;
+        // Delaylines, beim Laden in der deklarierten Groesse (auf die Zweierpotenz aufgerundet) angelegt
+        // und mit 0 gefuellt, auf Cachelines ausgerichtet. Ohne Deklaration 1 Sample.
+        std::vector<float, AlignedAllocator<float, 64>> smallDelayBuffer;
+        std::vector<float, AlignedAllocator<float, 64>> largeDelayBuffer;
+
+        // Ringpuffer, auf eine Zweierpotenz aufgerundet: Index = (Position + Frame - Adresse) & Maske
+        // Die Position gilt fuer den ersten Frame des Blocks und laeuft je Samplezyklus um 1 weiter,
+        // eine Leseadresse liefert also das Sample, das (Leseadresse - Schreibadresse) Zyklen vorher
+        // geschrieben wurde. Adressen ausserhalb der Delayline laufen ueber die Maske um.
+        int smallDelayMask = 0;
+        int largeDelayMask = 0;
+        int smallDelayPos = 0;
+        int largeDelayPos = 0;
+        // Samplezyklus im Block (switch/decoded/Festkomma), der JIT liefert jitContext.frameOffset
+        int delayFrame = 0;
+
+        // Block-Modus: sind alle Adressen einer Delayline im Block konstant und ueberschneiden sich
+        // Lese- und Schreibbereiche im Block nicht, wird je Tap ein ganzer Block mit memcpy
+        // gelesen (Blockanfang) bzw. geschrieben (Blockende), die Instruktionen greifen nur auf den
+        // Tap-Puffer zu.
+        static const int DELAY_BLOCK = 1024; // groessere Hostbloecke laufen Sample fuer Sample
+        struct DelayTap
+        {
+            bool isLarge = false;     // XDELAY
+            bool isWrite = false;     // WRITE, sonst READ
+            bool isConstant = false;  // Adresse (Y) wird vom Programm nicht beschrieben
+            float *address = nullptr; // Registerwert der Adresse
+            int offset = 0;           // Adresse im aktuellen Block (maskiert)
+            float *block = nullptr;   // DELAY_BLOCK Werte (Block-Modus)
+        };
+        std::vector<DelayTap> delayTaps; // in Programmreihenfolge
+        std::vector<float, AlignedAllocator<float, 64>> delayTapBuffer;
+        bool smallDelayBlockMode = false;
+        bool largeDelayBlockMode = false;
+
+        // Masken, Taps und Tap-Puffer nach dem Laden (setzt Instruction::delayTap)
+        void layoutDelayLines();
+        // Block-Modus je Delayline waehlen bzw. Tap-Puffer zurueckschreiben und Positionen weiterschalten
+        void beginDelayBlock(int numFrames);
+        void endDelayBlock(int numFrames);
+        bool beginDelayLine(bool isLarge, float *buffer, int mask, int position, int numFrames);
+        void endDelayLine(bool isLarge, float *buffer, int mask, int position, int numFrames);
+        inline int currentDelayFrame() { return delayFrame + static_cast<int>(jitContext.frameOffset >> 2); }
 
         // Delayline methods
-        inline float readSmallDelay(int position);
-        inline float readLargeDelay(int position);
-        inline void writeSmallDelay(float sample, int position_);
-        inline void writeLargeDelay(float sample, int position_);
+        inline float readSmallDelay(int position, int tap);
+        inline float readLargeDelay(int position, int tap);
+        inline void writeSmallDelay(float sample, int position_, int tap);
+        inline void writeLargeDelay(float sample, int position_, int tap);
 
         // CCR Register
         inline void setCCR(const float result);
@@ -229,14 +658,11 @@ namespace Klangraum
         // 32Bit Saturation
         inline float saturate(const float input, const float threshold);
 
-        // Lineare Interpolation mit Lookup-Table
-        inline double linearInterpolate(double x, const std::vector<double> &lookupTable, double x_min, double x_max);
-
         // MACINTW
         inline float wrapAround(const float a);
 
         // ANDXOR Instruction
-        inline int32_t logicOps(const GPR &A, const GPR &X_, const GPR &Y_);
+        int32_t logicOps(const float A_, const float X_, const float Y_);
 
         // Debug Registers
         void printRegisters(const int instruction, const float value1, const float value2, const float value3, const float value4, const double accumulator);
@@ -246,6 +672,9 @@ namespace Klangraum
 
         // GPR-Index zurückgeben
         int findRegisterIndexByName(const std::vector<GPR> &registers, const std::string &name);
+        // Name -> GPR-Index, neue Register werden bei der naechsten Suche nachgetragen
+        std::unordered_map<std::string, int> registerIndexByName;
+        size_t indexedRegisters = 0;
 
         // Map registernames from sourcecode instruction to register indexes
         int mapRegisterToIndex(const string &registerName);
@@ -263,7 +692,8 @@ namespace Klangraum
             ERROR_IO_INDEX_OUT_OF_RANGE,
             ERROR_SYNTAX_NOT_VALID,
             ERROR_ITRAMSIZE_TO_LARGE,
-            ERROR_XTRAMSIZE_TO_LARGE
+            ERROR_XTRAMSIZE_TO_LARGE,
+            ERROR_INVALID_BYTECODE
             // Weitere Fehlercodes hier...
         };
 
@@ -272,12 +702,6 @@ namespace Klangraum
         vector<MyError> errorList;
         int errorCounter = 1;
 
-        std::vector<double> createLogLookupTable(double x_min, double x_max, int numEntries, int exponent);
-        std::vector<double> createExpLookupTable(double x_min, double x_max, int numEntries, int exponent);
-        std::vector<double> mirrorYVector(const std::vector<double> &inputVector);
-        std::vector<double> concatenateVectors(const std::vector<double> &vector1, const std::vector<double> &vector2);
-        std::vector<double> negateVector(const std::vector<double> &inputVector);
-
         int numChannels;
 
         vector<string> controlRegisters;
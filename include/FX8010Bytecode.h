@@ -0,0 +1,141 @@
+// Copyright 2023 Klangraum
+// Vorübersetzte Programme (Bytecode) fuer den schnellen Start vieler Instanzen
+// FX8010::saveBytecode() bzw. tools/da-compile.cpp schreibt das Programm nach Parser, Optimierer und
+// layoutRegisters(), FX8010::loadBytecode() liest es ohne Parser und Optimierer wieder ein. Die
+// dekodierten Instruktionen (Pointer) und der JIT-Code entstehen beim Laden neu (decode()).
+//
+// Layout: BytecodeHeader, danach die Abschnitte, jeder auf BYTECODE_ALIGNMENT Byte ausgerichtet:
+//   registers    BytecodeRegister[]     GPR ohne Namen, Name im Stringpool
+//   values       float[]                Startwerte (registerValues, inkl. Konstantensegment)
+//   instructions BytecodeInstruction[]  nach dem Optimierer, letzte Instruktion ist END
+//   controls     BytecodeString[]       Controlregister (getControlRegisters())
+//   meta         BytecodeMetaEntry[]    Metadaten (getMetaData())
+//   strings      char[]                 Stringpool, ohne Nullterminierung
+// Zahlen in der Byte-Reihenfolge des schreibenden Rechners, byteOrder erkennt eine fremde.
+// Jede neue Version des Formats erhoeht BYTECODE_VERSION, aeltere Dateien werden abgelehnt.
+
+#ifndef FX8010BYTECODE_H
+#define FX8010BYTECODE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Klangraum
+{
+
+    const char BYTECODE_MAGIC[8] = {'F', 'X', '8', '0', '1', '0', 'B', 'C'};
+    const uint32_t BYTECODE_VERSION = 1;
+    const uint32_t BYTECODE_BYTE_ORDER = 0x01020304;
+    const uint32_t BYTECODE_ALIGNMENT = 16;
+
+    struct BytecodeSection
+    {
+        uint32_t offset; // ab Dateianfang
+        uint32_t count;  // Anzahl Elemente
+    };
+
+    struct BytecodeString
+    {
+        uint32_t offset; // im Stringpool
+        uint32_t length;
+    };
+
+    struct BytecodeRegister
+    {
+        int32_t registerType;
+        BytecodeString name;
+        float initValue;
+        int32_t IOIndex;
+        int32_t valueIndex;
+        int32_t smoothingType;
+        float smoothingTime;
+        uint8_t isBorrow;
+        uint8_t isLiteral;
+        uint8_t reserved[2];
+    };
+
+    struct BytecodeInstruction
+    {
+        int32_t opcode;
+        int32_t operand1;
+        int32_t operand2;
+        int32_t operand3;
+        int32_t operand4;
+        int32_t row;
+        uint8_t hasInput;
+        uint8_t hasOutput;
+        uint8_t hasNoise;
+        uint8_t writesCCR;
+        uint8_t saturates;
+        uint8_t reserved[3];
+    };
+
+    struct BytecodeMetaEntry
+    {
+        BytecodeString key;
+        BytecodeString value;
+    };
+
+    struct BytecodeHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t fileSize;
+        int32_t constantSegmentStart;
+        int32_t iTRAMSize;
+        int32_t xTRAMSize;
+        int32_t maxIOIndex; // hoechster Kanal eines INPUT/OUTPUT Registers, -1 = keiner
+        // Zahlen aus FX8010::OptimizerReport (ohne Eintraege)
+        int32_t optimizerEnabled;
+        int32_t instructionsBefore;
+        int32_t instructionsAfter;
+        int32_t foldedConstants;
+        int32_t propagatedCopies;
+        int32_t reducedInstructions;
+        int32_t removedDeadWrites;
+        int32_t elidedCCR;
+        int32_t elidedSaturation;
+        BytecodeSection registers;
+        BytecodeSection values;
+        BytecodeSection instructions;
+        BytecodeSection controls;
+        BytecodeSection meta;
+        BytecodeSection strings;
+        uint32_t reserved[2];
+    };
+
+    static_assert(sizeof(BytecodeRegister) == 36, "BytecodeRegister: Layout geaendert, BYTECODE_VERSION erhoehen");
+    static_assert(sizeof(BytecodeInstruction) == 32, "BytecodeInstruction: Layout geaendert, BYTECODE_VERSION erhoehen");
+    static_assert(sizeof(BytecodeHeader) == 128, "BytecodeHeader: Layout geaendert, BYTECODE_VERSION erhoehen");
+
+    // Nur lesend eingeblendete Datei (mmap/MapViewOfFile). Eine Datei fuer beliebig viele Instanzen:
+    // FX8010::loadBytecodeFromMemory(file.data(), file.getSize()).
+    class BytecodeFile
+    {
+    public:
+        BytecodeFile() {}
+        explicit BytecodeFile(const std::string &path) { open(path); }
+        ~BytecodeFile() { close(); }
+        BytecodeFile(const BytecodeFile &) = delete;
+        BytecodeFile &operator=(const BytecodeFile &) = delete;
+
+        bool open(const std::string &path);
+        void close();
+        inline bool isOpen() const { return memory != nullptr; }
+        inline const void *data() const { return memory; }
+        inline size_t getSize() const { return size; }
+
+    private:
+        const void *memory = nullptr;
+        size_t size = 0;
+#ifdef _WIN32
+        void *fileHandle = nullptr;
+        void *mappingHandle = nullptr;
+#endif
+    };
+
+} // namespace Klangraum
+
+#endif // FX8010BYTECODE_H
@@ -0,0 +1,115 @@
+// Copyright 2023 Klangraum
+// Compile-Cache fuer Preset-Bibliotheken
+// Schluessel ist ein Hash ueber den Quellcode, COMPILER_VERSION, BYTECODE_VERSION, Optimierer und
+// Kanalzahl. Ein Treffer liefert das fertig uebersetzte Programm (Bytecode, include/FX8010Bytecode.h),
+// createInstance() startet daraus eine Instanz ohne Parser und Optimierer.
+// Mit Verzeichnis liegt jedes Programm zusaetzlich als <Schluessel>.dab auf der Platte und ueberlebt
+// einen Neustart. Eine defekte oder veraltete Datei wird verworfen und neu uebersetzt.
+// Index: die Metadaten "name" und "guid" (getMetaData()) verweisen auf den Eintrag, ein erneut
+// gewaehltes Preset ist damit ein Nachschlagen statt eines Parserlaufs.
+// Alle Methoden sind thread-safe (nicht fuer den Audio-Thread, es wird gesperrt und allokiert).
+
+#ifndef FX8010COMPILECACHE_H
+#define FX8010COMPILECACHE_H
+
+#include "FX8010.h"
+#include "FX8010ThreadPool.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace Klangraum
+{
+
+    // Erhoehen, wenn Parser oder Optimierer fuer denselben Quellcode anderen Bytecode erzeugen
+    const uint32_t COMPILER_VERSION = 3;
+
+    class FX8010CompileCache
+    {
+    public:
+        typedef uint64_t Key;
+
+        // Uebersetztes Programm, unveraenderlich, solange jemand den shared_ptr haelt
+        struct Program
+        {
+            Key key = 0;
+            std::vector<uint8_t> bytecode;
+            std::string name = ""; // Metadaten "name" und "guid", leer wenn nicht angegeben
+            std::string guid = "";
+            std::unordered_map<std::string, std::string> metaData;
+        };
+
+        // directory leer: nur im Speicher. numChannels wie FX8010(numChannels) (Pruefung der I/O Indizes).
+        explicit FX8010CompileCache(const std::string &directory = "", int numChannels = 2, bool optimize = true);
+
+        Key makeKey(const std::string &source) const;
+
+        // Nachschlagen (Speicher, dann Platte), sonst uebersetzen und eintragen.
+        // nullptr bei fehlerhaftem Quellcode, errors wie FX8010::getErrorList().
+        std::shared_ptr<const Program> compile(const std::string &source, std::vector<FX8010::MyError> *errors = nullptr);
+        std::shared_ptr<const Program> compileFile(const std::string &path, std::vector<FX8010::MyError> *errors = nullptr);
+
+        // Ganze Bibliothek parallel uebersetzen, ohne pool mit einem eigenen FX8010ThreadPool.
+        // Rueckgabe in der Reihenfolge von paths.
+        struct LibraryEntry
+        {
+            std::string path = "";
+            std::shared_ptr<const Program> program; // nullptr: nicht lesbar oder fehlerhaft
+            std::vector<FX8010::MyError> errors;
+        };
+        std::vector<LibraryEntry> compileLibrary(const std::vector<std::string> &paths, FX8010ThreadPool *pool = nullptr);
+
+        // Index (nur Eintraege im Speicher). nullptr, wenn unbekannt.
+        std::shared_ptr<const Program> find(Key key);
+        std::shared_ptr<const Program> findByName(const std::string &name);
+        std::shared_ptr<const Program> findByGuid(const std::string &guid);
+
+        // Neue Instanz mit dem Programm, nullptr wenn der Bytecode nicht passt (z.B. zu wenige Kanaele)
+        std::unique_ptr<FX8010> createInstance(const Program &program, int numChannels = 2, FX8010::EngineType type = FX8010::ENGINE_DECODED, int hostSampleRate = SAMPLERATE);
+
+        // Speicher leeren (Dateien bleiben)
+        void clear();
+        inline const std::string &getDirectory() const { return directory; }
+        inline int getNumEntries()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return static_cast<int>(entries.size());
+        }
+
+        struct Statistics
+        {
+            int64_t memoryHits = 0;
+            int64_t diskHits = 0;
+            int64_t compiled = 0;
+            int64_t failed = 0;
+        };
+        Statistics getStatistics() const;
+
+    private:
+        std::string directory;
+        int numChannels;
+        bool optimize;
+
+        std::mutex mutex; // Eintraege und Index
+        std::unordered_map<Key, std::shared_ptr<const Program>> entries;
+        std::unordered_map<std::string, Key> nameIndex;
+        std::unordered_map<std::string, Key> guidIndex;
+
+        std::atomic<int64_t> memoryHits{0};
+        std::atomic<int64_t> diskHits{0};
+        std::atomic<int64_t> compiled{0};
+        std::atomic<int64_t> failed{0};
+        std::atomic<uint32_t> temporaryCounter{0};
+
+        std::string getPath(Key key) const;
+        std::shared_ptr<const Program> loadFromDisk(Key key);
+        void saveToDisk(const Program &program);
+        std::shared_ptr<const Program> insert(std::shared_ptr<Program> program);
+        static std::shared_ptr<Program> makeProgram(Key key, FX8010 &dsp);
+        static void compileTask(void *context, int index);
+    };
+
+} // namespace Klangraum
+
+#endif // FX8010COMPILECACHE_H
@@ -0,0 +1,74 @@
+// Copyright 2023 Klangraum
+// Parameter-Events fuer sample-genaue Automation
+// Ein Thread (UI, Automation) schreibt, der Audio-Thread liest (Single Producer, Single Consumer).
+// Ringpuffer mit fester Groesse (Zweierpotenz), Lese- und Schreibposition in eigenen Cache-Lines.
+// push(), peek() und pop() sind wait-free und allokieren nicht.
+
+#ifndef FX8010EVENTS_H
+#define FX8010EVENTS_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace Klangraum
+{
+
+    struct ParameterEvent
+    {
+        int64_t sampleTime; // Host-Sample (FX8010::getSampleTime()), < 0 = sofort
+        int handle;         // FX8010::getRegisterHandle()
+        float value;
+    };
+
+    class ParameterEventQueue
+    {
+    public:
+        // capacity wird auf eine Zweierpotenz aufgerundet
+        explicit ParameterEventQueue(int capacity = 1024)
+        {
+            int size = 1;
+            while (size < capacity)
+                size <<= 1;
+            events.resize(size);
+            mask = static_cast<uint32_t>(size - 1);
+        }
+
+        // Producer. false, wenn die Queue voll ist (das Event wird verworfen).
+        inline bool push(const ParameterEvent &event)
+        {
+            const uint32_t write = writePos.load(std::memory_order_relaxed);
+            if (write - readPos.load(std::memory_order_acquire) > mask)
+                return false;
+            events[write & mask] = event;
+            writePos.store(write + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer. Naechstes Event oder nullptr, bleibt bis pop() in der Queue.
+        inline const ParameterEvent *peek() const
+        {
+            const uint32_t read = readPos.load(std::memory_order_relaxed);
+            if (read == writePos.load(std::memory_order_acquire))
+                return nullptr;
+            return &events[read & mask];
+        }
+
+        // Consumer, nur nach peek() != nullptr
+        inline void pop()
+        {
+            readPos.store(readPos.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        inline size_t getMemoryFootprint() const { return events.capacity() * sizeof(ParameterEvent); }
+
+    private:
+        std::vector<ParameterEvent> events;
+        uint32_t mask = 0;
+        alignas(64) std::atomic<uint32_t> writePos{0};
+        alignas(64) std::atomic<uint32_t> readPos{0};
+    };
+
+} // namespace Klangraum
+
+#endif // FX8010EVENTS_H
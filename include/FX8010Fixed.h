@@ -0,0 +1,95 @@
+// Copyright 2023 Klangraum
+// Festkomma-Engine (ENGINE_FIXED) fuer den FX8010 Emulator
+// Die Engine selbst ist FX8010::decodeFixed() bzw. FX8010::processBlockFixed() (source/FX8010Fixed.cpp),
+// hier liegen nur der breite Integertyp fuer den Akkumulator und die Q31 Konvertierung.
+//
+// Zahlenformat wie im Chip:
+//   GPR/TRAM:    int32, Q31 (1.0 = 0x7FFFFFFF, -1.0 = 0x80000000) bzw. Integer
+//   Akkumulator: 67 Bit, Q62 mit 4 Guard Bits (Wertebereich [-16.0, 16.0)), Ueberlauf = Wraparound
+
+#ifndef FX8010FIXED_H
+#define FX8010FIXED_H
+
+#include <cstdint>
+
+// GCC/Clang haben __int128, MSVC nicht
+#if defined(__SIZEOF_INT128__)
+#define FX8010_HAS_INT128 1
+#else
+#define FX8010_HAS_INT128 0
+#endif
+
+namespace Klangraum
+{
+
+#if FX8010_HAS_INT128
+    typedef __int128 FixedWide;
+#else
+    // 128 Bit Zweierkomplement aus zwei 64 Bit Haelften, nur die Operationen der Festkomma-Engine
+    struct FixedWide
+    {
+        uint64_t lo = 0;
+        int64_t hi = 0;
+
+        FixedWide() {}
+        FixedWide(int64_t value) : lo(static_cast<uint64_t>(value)), hi(value < 0 ? -1 : 0) {}
+
+        explicit operator int64_t() const { return static_cast<int64_t>(lo); }
+
+        friend FixedWide operator+(const FixedWide &a, const FixedWide &b)
+        {
+            FixedWide r;
+            r.lo = a.lo + b.lo;
+            r.hi = static_cast<int64_t>(static_cast<uint64_t>(a.hi) + static_cast<uint64_t>(b.hi) + (r.lo < a.lo ? 1 : 0));
+            return r;
+        }
+        friend FixedWide operator-(const FixedWide &a)
+        {
+            FixedWide r;
+            r.lo = ~a.lo + 1;
+            r.hi = static_cast<int64_t>(~static_cast<uint64_t>(a.hi) + (r.lo == 0 ? 1 : 0));
+            return r;
+        }
+        friend FixedWide operator-(const FixedWide &a, const FixedWide &b) { return a + (-b); }
+
+        // Schiebeweite 1..63
+        friend FixedWide operator<<(const FixedWide &a, int n)
+        {
+            FixedWide r;
+            r.hi = static_cast<int64_t>((static_cast<uint64_t>(a.hi) << n) | (a.lo >> (64 - n)));
+            r.lo = a.lo << n;
+            return r;
+        }
+        // arithmetisch, Schiebeweite 1..63
+        friend FixedWide operator>>(const FixedWide &a, int n)
+        {
+            FixedWide r;
+            r.lo = (a.lo >> n) | (static_cast<uint64_t>(a.hi) << (64 - n));
+            r.hi = a.hi >> n;
+            return r;
+        }
+
+        friend bool operator==(const FixedWide &a, const FixedWide &b) { return a.lo == b.lo && a.hi == b.hi; }
+        friend bool operator<(const FixedWide &a, const FixedWide &b) { return a.hi < b.hi || (a.hi == b.hi && a.lo < b.lo); }
+        friend bool operator>(const FixedWide &a, const FixedWide &b) { return b < a; }
+    };
+#endif
+
+    // wie floatToInt(), aber saturierend
+    inline int32_t floatToQ31(const float value)
+    {
+        if (value >= 1.0f)
+            return INT32_MAX;
+        if (value <= -1.0f)
+            return INT32_MIN;
+        return static_cast<int32_t>(value * 2147483648.0f);
+    }
+
+    inline float q31ToFloat(const int32_t value)
+    {
+        return static_cast<float>(value) * (1.0f / 2147483648.0f);
+    }
+
+} // namespace Klangraum
+
+#endif // FX8010FIXED_H
@@ -0,0 +1,114 @@
+// Copyright 2023 Klangraum
+// Routing-Graph fuer mehrere FX8010 Programme (z.B. EQ -> Kompressor -> Hall, plus Sends)
+// Knoten sind Programme, Kanten verbinden Ausgaenge (IOIndex bzw. OUTPUT Register) mit Eingaengen.
+// Mehrere Quellen an einem Eingang werden summiert (mit Gain). prepare() sortiert den Graph
+// topologisch in Ebenen: alle Knoten einer Ebene sind unabhaengig und laufen parallel (FX8010ThreadPool), die
+// naechste Ebene startet erst, wenn die vorherige fertig ist. Die Uebergabe passiert im selben
+// Block, es entsteht keine zusaetzliche Latenz.
+// Zwischenpuffer liegen in einer gemeinsamen Arena (64 Byte ausgerichtet). Ein Puffer wird nach
+// seiner letzten Verwendung von einer spaeteren Ebene wiederverwendet.
+
+#ifndef FX8010GRAPH_H
+#define FX8010GRAPH_H
+
+#include <memory>
+
+#include "FX8010.h"
+#include "FX8010ThreadPool.h"
+
+namespace Klangraum
+{
+
+    class FX8010Graph
+    {
+    public:
+        FX8010Graph() {}
+
+        // Programm laden und als Knoten anlegen. -1 bei Fehler (doppelter Name, Syntaxfehler).
+        int addNode(const std::string &name, const std::string &path, int numChannels = 2);
+        // Geladenes Programm uebernehmen, der Graph besitzt es danach
+        int addNode(const std::string &name, std::unique_ptr<FX8010> program);
+        FX8010 *getNode(const std::string &name);
+
+        // Ausgang von 'from' an Eingang von 'to', Kanal als IOIndex oder als Registername
+        bool connect(const std::string &from, int output, const std::string &to, int input, float gain = 1.0f);
+        bool connect(const std::string &from, const std::string &outputRegister, const std::string &to, const std::string &inputRegister, float gain = 1.0f);
+        // Hostkanaele (inputs/outputs von processBlock())
+        bool connectInput(int hostInput, const std::string &to, int input, float gain = 1.0f);
+        bool connectOutput(const std::string &from, int output, int hostOutput, float gain = 1.0f);
+
+        // Ablaufplan und Arena berechnen (nach jeder Aenderung am Graph), false bei Zyklus
+        bool prepare(int numHostInputs, int numHostOutputs, int maxBlockSize);
+        // Worker-Threads zusaetzlich zum aufrufenden Thread (0 = alles im Aufrufer)
+        void setNumThreads(int numThreads);
+
+        // Planar wie FX8010::processBlock(), Bloecke groesser als maxBlockSize werden geteilt
+        void processBlock(const float *const *inputs, float *const *outputs, int numFrames);
+
+        inline int getNumNodes() { return static_cast<int>(nodes.size()); }
+        inline int getNumLevels() { return static_cast<int>(levels.size()); }
+        // Arena in Bytes (statt eines Puffers je Kante)
+        inline size_t getArenaSize() { return arena.size() * sizeof(float); }
+
+    private:
+        // Quelle eines Eingangs: Knotenausgang oder Hosteingang (node = -1)
+        struct Source
+        {
+            int node = -1;
+            int channel = 0;
+            float gain = 1.0f;
+        };
+
+        // Wie ein Eingang zu Beginn des Knotens bereitgestellt wird
+        enum InputMode
+        {
+            INPUT_SILENCE = 0, // nicht verbunden
+            INPUT_NODE,        // genau ein Knotenausgang, Gain 1: Arena-Puffer direkt
+            INPUT_HOST,        // genau ein Hosteingang, Gain 1: Hostpuffer direkt
+            INPUT_MIX          // Summe in einen eigenen Arena-Puffer
+        };
+
+        struct Node
+        {
+            std::string name;
+            std::unique_ptr<FX8010> program;
+            int numChannels = 0;
+            int level = 0;
+            std::vector<std::vector<Source>> sources; // je Eingangskanal
+            std::vector<int> inputMode;
+            std::vector<size_t> inputOffset;          // Arena: Quelle (INPUT_NODE) bzw. Mischpuffer (INPUT_MIX)
+            std::vector<size_t> outputOffset;         // Arena, je Ausgangskanal
+            std::vector<const float *> inputs;        // je Block gesetzt
+            std::vector<float *> outputs;
+        };
+
+        std::vector<Node> nodes;
+        std::vector<std::vector<Source>> hostOutputSources; // je Hostausgang
+        std::vector<std::vector<int>> levels;               // Knotenindizes je Ebene
+        int numHostInputs = 0;
+        int numHostOutputs = 0;
+        int maxBlockSize = 0;
+        size_t stride = 0; // Floats je Arena-Puffer (auf 64 Byte aufgerundet)
+        std::vector<float, AlignedAllocator<float, 64>> arena;
+        std::vector<float, AlignedAllocator<float, 64>> silence;
+        bool isPrepared = false;
+
+        int findNode(const std::string &name);
+        bool addSource(int node, int input, const Source &source);
+        // Eingaenge mischen bzw. Pointer setzen, dann das Programm rechnen
+        void runNode(int node, const float *const *hostInputs, int offset, int numFrames);
+        void runLevel(int level, const float *const *hostInputs, int offset, int numFrames);
+
+        // Knoten einer Ebene als Aufgaben fuer den Pool
+        std::unique_ptr<FX8010ThreadPool> pool;
+        int currentLevel = 0;
+        int currentOffset = 0;
+        int currentFrames = 0;
+        const float *const *currentInputs = nullptr;
+
+        static void runNodeTask(void *context, int index);
+    };
+
+} // namespace Klangraum
+
+#endif // FX8010GRAPH_H
@@ -0,0 +1,126 @@
+// Copyright 2023 Klangraum
+// Programmwechsel im laufenden Betrieb (Live-Editing)
+// compile() kehrt sofort zurueck, ein eigener Thread parst, optimiert und uebersetzt das Programm und
+// veroeffentlicht es ueber einen atomaren Pointer. processBlock() (Audio-Thread) uebernimmt es am
+// Blockanfang: gleichnamige STATIC/CONTROL Werte, der TRAM Inhalt und der Rauschgenerator wandern ins neue Programm,
+// danach wird optional ueber getCrossfadeSamples() Host-Samples vom alten zum neuen Ausgang geblendet.
+// Der Audio-Thread wartet nie, allokiert nicht und gibt nichts frei: ausgediente Programme holt der
+// Compile-Thread wieder ab (RCU).
+// Kommen mehrere compile() schneller als uebersetzt werden kann, gilt nur der neueste Quellcode.
+
+#ifndef FX8010HOTSWAP_H
+#define FX8010HOTSWAP_H
+
+#include "FX8010.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Klangraum
+{
+
+    class FX8010HotSwap
+    {
+    public:
+        explicit FX8010HotSwap(int numChannels = 2);
+        ~FX8010HotSwap();
+
+        // Einstellungen fuer die folgenden compile(), das laufende Programm bleibt unveraendert
+        void setHostSampleRate(int sampleRate);
+        void setEngineType(FX8010::EngineType type);
+        void setOptimizerEnabled(bool enabled);
+        // Ueberblendung beim Wechsel in Host-Samples (Standard 480), 0 = harter Wechsel (Zustand wird
+        // trotzdem uebernommen). Gilt ab dem naechsten Wechsel.
+        inline void setCrossfadeSamples(int samples) { crossfadeSamples.store(std::max(samples, 0), std::memory_order_relaxed); }
+        inline int getCrossfadeSamples() { return crossfadeSamples.load(std::memory_order_relaxed); }
+
+        // Quellcode im Hintergrund uebersetzen, Rueckgabe Auftragsnummer (fuer waitForCompile())
+        int compile(const std::string &source);
+        // Datei lesen (aufrufender Thread), dann wie compile(). -1, wenn die Datei nicht lesbar ist.
+        int compileFile(const std::string &path);
+
+        struct CompileResult
+        {
+            int request = 0;                      // Auftragsnummer, 0 = noch nichts uebersetzt
+            bool success = false;                 // false: das bisherige Programm laeuft weiter
+            std::vector<FX8010::MyError> errors;  // wie FX8010::getErrorList()
+            double milliseconds = 0;              // Parser, Optimierer, Decoder/JIT
+        };
+        CompileResult getLastResult();
+        // Wartet, bis Auftrag request (oder ein neuerer) uebersetzt ist. false bei Timeout.
+        bool waitForCompile(int request, int timeoutMilliseconds = 10000);
+
+        // Wie FX8010::setRegisterValue(name) als Event, fuer das laufende und ein wartendes Programm.
+        // Nicht im Audio-Thread. false, wenn es das Register nicht gibt oder die Queue voll ist.
+        bool setRegisterValue(const std::string &registerName, float value, int64_t sampleTime = -1);
+
+        // Audio-Thread. Ohne uebersetztes Programm Stille.
+        void processBlock(const float *const *inputs, float *const *outputs, int numFrames);
+        inline int getChannels() { return numChannels; }
+        // Anzahl uebernommener Programme
+        inline int getSwapCount() { return swapCount.load(std::memory_order_relaxed); }
+        // Nur im Audio-Thread, gueltig bis zum naechsten processBlock()
+        inline FX8010 *getActiveProgram() { return (active != nullptr) ? active->program.get() : nullptr; }
+        inline bool isCrossfading() { return fading != nullptr; }
+
+    private:
+        // Ein uebersetztes Programm mit Registerzuordnung zum Vorgaenger
+        struct Generation
+        {
+            std::unique_ptr<FX8010> program;
+            Generation *base = nullptr;                  // Vorgaenger (laeuft, bis dieses uebernommen ist)
+            std::vector<std::pair<int, int>> registerMap; // Werteindex in base -> Werteindex in program
+            std::atomic<bool> activated{false};
+        };
+
+        static const int CROSSFADE_CHUNK = 256; // Host-Frames je Durchlauf waehrend der Ueberblendung
+
+        int numChannels;
+
+        // Compile-Thread
+        std::thread worker;
+        std::mutex mutex; // Auftraege, Ergebnis, Lebensdauer der Programme (nie im Audio-Thread)
+        std::condition_variable workerSignal;
+        std::condition_variable resultSignal;
+        bool stopWorker = false;
+        std::string requestedSource;
+        bool requestWaiting = false;
+        int requestedNumber = 0; // letzter Auftrag
+        int compiledNumber = 0;  // letzter uebersetzter Auftrag
+        CompileResult lastResult;
+        int hostSampleRate = SAMPLERATE;
+        FX8010::EngineType engineType = FX8010::ENGINE_DECODED;
+        bool optimizerEnabled = true;
+        Generation *newest = nullptr; // zuletzt veroeffentlicht (wartend oder laufend)
+
+        // Uebergabe zwischen den Threads
+        std::atomic<Generation *> pending{nullptr}; // Compile-Thread -> Audio-Thread
+        std::atomic<Generation *> retired{nullptr}; // Audio-Thread -> Compile-Thread
+        std::atomic<int> crossfadeSamples{480};
+        std::atomic<int> swapCount{0};
+
+        // Audio-Thread
+        Generation *active = nullptr;
+        Generation *fading = nullptr; // altes Programm waehrend der Ueberblendung
+        int fadePosition = 0;
+        int fadeLength = 0;
+        std::vector<float, AlignedAllocator<float, 64>> fadeBuffer; // Ausgang des alten Programms
+        std::vector<float *> fadeOutputs;
+        std::vector<const float *> chunkInputs;
+        std::vector<float *> chunkOutputs;
+
+        void workerLoop();
+        std::unique_ptr<FX8010> build(const std::string &source, int sampleRate, FX8010::EngineType type, bool optimize, CompileResult &result);
+        void publish(std::unique_ptr<FX8010> program);
+        void collectRetired();
+        static void mapRegisters(Generation &generation);
+        void processCrossfade(const float *const *inputs, float *const *outputs, int numFrames);
+    };
+
+} // namespace Klangraum
+
+#endif // FX8010HOTSWAP_H
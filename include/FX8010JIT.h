@@ -0,0 +1,181 @@
+// Copyright 2023 Klangraum
+// x86-64 JIT Backend fuer den FX8010 Emulator
+// Der Compiler selbst ist FX8010::compileJIT() (source/FX8010JIT.cpp), hier liegen nur
+// der minimale Assembler und die Verwaltung des ausfuehrbaren Speichers.
+
+#ifndef FX8010JIT_H
+#define FX8010JIT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// JIT nur auf x86-64, sonst bleibt der dekodierte Interpreter aktiv
+#if defined(__x86_64__) || defined(_M_X64)
+#define FX8010_JIT_SUPPORTED 1
+#else
+#define FX8010_JIT_SUPPORTED 0
+#endif
+
+namespace Klangraum
+{
+
+    // Laufzeitkontext fuer den erzeugten Code
+    struct JITContext
+    {
+        void *dsp = nullptr;                  // FX8010 Instanz (1. Argument fuer Helper-Aufrufe)
+        float *registerFile = nullptr;        // Basisadresse der Registerwerte
+        double *accumulator = nullptr;        // Akkumulator der Instanz
+        const float *const *inputs = nullptr; // planar, wie processBlock()
+        float *const *outputs = nullptr;      // planar, wie processBlock()
+        int64_t instructionCount = 0;         // ausgefuehrte Instruktionen im Block
+        int64_t frameOffset = 0;              // Frame * 4 vor Delayline-Helpern, sonst 0
+    };
+
+    // Erzeugte Funktion: verarbeitet numFrames Samplezyklen
+    typedef void (*JITFunction)(JITContext *context, int numFrames);
+
+    // Ausfuehrbarer Speicher (mmap/VirtualAlloc), wird nach dem Kopieren schreibgeschuetzt
+    class ExecutableMemory
+    {
+    public:
+        ExecutableMemory() {}
+        ~ExecutableMemory() { release(); }
+        ExecutableMemory(const ExecutableMemory &) = delete;
+        ExecutableMemory &operator=(const ExecutableMemory &) = delete;
+
+        bool assign(const std::vector<uint8_t> &code);
+        void release();
+        void *data() const { return memory; }
+        size_t getSize() const { return size; }
+
+    private:
+        void *memory = nullptr;
+        size_t size = 0;
+    };
+
+    // Minimaler x86-64 Assembler (nur skalare SSE/SSE2 Befehle, laeuft auf jeder x86-64 CPU)
+    class X86Emitter
+    {
+    public:
+        enum Reg64
+        {
+            RAX = 0, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+            R8, R9, R10, R11, R12, R13, R14, R15
+        };
+
+        // Bedingungen fuer jcc (Flags nach ucomiss/cmp)
+        enum Condition
+        {
+            CC_B = 0x2,
+            CC_AE = 0x3,
+            CC_E = 0x4,
+            CC_NE = 0x5,
+            CC_BE = 0x6,
+            CC_A = 0x7,
+            CC_P = 0xa,
+            CC_NP = 0xb,
+            CC_L = 0xc,
+            CC_GE = 0xd,
+            CC_LE = 0xe,
+            CC_G = 0xf
+        };
+
+        // SSE Opcodes (zweites Byte nach 0x0F)
+        enum SSEOp
+        {
+            SSE_MOVS_LOAD = 0x10,
+            SSE_MOVS_STORE = 0x11,
+            SSE_CVTSI2S = 0x2a,
+            SSE_CVTTS2SI = 0x2c,
+            SSE_UCOMIS = 0x2e,
+            SSE_XORP = 0x57,
+            SSE_ADD = 0x58,
+            SSE_MUL = 0x59,
+            SSE_CVT = 0x5a,
+            SSE_SUB = 0x5c,
+            SSE_MIN = 0x5d,
+            SSE_MAX = 0x5f,
+            SSE_MOVAPS = 0x28
+        };
+
+        // Praefixe: skalar single (F3), skalar double (F2), packed (keins)
+        enum SSEPrefix
+        {
+            PREFIX_NONE = 0,
+            PREFIX_SS = 0xf3,
+            PREFIX_SD = 0xf2
+        };
+
+        // Operand: XMM Register, [base + disp32] oder Konstante aus dem Konstantenpool (RIP-relativ)
+        struct Operand
+        {
+            enum Kind
+            {
+                XMM,
+                MEMORY,
+                CONSTANT
+            } kind;
+            int reg;      // Register (XMM, bei cvtsi2ss/cvttss2si GPR) bzw. Basisregister
+            int32_t disp; // Displacement bzw. Index im Konstantenpool
+        };
+
+        static Operand xmm(int reg) { return {Operand::XMM, reg, 0}; }
+        static Operand mem(int base, int32_t disp) { return {Operand::MEMORY, base, disp}; }
+
+        // Konstantenpool (16 Byte aligned hinter dem Code)
+        Operand constantFloat(float value);
+        Operand constantDouble(double value);
+
+        // Labels
+        int newLabel();
+        void bind(int label);
+        void jmp(int label);
+        void jcc(Condition condition, int label);
+
+        // SSE: reg = Ziel (XMM oder GPR bei cvttss2si), rm = Quelle
+        void sse(SSEPrefix prefix, SSEOp op, int reg, const Operand &rm);
+        // movss/movsd [mem], xmm
+        void sseStore(SSEPrefix prefix, const Operand &rm, int reg);
+        void movaps(int dst, int src) { sse(PREFIX_NONE, SSE_MOVAPS, dst, xmm(src)); }
+
+        // Integer-Befehle
+        void push(int reg);
+        void pop(int reg);
+        void movRegReg64(int dst, int src);
+        void movRegMem64(int dst, int base, int32_t disp);
+        void movMemReg64(int base, int32_t disp, int src);
+        void movImm64(int dst, uint64_t imm);
+        void movImm32(int dst, int32_t imm);
+        void movsxd(int dst, int src);
+        void xorReg32(int dst, int src);
+        void addRegReg64(int dst, int src);
+        void addImm64(int dst, int32_t imm);
+        void subImm64(int dst, int32_t imm);
+        void cmpRegReg64(int a, int b);
+        void testRegReg64(int a, int b);
+        void shlImm64(int dst, uint8_t imm);
+        void callReg(int reg);
+        void ret();
+
+        // Loest Labels und Konstanten auf, gibt fertigen Maschinencode zurueck
+        bool finalize(std::vector<uint8_t> &out);
+
+    private:
+        std::vector<uint8_t> code;
+        std::vector<int> labelPositions;
+        std::vector<std::pair<size_t, int>> labelFixups;    // Position des rel32, Label
+        std::vector<std::pair<size_t, int>> constantFixups; // Position des disp32, Offset im Pool
+        std::vector<uint8_t> constantPool;
+
+        void emit8(uint8_t value) { code.push_back(value); }
+        void emit32(uint32_t value);
+        void emit64(uint64_t value);
+        void rex(bool w, int reg, int rm);
+        void modrm(int reg, const Operand &rm);
+        Operand addConstant(const void *data, size_t bytes);
+    };
+
+} // namespace Klangraum
+
+#endif // FX8010JIT_H
@@ -0,0 +1,103 @@
+// Copyright 2023 Klangraum
+// Lane-parallele Engine: ein geladenes Programm fuer viele unabhaengige Instanzen (Busse)
+// Jedes GPR ist ein Vektor ueber 4, 8 oder 16 Instanzen (Lanes). Die Schleifen ueber die Lanes
+// haben eine feste Laenge und werden vom Compiler vektorisiert (SSE, mit -mavx2 bzw. -mavx512f
+// entsprechend breiter). Ein Befehlsdispatch gilt damit fuer alle Lanes einer Gruppe.
+
+#ifndef FX8010LANES_H
+#define FX8010LANES_H
+
+#include "FX8010.h"
+
+namespace Klangraum
+{
+
+    class FX8010Lanes
+    {
+    public:
+        static const int MAX_LANE_WIDTH = 16;
+
+        // program muss geladen sein (loadFile), Registerwerte werden als Startzustand uebernommen.
+        // Das Programm muss laenger leben als die Lanes (Instruktionen, Registerlayout).
+        FX8010Lanes(FX8010 &program, int numInstances);
+        ~FX8010Lanes();
+
+        // Planar: inputs[Instanz * numChannels + Kanal][Sample], outputs genauso
+        void processBlock(const float *const *inputs, float *const *outputs, int numFrames);
+
+        // Register einer Instanz, Rueckgabe wie FX8010::setRegisterValue() (0 = OK)
+        int setRegisterValue(int instance, const std::string &key, float value);
+        float getRegisterValue(int instance, const std::string &key);
+
+        inline int getNumInstances() { return numInstances; }
+        // Lanes je Gruppe (4, 8 oder 16, abhaengig von der Anzahl der Instanzen)
+        inline int getLaneWidth() { return laneWidth; }
+        inline int getChannels() { return numChannels; }
+        // Summe der ausgefuehrten Instruktionen aller Instanzen
+        inline int64_t getInstructionCounter() { return instructionCounter; }
+
+    private:
+        // Instruktion mit aufgeloesten Werteindizes (Index in FX8010::registerValues)
+        struct LaneInstruction
+        {
+            int opcode = 0;
+            int R = 0;
+            int A = 0;
+            int X = 0;
+            int Y = 0;
+            int noise = -1;      // Werteindex des NOISE Operanden, -1 = keiner
+            int delayMode = 0;   // IDELAY/XDELAY: 1 = read, 2 = write, 0 = nichts
+            bool writesCCR = true; // CCR Ergebnis kann gelesen werden (Optimierer)
+        };
+
+        // Zustand von laneWidth Instanzen, alle Arrays lane-interleaved: [Index][Lane]
+        struct LaneGroup
+        {
+            std::vector<float, AlignedAllocator<float, 64>> values;
+            std::vector<float, AlignedAllocator<float, 64>> smallDelay;
+            std::vector<float, AlignedAllocator<float, 64>> largeDelay;
+            alignas(64) double accumulator[MAX_LANE_WIDTH];
+            int skip[MAX_LANE_WIDTH];
+            int smallDelayPos; // TRAM Position, +1 je Samplezyklus
+            int largeDelayPos;
+            int32_t noiseX1[MAX_LANE_WIDTH];
+            int32_t noiseX2[MAX_LANE_WIDTH];
+        };
+
+        FX8010 &program;
+        int numInstances;
+        int numChannels;
+        int laneWidth;
+        int numValues;
+        int smallDelayMask;
+        int largeDelayMask;
+        int64_t instructionCounter = 0;
+
+        // Wie beim JIT: CCR und Akkumulator nur fuehren, wenn das Programm sie liest
+        bool ccrUsed = false;
+        bool accumulatorUsed = false;
+
+        std::vector<LaneInstruction> laneInstructions;
+        std::vector<LaneGroup> groups;
+        // I/O Register: Werteindex und Kanal
+        struct LaneIO
+        {
+            int valueIndex;
+            int IOIndex;
+        };
+        std::vector<LaneIO> inputRegisters;
+        std::vector<LaneIO> outputRegisters;
+        std::unordered_map<std::string, int> valueIndexByName;
+
+        // Block fuer eine Gruppe mit W Lanes
+        template <int W>
+        void processGroup(LaneGroup &group, int firstInstance, const float *const *inputs, float *const *outputs, int numFrames);
+
+        // 1 Samplezyklus fuer alle Lanes einer Gruppe (Instruktionen in Lockstep, SKIP per Lanemaske)
+        template <int W>
+        void processSample(LaneGroup &group, int numActiveLanes);
+    };
+
+} // namespace Klangraum
+
+#endif // FX8010LANES_H
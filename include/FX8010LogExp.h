@@ -0,0 +1,136 @@
+// Copyright 2023 Klangraum
+// LOG/EXP Kernels ohne Lookup Tables, gemeinsam fuer alle Engines und Instanzen
+// Wie im Chip eine Exponent/Mantisse-Wandlung: log2 wird stueckweise linear gebildet, ganzzahliger
+// Teil = Exponent, Nachkommastellen = Mantisse (float: IEEE Bits, Q31: fuehrende Nullen).
+//   LOG: |R| = 1 + log2(|A|) / (X + 1), Werte unter 2^-(X + 1) ergeben 0
+//   EXP: Umkehrung von LOG, |R| = 2^((|A| - 1) * (X + 1)), A = 0 ergibt 0
+//   X:   Exponentenbereich 0..31 (0x1F = 32 Oktaven)
+//   Y:   Vorzeichen von R, 0 = wie A, 1 = Betrag, 2 = negativer Betrag, 3 = wie -A
+// |A| > 1.0 (nur float) wird wie 1.0 behandelt. Die Kernels verzweigen nicht (nur Selects),
+// Schleifen ueber Lanes bzw. Samples werden vom Compiler vektorisiert.
+
+#ifndef FX8010LOGEXP_H
+#define FX8010LOGEXP_H
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Klangraum
+{
+
+    // 1 / (X + 1), einmal je Prozess zur Compilezeit
+    struct LogExpScale
+    {
+        float reciprocal[32];
+        constexpr LogExpScale() : reciprocal()
+        {
+            for (int i = 0; i < 32; i++)
+                reciprocal[i] = 1.0f / static_cast<float>(i + 1);
+        }
+    };
+    inline constexpr LogExpScale logExpScale{};
+
+    inline int logExpRange(const int exponent)
+    {
+        return (exponent < 0) ? 0 : ((exponent > 31) ? 31 : exponent);
+    }
+
+    inline uint32_t floatBits(const float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    inline float bitsFloat(const uint32_t bits)
+    {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // Vorzeichenbit von R nach Y (0 = wie A, 1 = +, 2 = -, 3 = wie -A), 0 bleibt +0
+    inline uint32_t logExpSign(const bool negativeA, const int sign, const bool isZero)
+    {
+        const int mode = sign & 3;
+        const bool negative = ((mode == 0 || mode == 3) && negativeA) != (mode >= 2);
+        return (negative && !isZero) ? 0x80000000u : 0u;
+    }
+
+    inline float logLinear(const float a, const int exponent, const int sign)
+    {
+        const uint32_t bits = floatBits(a);
+        const uint32_t magnitude = bits & 0x7FFFFFFF;
+        // Exponent + Mantisse als lineare Nachkommastellen
+        const float logarithm = static_cast<float>(static_cast<int>(magnitude >> 23) - 127) + static_cast<float>(magnitude & 0x7FFFFF) * (1.0f / 8388608.0f);
+        float r = 1.0f + logarithm * logExpScale.reciprocal[logExpRange(exponent)];
+        r = (r < 0.0f) ? 0.0f : ((r > 1.0f) ? 1.0f : r);
+        return bitsFloat(floatBits(r) | logExpSign(bits >> 31, sign, r == 0.0f));
+    }
+
+    inline float expLinear(const float a, const int exponent, const int sign)
+    {
+        const uint32_t bits = floatBits(a);
+        float v = bitsFloat(bits & 0x7FFFFFFF);
+        v = (v > 1.0f) ? 1.0f : v;
+        const float logarithm = (v - 1.0f) * static_cast<float>(logExpRange(exponent) + 1); // [-32, 0]
+        // floor() ueber die Integerwandlung (logarithm <= 0)
+        int e = static_cast<int>(logarithm);
+        e -= (static_cast<float>(e) > logarithm) ? 1 : 0;
+        const float mantissa = 1.0f + (logarithm - static_cast<float>(e));
+        float r = bitsFloat(static_cast<uint32_t>(e + 127) << 23) * mantissa;
+        r = (v > 0.0f) ? r : 0.0f;
+        return bitsFloat(floatBits(r) | logExpSign(bits >> 31, sign, r == 0.0f));
+    }
+
+    // Festkomma (Q31): Exponent aus den fuehrenden Nullen
+    inline int countLeadingZeros(const uint32_t x)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        return _BitScanReverse(&index, x) ? 31 - static_cast<int>(index) : 32;
+#else
+        return x ? __builtin_clz(x) : 32;
+#endif
+    }
+
+    inline int32_t logExpSignQ31(const int64_t magnitude, const bool negativeA, const int sign)
+    {
+        const int64_t clamped = (magnitude > INT32_MAX) ? INT32_MAX : magnitude;
+        return static_cast<int32_t>(logExpSign(negativeA, sign, clamped == 0) ? -clamped : clamped);
+    }
+
+    inline int32_t logLinearQ31(const int32_t a, const int exponent, const int sign)
+    {
+        // |A|, 0x80000000 = 1.0
+        const uint32_t u = (a < 0) ? 0u - static_cast<uint32_t>(a) : static_cast<uint32_t>(a);
+        const int n = logExpRange(exponent) + 1;
+        const int p = 31 - countLeadingZeros(u | 1); // log2 = (p - 31) + Mantisse
+        const int64_t mantissa = static_cast<uint32_t>(u << (31 - p)) & 0x7FFFFFFF;
+        int64_t r = static_cast<int64_t>(n + p - 31) * (int64_t(1) << 31) + mantissa;
+        r = (r < 0) ? 0 : r / n;
+        return logExpSignQ31(u ? r : 0, a < 0, sign);
+    }
+
+    inline int32_t expLinearQ31(const int32_t a, const int exponent, const int sign)
+    {
+        const uint32_t u = (a < 0) ? 0u - static_cast<uint32_t>(a) : static_cast<uint32_t>(a);
+        const int n = logExpRange(exponent) + 1;
+        // -log2 in Q31 (>= 0), ganzzahliger Teil und Nachkommastellen
+        const int64_t t = static_cast<int64_t>((uint32_t(1) << 31) - u) * n;
+        const int64_t integer = t >> 31;
+        const int64_t fraction = t & 0x7FFFFFFF;
+        // 2^-t = (1 + f) * 2^e mit e = -ceil(t), f = 1 - fraction
+        const int shift = static_cast<int>(integer) + (fraction ? 1 : 0);
+        const uint64_t mantissa = fraction ? (uint64_t(1) << 32) - static_cast<uint64_t>(fraction) : (uint64_t(1) << 31);
+        const int64_t r = static_cast<int64_t>(mantissa >> shift);
+        return logExpSignQ31(u ? r : 0, a < 0, sign);
+    }
+
+} // namespace Klangraum
+
+#endif // FX8010LOGEXP_H
@@ -0,0 +1,51 @@
+// Copyright 2023 Klangraum
+// Rack aus vielen unabhaengigen FX8010 Instanzen (z.B. Render-Node mit Hunderten Bussen).
+// processBlock() rechnet alle Instanzen ueber einen FX8010ThreadPool. Jede Instanz liegt in einem
+// eigenen, auf 64 Byte ausgerichteten Slot, zwei Threads schreiben nie in dieselbe Cache-Line.
+
+#ifndef FX8010RACK_H
+#define FX8010RACK_H
+
+#include "FX8010.h"
+#include "FX8010ThreadPool.h"
+
+namespace Klangraum
+{
+
+    class FX8010Rack
+    {
+    public:
+        // numThreads wie FX8010ThreadPool (-1 = einer weniger als Hardware-Threads)
+        explicit FX8010Rack(int numThreads = -1) : pool(numThreads) {}
+
+        // Instanz anlegen und Programm laden, Rueckgabe Index oder -1
+        int addInstance(const std::string &path, int numChannels = 2);
+        inline FX8010 *getInstance(int index) { return &slots[index]->program; }
+        inline int getNumInstances() { return static_cast<int>(slots.size()); }
+        inline int getNumThreads() { return pool.getNumThreads() + 1; }
+        inline FX8010ThreadPool &getThreadPool() { return pool; }
+
+        // Planar je Instanz: inputs[Instanz][Kanal][Sample], outputs genauso
+        void processBlock(const float *const *const *inputs, float *const *const *outputs, int numFrames);
+
+    private:
+        struct alignas(64) Slot
+        {
+            FX8010 program;
+            explicit Slot(int numChannels) : program(numChannels) {}
+        };
+
+        std::vector<std::unique_ptr<Slot>> slots;
+        FX8010ThreadPool pool;
+
+        // Argumente des laufenden processBlock() fuer die Aufgaben
+        const float *const *const *blockInputs = nullptr;
+        float *const *const *blockOutputs = nullptr;
+        int blockFrames = 0;
+
+        static void processInstance(void *context, int index);
+    };
+
+} // namespace Klangraum
+
+#endif // FX8010RACK_H
@@ -0,0 +1,73 @@
+// Copyright 2023 Klangraum
+// Polyphase Resampler fuer den FX8010 Emulator
+// Der Chip laeuft immer mit 48 kHz (SAMPLERATE), TRAM Groessen und Delayzeiten sind in 48 kHz Samples
+// angegeben. FX8010::setHostSampleRate() setzt je einen Resampler vor (Host -> 48 kHz) und hinter
+// (48 kHz -> Host) das Programm.
+// Verhaeltnis L/M aus ganzzahligen Raten (44.1 kHz -> 48 kHz = 160/147), FIR mit Kaiser-Fenster
+// (80 dB), je Ausgangssample eine Phase mit tapsPerPhase Koeffizienten. Die Faltung rechnet in
+// 8 unabhaengigen Teilsummen, die Schleife wird vom Compiler vektorisiert (wie FX8010Lanes).
+
+#ifndef FX8010RESAMPLER_H
+#define FX8010RESAMPLER_H
+
+#include <vector>
+
+#include "helpers.h"
+
+namespace Klangraum
+{
+
+    class PolyphaseResampler
+    {
+    public:
+        // Teilsummen der Faltung (tapsPerPhase wird auf ein Vielfaches aufgerundet)
+        static const int SIMD_WIDTH = 8;
+
+        PolyphaseResampler() {}
+
+        // maxPushFrames: hoechstens so viele Frames je push()
+        void setup(int numChannels, int inputRate, int outputRate, int maxPushFrames, int tapsPerPhase = 96);
+        // Verlauf loeschen, primingFrames Null-Frames als Vorlauf (Puffer gegen Unterlauf)
+        void reset(int primingFrames = 0);
+
+        // Eingangsframes anhaengen, planar: inputs[Kanal][Sample]
+        void push(const float *const *inputs, int numFrames);
+        // Anzahl der Ausgangsframes, die mit den vorhandenen Eingangsframes berechnet werden koennen
+        int available() const;
+        // numFrames Ausgangsframes berechnen, fehlende Eingangsframes zaehlen als 0
+        void pull(float *const *outputs, int numFrames);
+
+        // Gruppenlaufzeit des Filters in Sekunden (ohne Vorlauf)
+        double getLatencySeconds() const;
+        // Hoechstens so viele Ausgangsframes entstehen aus numFrames Eingangsframes
+        int maxOutputFrames(int numInputFrames) const;
+        inline int getUpFactor() const { return upFactor; }
+        inline int getDownFactor() const { return downFactor; }
+        // Koeffizienten und Verlauf in Bytes
+        size_t getMemoryFootprint() const;
+
+    private:
+        int numChannels = 0;
+        int inputRate = 0;
+        int upFactor = 1;   // L
+        int downFactor = 1; // M
+        int taps = 0;       // Koeffizienten je Phase
+
+        // [Phase][Tap], je Phase zeitlich umgekehrt: Tap taps-1 gehoert zum juengsten Sample
+        std::vector<float, AlignedAllocator<float, 64>> coefficients;
+
+        // Eingangssamples je Kanal, vorne taps-1 Samples Verlauf
+        std::vector<std::vector<float, AlignedAllocator<float, 64>>> history;
+        int capacity = 0;
+        int fill = 0;      // belegte Samples je Kanal
+        int readIndex = 0; // juengstes Sample fuer das naechste Ausgangssample
+        int phase = 0;     // Phase des naechsten Ausgangssamples (0..L-1)
+
+        void design();
+        // verbrauchte Samples vorne entfernen
+        void compact();
+    };
+
+} // namespace Klangraum
+
+#endif // FX8010RESAMPLER_H
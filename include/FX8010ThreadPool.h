@@ -0,0 +1,68 @@
+// Copyright 2023 Klangraum
+// Thread-Pool fuer viele unabhaengige Aufgaben je Audio-Callback (Rack aus FX8010 Instanzen, Ebenen
+// von FX8010Graph). run() verteilt die Aufgabenindizes als zusammenhaengende Bereiche auf eine Queue
+// je Thread (der Aufrufer ist Thread 0 und rechnet mit). Jeder Thread nimmt von hinten aus seiner
+// Queue, ist sie leer, stiehlt er die vordere Haelfte einer anderen Queue.
+// Eine Queue ist ein Bereich [top, bottom) in einem 64 Bit Wort mit der Laufnummer des Auftrags,
+// Nehmen und Stehlen sind je ein CAS (keine Locks, keine Allokation in run()).
+// Fertig melden: jeder Thread zieht seine erledigten Aufgaben einmal mit fetch_sub ab (wait-free),
+// der Aufrufer wartet, bis der Zaehler 0 ist.
+// Wartende Worker drehen erst, geben dann die Zeitscheibe ab und schlafen zuletzt kurz.
+
+#ifndef FX8010THREADPOOL_H
+#define FX8010THREADPOOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace Klangraum
+{
+
+    class FX8010ThreadPool
+    {
+    public:
+        typedef void (*Task)(void *context, int index);
+
+        // Anzahl Worker zusaetzlich zum Aufrufer, -1 = einer weniger als Hardware-Threads
+        explicit FX8010ThreadPool(int numThreads = -1);
+        ~FX8010ThreadPool();
+
+        // task(context, i) fuer i = 0..numTasks-1, kehrt zurueck, wenn alle erledigt sind.
+        // Nicht reentrant: nur ein Thread darf run() gleichzeitig aufrufen.
+        void run(int numTasks, Task task, void *context);
+
+        inline int getNumThreads() const { return static_cast<int>(threads.size()); }
+        // Gestohlene Bereiche seit dem Start (Lastverteilung)
+        inline int64_t getStealCount() const { return stealCount.load(std::memory_order_relaxed); }
+
+    private:
+        // Eigene Cache-Line je Queue, sonst teilen sich benachbarte Threads die Line (False Sharing)
+        struct alignas(64) Queue
+        {
+            std::atomic<uint64_t> range{0}; // Laufnummer (20 Bit) | top (22 Bit) | bottom (22 Bit)
+        };
+
+        int numQueues = 1;
+        std::unique_ptr<Queue[]> queues;
+        std::vector<std::thread> threads;
+
+        alignas(64) std::atomic<uint32_t> epoch{0};
+        std::atomic<Task> currentTask{nullptr};
+        std::atomic<void *> currentContext{nullptr};
+        alignas(64) std::atomic<int> remaining{0};
+        std::atomic<int64_t> stealCount{0};
+        std::atomic<bool> stopThreads{false};
+
+        void workerLoop(int queue);
+        // Eigene Queue abarbeiten und stehlen, bis nichts mehr da ist. Rueckgabe: erledigte Aufgaben.
+        int execute(int queue, uint32_t epoch, Task task, void *context);
+        bool pop(int queue, uint32_t epoch, int &index);
+        bool steal(int queue, uint32_t epoch);
+    };
+
+} // namespace Klangraum
+
+#endif // FX8010THREADPOOL_H
@@ -4,10 +4,12 @@
 #define HELPERS_H
 
 #include <string>
-#include <regex>
+#include <cctype>
 #include <map>
 #include <iostream>
 #include <cstdint>
+#include <cstddef>
+#include <new>
 
 namespace Klangraum
 {
@@ -36,6 +38,37 @@ namespace Klangraum
 
     void printLine(int count);
 
+    // Allocator fuer std::vector mit ausgerichtetem Speicher (z.B. 64 Byte = Cache Line)
+    template <typename T, std::size_t Alignment>
+    struct AlignedAllocator
+    {
+        typedef T value_type;
+
+        template <typename U>
+        struct rebind
+        {
+            typedef AlignedAllocator<U, Alignment> other;
+        };
+
+        AlignedAllocator() noexcept {}
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+        T *allocate(std::size_t n)
+        {
+            return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+        }
+        void deallocate(T *p, std::size_t) noexcept
+        {
+            ::operator delete(p, std::align_val_t(Alignment));
+        }
+
+        template <typename U>
+        bool operator==(const AlignedAllocator<U, Alignment> &) const noexcept { return true; }
+        template <typename U>
+        bool operator!=(const AlignedAllocator<U, Alignment> &) const noexcept { return false; }
+    };
+
 } // namespace Klangraum
 
 #endif // HELPERS_H
\ No newline at end of file
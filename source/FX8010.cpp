@@ -3,6 +3,11 @@
 #include "../include/FX8010.h"
 #include "../include/helpers.h"
 
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+
 // Namespace Klangraum
 namespace Klangraum
 {
@@ -15,13 +20,16 @@ namespace Klangraum
 
 	void FX8010::initialize()
 	{
-		printLine(80);
+		if (DEBUG)
+			printLine(80);
 
-		cout << "Initialisiere den DSP..." << endl;
+		if (DEBUG)
+			cout << "Initialisiere den DSP..." << endl;
 
 		// Erstelle Fehler-Map
 		//--------------------------------------------------------------------------------
-		cout << "Erstelle die Fehler-Map" << endl;
+		if (DEBUG)
+			cout << "Erstelle die Fehler-Map" << endl;
 		errorMap[ERROR_NONE] = "Kein Fehler";
 		errorMap[ERROR_INVALID_INPUT] = "Ungueltige Eingabe";
 		errorMap[ERROR_DIVISION_BY_ZERO] = "Division durch Null";
@@ -33,6 +41,7 @@ namespace Klangraum
 		errorMap[ERROR_SYNTAX_NOT_VALID] = "Ungueltige Syntax";
 		errorMap[ERROR_ITRAMSIZE_TO_LARGE] = "iTRAM Size ausserhalb des gueltigen Bereichs (max. " + std::to_string(MAX_IDELAY_SIZE) + ")";
 		errorMap[ERROR_XTRAMSIZE_TO_LARGE] = "xRAM Size ausserhalb des gueltigen Bereichs (max. " + std::to_string(MAX_XDELAY_SIZE) + ")";
+		errorMap[ERROR_INVALID_BYTECODE] = "Ungueltiger Bytecode";
 
 		// Liste mit Fehlern initialisieren
 		errorList.clear();
@@ -45,7 +54,8 @@ namespace Klangraum
 		//--------------------------------------------------------------------------------
 		// Lege CCR Register an. Wir nutzen es wie ein GPR.
 		// NOTE: Map wäre in Zukunft besser, um GPR oder Instruktion über Stringlabel zu identifizieren.
-		cout << "Lege Spezialregister an (CCR, READ, WRTIE, AT)" << endl;
+		if (DEBUG)
+			cout << "Lege Spezialregister an (CCR, READ, WRTIE, AT)" << endl;
 
 		registers.push_back({CCR, "ccr", 0, 0}); // GPR Index 0
 
@@ -53,154 +63,74 @@ namespace Klangraum
 		registers.push_back({READ, "read", 0, 0});	 // GPR Index 1
 		registers.push_back({WRITE, "write", 0, 0}); // GPR Index 2
 		registers.push_back({AT, "at", 0, 0});		 // GPR Index 3
-
-		// LOG, EXP Tables anlegen (Wertebereich: -1.0 bis 1.0)
-		//--------------------------------------------------------------------------------
-		// Schar von Lookup Tables in einem Vector
-		// TODO(Klangraum): sign
-		cout << "Erzeuge LOG, EXP Lookuptables" << endl;
-
-		int numExponent = 32;
-		int numEntries = 32;
-		int x_min = 0; // < 0 gives nan!
-		int x_max = 1.0;
-
-		lookupTablesLog.reserve(numExponent - 1);
-		lookupTablesExp.reserve(numExponent - 1);
-
-		// Populate lookupTablesLog with lookup tables for different i values
-		// Tabellen mit (4 Vorzeichen (sign)) und 31 Exponenten je 32 Werte (2x für LOG und EXP)
-		for (int i = 0; i < numExponent; i++)
-		{
-			std::vector<double> lookupTableLog = createLogLookupTable(0, 1.0, numEntries, i);
-			std::vector<double> temp;
-			temp.resize(32); // Initialisierung mit 0
-			// an Y-Achse spiegeln
-			temp = mirrorYVector(lookupTableLog);
-			// letztes Element, jetzt 0, löschen, um doppelte 0 zu vermeiden
-			// QUESTION: Brauchen wir das?
-			// temp.pop_back();
-			// Negieren
-			temp = negateVector(temp); // = MirrorX
-			// Verknüpfen Sie die beiden Vektoren
-			temp = concatenateVectors(temp, lookupTableLog);
-			temp.shrink_to_fit(); // um sicherzugehen, dass die Vector Size korrekt ist.
-			// Schiebe neuen Vector in die Schar von LOG Vektoren
-			lookupTablesLog.push_back(temp);
-
-			std::vector<double> lookupTableExp = createExpLookupTable(0, 1.0, numEntries, i);
-			temp.resize(32, 0); // Initialisierung mit 0
-			// an Y-Achse spiegeln
-			temp = mirrorYVector(lookupTableExp);
-			// letztes Element, jetzt 0, löschen, um doppelte 0 zu vermeiden
-			// QUESTION: Brauchen wir das?
-			// temp.pop_back();
-			// Negieren
-			temp = negateVector(temp); // = MirrorX
-			// Verknüpfen Sie die beiden Vektoren
-			temp = concatenateVectors(temp, lookupTableExp);
-			// temp1.shrink_to_fit(); // um sicherzugehen, dass die Vector Size korrekt ist.
-			//  Schiebe neuen Vector in die Schar von EXP Vektoren
-			lookupTablesExp.push_back(temp);
-		}
+		layoutRegisters();
 
 		// loadFile(path);
 
 		// Delaylines
 		//--------------------------------------------------------------------------------
-		// Speicherallokation nicht ganz klar. Dauert resize() zu lange? (zufällig falsche Werte)
-		// Hier ist reserve() notwendig, sonst kommt es zum Zugriff auf einen leeren Vektor!
-		// resize() erfolgt zusätzlich in Syntaxcheck/Parser aufgrund der Sourcecode-Deklaration.
-		// if (DEBUG)
-		//	cout << "Reserviere Speicherplatz fuer Delaylines" << endl;
-		// smallDelayBuffer.reserve(MAX_IDELAY_SIZE); // 100ms max. Gesamtgroesse
-		// largeDelayBuffer.reserve(MAX_XDELAY_SIZE); // 1s max. Gesamtgroesse
+		// Die Delaylines werden erst beim Laden in der deklarierten Groesse angelegt (layoutDelayLines()),
+		// bis dahin 1 Sample (Maske 0).
+		smallDelayBuffer.assign(1, 0.0f);
+		largeDelayBuffer.assign(1, 0.0f);
 
 		// I/O Buffers initialisieren?
-		// Initialisiere Outputbuffer
-		cout << "Initialisiere Outputbuffer" << endl;
+		// Initialisiere I/O-Buffer
+		if (DEBUG)
+			cout << "Initialisiere I/O-Buffer" << endl;
 		outputBuffer.resize(numChannels, 0.0);
+		inputFrame.resize(numChannels, 0.0);
+		eventInputs.resize(numChannels);
+		eventOutputs.resize(numChannels);
+		// Pointer fuer process() mit JIT/Festkomma (1 Frame aus inputFrame/outputBuffer)
+		for (int channel = 0; channel < numChannels; channel++)
+		{
+			jitFrameInputs.push_back(&inputFrame[channel]);
+			jitFrameOutputs.push_back(&outputBuffer[channel]);
+		}
 
-		printLine(80);
+		if (DEBUG)
+			printLine(80);
 	}
 
-	// CHECKED
-	// Funktion zum Erstellen der Lookup-Tabelle für die n-te Wurzel
-	std::vector<double> FX8010::createLogLookupTable(double x_min, double x_max, int numEntries, int exponent)
+	vector<string> FX8010::getControlRegisters()
 	{
-		std::vector<double> lookupTable;
-		double step = (x_max - x_min) / (numEntries - 1);
-		// push 1. value=0 to avoid nan! only for log(x)! change i to 1!
-		// lookupTable.push_back(0.0f);
-		for (int i = 0; i < numEntries; ++i)
-		{
-			double x = x_min + (i * step);
-			// natural log as seen in dane programming pdf, issues with nan!
-			// double logValue = std::log(x) / exponent + 1;
-			// another good approximation! maybe this is what is really done in the dsp!
-			// they mention approximation of pow and sqrt.
-			double logValue = pow(x, 1.0 / static_cast<float>(exponent));
-			lookupTable.push_back(logValue);
-		}
-		return lookupTable;
+		return controlRegisters;
 	}
 
 	// CHECKED
-	// Funktion zum Erstellen der Lookup-Tabelle für n-te Potenz (EXP)
-	std::vector<double> FX8010::createExpLookupTable(double x_min, double x_max, int numEntries, int exponent)
+	int FX8010::getIOIndex(const std::string &registerName)
 	{
-		std::vector<double> lookupTable;
-		double step = (x_max - x_min) / (numEntries - 1);
-		// lookupTable.push_back(0.0f); // see log for explanation
-		for (int i = 0; i < numEntries; ++i)
-		{
-			double x = x_min + i * step;
-			// double expValue = exp(x * numEntries - numEntries);
-			double expValue = pow(x, static_cast<float>(exponent)); // see log for explanation
-			lookupTable.push_back(expValue);
-		}
-		return lookupTable;
+		const int index = findRegisterIndexByName(registers, registerName);
+		if (index < 0 || (registers[index].registerType != INPUT && registers[index].registerType != OUTPUT))
+			return -1;
+		return registers[index].IOIndex;
 	}
 
 	// CHECKED
-	// Funktion zum Spiegeln des Vectors
-	std::vector<double> FX8010::mirrorYVector(const std::vector<double> &inputVector)
+	int FX8010::getRegisterHandle(const std::string &registerName)
 	{
-		std::vector<double> mirroredVector;
-		for (int i = static_cast<int>(inputVector.size()) - 1; i >= 0; --i)
-		{
-			mirroredVector.push_back(inputVector[i]);
-		}
-		return mirroredVector;
+		const int index = findRegisterIndexByName(registers, registerName);
+		// CONST ist read-only: der Optimierer faltet es wie ein Literal
+		if (index < 0 || registers[index].registerType == CONST || registers[index].valueIndex < 0 || registers[index].valueIndex >= constantSegmentStart)
+			return -1;
+		return registers[index].valueIndex;
 	}
 
 	// CHECKED
-	// Funktion zum Verknüpfen der Vektoren
-	std::vector<double> FX8010::concatenateVectors(const std::vector<double> &vector1, const std::vector<double> &vector2)
+	bool FX8010::pushParameterEvent(int handle, float value, int64_t time)
 	{
-		std::vector<double> concatenatedVector;
-		concatenatedVector.reserve(vector1.size() + vector2.size());
-		concatenatedVector.insert(concatenatedVector.end(), vector1.begin(), vector1.end());
-		concatenatedVector.insert(concatenatedVector.end(), vector2.begin(), vector2.end());
-		return concatenatedVector;
+		if (handle < 0)
+			return false;
+		return eventQueue.push({time, handle, value});
 	}
 
 	// CHECKED
-	// Hier ist eine Funktion zum Negieren eines Vektors
-	std::vector<double> FX8010::negateVector(const std::vector<double> &inputVector)
-	{
-		std::vector<double> negatedVector;
-		negatedVector.reserve(inputVector.size());
-		for (float value : inputVector)
-		{
-			negatedVector.push_back(-value);
-		}
-		return negatedVector;
-	}
-
-	vector<string> FX8010::getControlRegisters()
+	// Wie setRegisterValue(): Smoother, Festkomma-Engine und Pruefung der Handles
+	void FX8010::setRegisterValues(const int *handles, const float *values, int count)
 	{
-		return controlRegisters;
+		for (int i = 0; i < count; i++)
+			setRegisterValue(handles[i], values[i]);
 	}
 
 	// NOT CHECKED
@@ -214,61 +144,49 @@ namespace Klangraum
 		// Siehe wrapAround() für das Setzen des einzelnen Borrow Bits.
 
 		if (result == 0)
-			registers[0].registerValue = 0b01000; // Zero
+			registerValues[0] = 0b01000; // Zero
 		else if (result < 0 && result > -1.0)
-			registers[0].registerValue = 0b00110; // Normalized Negative
+			registerValues[0] = 0b00110; // Normalized Negative
 		else if (result > 0 && result < 1.0)
-			registers[0].registerValue = 0b00010; // Normalized Positive
+			registerValues[0] = 0b00010; // Normalized Positive
 		else if (result == 1.0)
-			registers[0].registerValue = 0b10000; // Positive Saturation
+			registerValues[0] = 0b10000; // Positive Saturation
 		else if (result == -1.0)
-			registers[0].registerValue = 0b10100; // Negative Saturation
+			registerValues[0] = 0b10100; // Negative Saturation
 
 		// Das Borrow Flag (oder Carry Flag) bei Wraparound wird in der Methode wrapAround() gesetzt.
 		// (eigentlich nur bei Festkomma-Arithmetik, hier hilfsweise mit floats)
 
 		else
-			registers[0].registerValue = 0b00000; // Wenn nichts zutrifft
+			registerValues[0] = 0b00000; // Wenn nichts zutrifft
 	}
 
 	// CHECKED
 	// Beschreibe ein Register von VST aus z.B. Sliderinput
 	int FX8010::setRegisterValue(const std::string &key, float value)
 	{
-		bool found = false;
-		for (auto &element : registers)
-		{
-			if (element.registerName == key)
-			{
-				element.registerValue = value;
-				found = true;
-				break;
-			}
-		}
-		if (found)
-		{
-			return 0;
-		}
-		return 1;
+		// Wie getRegisterHandle(): Konstantensegment (Literale teilen sich dort Werte) und CONST sind read-only
+		const int handle = getRegisterHandle(key);
+		if (handle < 0)
+			return 1;
+		setRegisterValue(handle, value);
+		return 0;
 	};
 
 	// CHECKED
 	float FX8010::getRegisterValue(const std::string &key)
 	{
-		for (const auto &element : registers)
-		{
-			if (element.registerName == key)
-			{
-				return element.registerValue;
-			}
-		}
-		return 1; // Or any other default value you want to return if the element is not found
+		const int index = findRegisterIndexByName(registers, key);
+		if (index < 0)
+			return 1; // Or any other default value you want to return if the element is not found
+		// Auch Konstanten und Literale, die kein Handle haben
+		return loadRegisterValue(registers[index].valueIndex);
 	}
 
 	// CHECKED
 	inline int32_t FX8010::getCCR()
 	{
-		return registers[0].registerValue;
+		return registerValues[0];
 	}
 
 	// CHECKED
@@ -278,28 +196,11 @@ namespace Klangraum
 		return (input >= threshold) ? threshold : ((input <= -threshold) ? -threshold : input);
 	}
 
-	// CHECKED
-	// Funktion zur linearen Interpolation mit der Lookup-Tabelle (LOG)
-	inline double FX8010::linearInterpolate(double x, const std::vector<double> &lookupTable, double x_min, double x_max)
-	{
-		double step = (x_max - x_min) / (lookupTable.size() - 1);
-		int index = static_cast<int>((x - x_min) / step);
-		double x1 = x_min + index * step;
-		double x2 = x_min + (index + 1) * step;
-		double y1 = lookupTable[index];
-		double y2 = lookupTable[index + 1];
-
-		// Lineare Interpolation
-		double y = (y2 - y1) / (x2 - x1) * (x - x1) + y1;
-
-		return y;
-	}
-
 	// NOT CHECKED
 	inline float FX8010::wrapAround(const float a)
 	{
 		float result;
-		int32_t ccr_ = floatToInt(registers[0].registerValue);
+		int32_t ccr_ = floatToInt(registerValues[0]);
 
 		if (a >= 1.0f)
 		{
@@ -317,7 +218,7 @@ namespace Klangraum
 			ccr_ = ccr_ & ~0b00001; // Setze Borrow Flag auf 0
 		}
 
-		registers[0].registerValue = intToFloat(ccr_);
+		registerValues[0] = intToFloat(ccr_);
 
 		// Ternäre Schreibweise
 		// (a >= 1.0f)	  ? (ccr_ = 0b00001 | ccr_, a - 2.0f)
@@ -327,7 +228,7 @@ namespace Klangraum
 		return result;
 	}
 
-	inline int32_t FX8010::logicOps(const GPR &A_, const GPR &X_, const GPR &Y_)
+	int32_t FX8010::logicOps(const float A_, const float X_, const float Y_)
 	{
 		// siehe "Processor with Instruction Set for Audio Effects (US930158, 1997).pdf"
 		// A	      X	         Y	        R
@@ -340,9 +241,9 @@ namespace Klangraum
 		// A          X      0xFFFFFF    A nand X
 
 		int32_t R = 0;
-		const int32_t A = static_cast<int32_t>(A_.registerValue);
-		const int32_t X = static_cast<int32_t>(X_.registerValue);
-		const int32_t Y = static_cast<int32_t>(Y_.registerValue);
+		const int32_t A = static_cast<int32_t>(A_);
+		const int32_t X = static_cast<int32_t>(X_);
+		const int32_t Y = static_cast<int32_t>(Y_);
 
 		if (Y == 0)
 			R = A & X; // Bitweise AND-Verknüpfung von A und X
@@ -359,40 +260,251 @@ namespace Klangraum
 		return R;
 	}
 
-	// NOT CHECKED
-	// Syntaxchecker/Parser/Mapper
-	// NOTE: Implementation ist "Just Good Enough". Eine genauere Auswertung und mehr Fehlermeldungen sind wünschenswert.
-	bool FX8010::syntaxCheck(const std::string &input)
+	// Zeilenscanner fuer syntaxCheck(), ersetzt die Regex-Muster (gleiche Grammatik, ohne Backtracking-Engine)
+	//------------------------------------------------------------------------------------------
+	namespace
 	{
-		// verschiedene Kombinationen im Deklarationsteil, auch mehrfache Vorkommen
-		// std::regex pattern1(R"(^\s*(static|temp)\s+((?:\w+\s*(?:=\s*\d+(?:\.\d*)?)?\s*,?\s*)+)\s*$)");
+		// Erfassungsgruppe wie std::ssub_match (text, matched)
+		struct Capture
+		{
+			std::string_view text;
+			bool matched = false;
+			operator std::string() const { return std::string(text); }
+			bool operator==(const char *other) const { return text == other; }
+		};
 
-		// Deklarationen: z.B. static a || static b = 1.0
-		std::regex pattern1(R"(^\s*(static|temp|control|input|output|const)\s+(\w+)(?:[\s=,]*\s*(\d+(?:\.\d+)?))?\s*$)");
+		struct LineMatch
+		{
+			Capture groups[6];
+			const Capture &operator[](int i) const { return groups[i]; }
+			void set(int i, std::string_view text)
+			{
+				groups[i].text = text;
+				groups[i].matched = true;
+			}
+		};
 
-		// Leerzeile
-		std::regex pattern2(R"(^\s*$)");
+		// wie \s, \w und \d
+		inline bool isSpaceChar(const char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r'; }
+		inline bool isWordChar(const char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_'; }
+		inline bool isDigitChar(const char c) { return c >= '0' && c <= '9'; }
+		// Operanden: [a-zA-Z0-9_.-]+
+		inline bool isOperandChar(const char c) { return isWordChar(c) || c == '.' || c == '-'; }
 
-		// TRAMsize im Deklarationsteil
-		std::regex pattern3(R"(^\s*(itramsize|xtramsize)\s+(\d+)*\s$)");
+		inline size_t skipSpaces(std::string_view s, size_t i)
+		{
+			while (i < s.size() && isSpaceChar(s[i]))
+				i++;
+			return i;
+		}
 
-		// Check Instructions
-		std::regex pattern4(R"(^\s*(macs|macsn|macints|macintw|acc3|macmv|macw|macwn|skip|andxor|tstneg|limit|limitn|log|exp|interp|idelay|xdelay)\s+([a-zA-Z0-9_.-]+|\d+\.\d+)\s*,\s*([a-zA-Z0-9_.-]+|\d+\.\d+)\s*,\s*([a-zA-Z0-9_.-]+|\d+\.\d+)\s*,\s*([a-zA-Z0-9_.-]+|\d+\.\d+)\s*$)");
+		inline bool onlySpaces(std::string_view s, size_t i) { return skipSpaces(s, i) == s.size(); }
 
-		// Check Metadata
-		std::regex pattern5(R"(\s*(name|copyright|created|engine|comment|guid)\s+\"([^\"]+)\")");
+		// \d+(?:\.\d+)? ab i, Rueckgabe: Ende oder npos
+		size_t scanNumber(std::string_view s, size_t i)
+		{
+			const size_t start = i;
+			while (i < s.size() && isDigitChar(s[i]))
+				i++;
+			if (i == start)
+				return std::string_view::npos;
+			if (i + 1 < s.size() && s[i] == '.' && isDigitChar(s[i + 1]))
+			{
+				i++;
+				while (i < s.size() && isDigitChar(s[i]))
+					i++;
+			}
+			return i;
+		}
 
-		// Check "end"
-		std::regex pattern6(R"(^\s*(end)\s*$)");
+		bool isKeyword(std::string_view word, std::initializer_list<const char *> keywords)
+		{
+			for (const char *keyword : keywords)
+				if (word == keyword)
+					return true;
+			return false;
+		}
 
-		// Check Kommentar ";"
-		std::regex pattern7(R"(^\s*;+\s*$)");
+		// Rest einer Deklaration ab dem Namen bzw. dem Wert: (?:[\s,]+(ramp|lag)\s+(\d+(?:\.\d+)?))?\s*$
+		bool matchSmoothingSuffix(std::string_view s, size_t i, LineMatch &match)
+		{
+			if (onlySpaces(s, i))
+				return true;
+			size_t j = i;
+			while (j < s.size() && (isSpaceChar(s[j]) || s[j] == ','))
+				j++;
+			if (j == i)
+				return false;
+			const size_t wordStart = j;
+			while (j < s.size() && isWordChar(s[j]))
+				j++;
+			const std::string_view word = s.substr(wordStart, j - wordStart);
+			if (word != "ramp" && word != "lag")
+				return false;
+			const size_t numberStart = skipSpaces(s, j);
+			if (numberStart == j)
+				return false;
+			const size_t numberEnd = scanNumber(s, numberStart);
+			if (numberEnd == std::string_view::npos || !onlySpaces(s, numberEnd))
+				return false;
+			match.set(4, word);
+			match.set(5, s.substr(numberStart, numberEnd - numberStart));
+			return true;
+		}
+
+		// (static|temp|control|input|output|const)\s+(\w+)(?:[\s=,]*\s*(\d+(?:\.\d+)?))?<Suffix>
+		// Der Name gibt wie bei der Regex Ziffern an den Wert ab, wenn es sonst nicht passt ("a1.5").
+		bool matchDeclaration(std::string_view s, size_t i, LineMatch &match)
+		{
+			size_t nameEnd = i;
+			while (nameEnd < s.size() && isWordChar(s[nameEnd]))
+				nameEnd++;
+			for (size_t end = nameEnd; end > i; end--)
+			{
+				LineMatch candidate = match;
+				candidate.set(2, s.substr(i, end - i));
+				// mit Wert
+				size_t j = end;
+				while (j < s.size() && (isSpaceChar(s[j]) || s[j] == '=' || s[j] == ','))
+					j++;
+				const size_t numberEnd = scanNumber(s, j);
+				if (numberEnd != std::string_view::npos)
+				{
+					LineMatch withValue = candidate;
+					withValue.set(3, s.substr(j, numberEnd - j));
+					if (matchSmoothingSuffix(s, numberEnd, withValue))
+					{
+						match = withValue;
+						return true;
+					}
+				}
+				// ohne Wert
+				if (matchSmoothingSuffix(s, end, candidate))
+				{
+					match = candidate;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// (itramsize|xtramsize)\s+(\d+)*\s$ (genau ein Leerzeichen am Ende)
+		bool matchTramSize(std::string_view s, size_t i, LineMatch &match)
+		{
+			const size_t digits = skipSpaces(s, i);
+			if (digits == i)
+				return false;
+			if (digits == s.size())
+				return s.size() - i >= 2;
+			size_t j = digits;
+			while (j < s.size() && isDigitChar(s[j]))
+				j++;
+			if (j == digits || j + 1 != s.size() || !isSpaceChar(s[j]))
+				return false;
+			match.set(2, s.substr(digits, j - digits));
+			return true;
+		}
+
+		// <opcode>\s+R\s*,\s*A\s*,\s*X\s*,\s*Y\s*$
+		bool matchInstruction(std::string_view s, size_t i, LineMatch &match)
+		{
+			size_t j = skipSpaces(s, i);
+			if (j == i)
+				return false;
+			for (int operand = 2; operand <= 5; operand++)
+			{
+				if (operand > 2)
+				{
+					j = skipSpaces(s, j);
+					if (j >= s.size() || s[j] != ',')
+						return false;
+					j = skipSpaces(s, j + 1);
+				}
+				const size_t start = j;
+				while (j < s.size() && isOperandChar(s[j]))
+					j++;
+				if (j == start)
+					return false;
+				match.set(operand, s.substr(start, j - start));
+			}
+			return onlySpaces(s, j);
+		}
 
-		std::smatch match;
+		// (name|copyright|created|engine|comment|guid)\s+"([^"]+)"
+		bool matchMetadata(std::string_view s, size_t i, LineMatch &match)
+		{
+			const size_t quote = skipSpaces(s, i);
+			if (quote == i || quote >= s.size() || s[quote] != '"')
+				return false;
+			const size_t close = s.find('"', quote + 1);
+			if (close == std::string_view::npos || close == quote + 1 || close + 1 != s.size())
+				return false;
+			match.set(2, s.substr(quote + 1, close - quote - 1));
+			return true;
+		}
+
+		// Gemeinsamer Einstieg: Zeilenart und Erfassungsgruppen
+		enum LineKind
+		{
+			LINE_INVALID = 0,
+			LINE_EMPTY,
+			LINE_DECLARATION,
+			LINE_TRAMSIZE,
+			LINE_INSTRUCTION,
+			LINE_METADATA,
+			LINE_END,
+			LINE_COMMENT
+		};
+
+		LineKind scanLine(std::string_view s, LineMatch &match)
+		{
+			const size_t start = skipSpaces(s, 0);
+			if (start == s.size())
+				return LINE_EMPTY;
+			// ;+\s*$
+			if (s[start] == ';')
+			{
+				size_t j = start;
+				while (j < s.size() && s[j] == ';')
+					j++;
+				return onlySpaces(s, j) ? LINE_COMMENT : LINE_INVALID;
+			}
+			// Schluesselwort bis zum ersten Leerzeichen
+			size_t end = start;
+			while (end < s.size() && !isSpaceChar(s[end]))
+				end++;
+			const std::string_view keyword = s.substr(start, end - start);
+			match.set(1, keyword);
+
+			if (isKeyword(keyword, {"static", "temp", "control", "input", "output", "const"}))
+			{
+				const size_t name = skipSpaces(s, end);
+				return (name > end && matchDeclaration(s, name, match)) ? LINE_DECLARATION : LINE_INVALID;
+			}
+			if (isKeyword(keyword, {"itramsize", "xtramsize"}))
+				return matchTramSize(s, end, match) ? LINE_TRAMSIZE : LINE_INVALID;
+			if (isKeyword(keyword, {"macs", "macsn", "macints", "macintw", "acc3", "macmv", "macw", "macwn", "skip", "andxor", "tstneg", "limit", "limitn", "log", "exp", "interp", "idelay", "xdelay"}))
+				return matchInstruction(s, end, match) ? LINE_INSTRUCTION : LINE_INVALID;
+			if (isKeyword(keyword, {"name", "copyright", "created", "engine", "comment", "guid"}))
+				return matchMetadata(s, end, match) ? LINE_METADATA : LINE_INVALID;
+			if (keyword == "end")
+				return onlySpaces(s, end) ? LINE_END : LINE_INVALID;
+			return LINE_INVALID;
+		}
+	}
+
+	// NOT CHECKED
+	// Syntaxchecker/Parser/Mapper
+	// NOTE: Implementation ist "Just Good Enough". Eine genauere Auswertung und mehr Fehlermeldungen sind wünschenswert.
+	bool FX8010::syntaxCheck(const std::string &input)
+	{
+		// Grammatik siehe scanLine(), ein Durchlauf ueber die Zeile
+		LineMatch match;
+		const LineKind kind = scanLine(input, match);
 
 		// Teste auf Deklarationen: static a | static b = 1.0 (vorerst keine Mehrfachdeklarationen!)
 		//------------------------------------------------------------------------------------------
-		if (std::regex_match(input, match, pattern1))
+		if (kind == LINE_DECLARATION)
 		{
 			if (DEBUG)
 				cout << "Deklaration gefunden" << endl;
@@ -418,9 +530,10 @@ namespace Klangraum
 
 				// Überprüfen, ob der String in der Map existiert
 				// NOTE: Im Grunde ist das ueberfluessig, weil Regex auf Types prueft
-				if (typeMap.find(registerTyp) != typeMap.end())
+				const auto type = typeMap.find(registerTyp);
+				if (type != typeMap.end())
 				{
-					reg.registerType = typeMap[registerTyp];
+					reg.registerType = type->second;
 				}
 				else
 				{
@@ -460,17 +573,31 @@ namespace Klangraum
 					}
 					else
 					{
-						reg.registerValue = stof(registerValue);
+						reg.initValue = stof(registerValue);
 					}
 				}
 				else
 				{
-					reg.registerValue = 0;
+					reg.initValue = 0;
+				}
+				if (match[4].matched)
+				{
+					if (registerTyp != "control")
+					{
+						error.errorDescription = errorMap[ERROR_SYNTAX_NOT_VALID];
+						error.errorRow = errorCounter;
+						errorList.push_back(error);
+						if (DEBUG)
+							cout << "Glaettung nur fuer control" << endl;
+						return false;
+					}
+					reg.smoothingType = (match[4] == "ramp") ? SMOOTHING_LINEAR : SMOOTHING_ONE_POLE;
+					reg.smoothingTime = stof(match[5]);
 				}
 				// Schiebe befülltes GPR nach Registers
 				registers.push_back(reg);
 				if (DEBUG)
-					cout << "GPR: " << reg.registerType << " | " << reg.registerName << " | " << reg.registerValue << " | " << reg.IOIndex << endl;
+					cout << "GPR: " << reg.registerType << " | " << reg.registerName << " | " << reg.initValue << " | " << reg.IOIndex << endl;
 			}
 			else
 			{
@@ -486,7 +613,7 @@ namespace Klangraum
 
 		// Teste auf Leerzeile
 		//------------------------------------------------------------------------------------------
-		else if (std::regex_match(input, pattern2))
+		else if (kind == LINE_EMPTY)
 		{
 			if (DEBUG)
 				cout << "Leerzeile oder Auskommentierung gefunden" << endl;
@@ -495,15 +622,17 @@ namespace Klangraum
 
 		// Teste auf Deklarationen: TRAM
 		//------------------------------------------------------------------------------------------
-		else if (std::regex_match(input, match, pattern3))
+		else if (kind == LINE_TRAMSIZE)
 		{
 			if (DEBUG)
 				cout << "Deklaration TRAMSize gefunden" << endl;
 			const std::string keyword = match[1];
 			const std::string tramSize = match[2];
+			// Groesse vor der Pruefung lesen, mehr als 9 Ziffern ist immer zu gross
+			const int size = tramSize.empty() ? 0 : ((tramSize.size() > 9) ? INT32_MAX : stoi(tramSize));
 			if (keyword == "itramsize")
 			{
-				if (iTRAMSize > MAX_IDELAY_SIZE)
+				if (size > MAX_IDELAY_SIZE)
 				{
 					if (DEBUG)
 						cout << "iTRAMSize zu gross (max. " << MAX_IDELAY_SIZE << ")" << endl;
@@ -515,14 +644,14 @@ namespace Klangraum
 				else
 				{
 					// Größe der Delayline anpassen
-					iTRAMSize = stoi(tramSize);
+					iTRAMSize = size;
 					if (DEBUG)
 						cout << "iTRAMSize: " << iTRAMSize << endl;
 				}
 			}
 			else if (keyword == "xtramsize")
 			{
-				if (xTRAMSize > MAX_XDELAY_SIZE)
+				if (size > MAX_XDELAY_SIZE)
 				{
 					if (DEBUG)
 						cout << "xTRAMSize zu gross (max. " << MAX_XDELAY_SIZE << ")" << endl;
@@ -534,7 +663,7 @@ namespace Klangraum
 				else
 				{
 					// Größe der Delayline anpassen
-					xTRAMSize = stoi(tramSize);
+					xTRAMSize = size;
 					if (DEBUG)
 						cout << "xTRAMSize: " << xTRAMSize << endl;
 				}
@@ -545,7 +674,7 @@ namespace Klangraum
 		// Teste auf Instruktionen
 		//------------------------------------------------------------------------------------------
 		// Wenn gültige Instruktion
-		else if (std::regex_match(input, match, pattern4))
+		else if (kind == LINE_INSTRUCTION)
 		{
 			if (DEBUG)
 				cout << "Instruktion gefunden" << endl;
@@ -566,8 +695,10 @@ namespace Klangraum
 
 			// Instructionname
 			//------------------------------------------------------------------------------------------
-			int instructionName = opcodeMap[keyword];
+			const auto opcode = opcodeMap.find(keyword);
+			int instructionName = (opcode != opcodeMap.end()) ? opcode->second : MACS;
 			instruction.opcode = instructionName;
+			instruction.row = errorCounter;
 
 			// GPR R
 			//------------------------------------------------------------------------------------------
@@ -696,7 +827,7 @@ namespace Klangraum
 
 		// Teste auf Metadaten
 		//------------------------------------------------------------------------------------------
-		else if (std::regex_match(input, match, pattern5))
+		else if (kind == LINE_METADATA)
 		{
 			// Extrahiere aus Regex-Erfassungsgruppen
 			const std::string key = match[1];
@@ -709,11 +840,13 @@ namespace Klangraum
 
 		// Teste auf END
 		//------------------------------------------------------------------------------------------
-		else if (std::regex_match(input, match, pattern6))
+		else if (kind == LINE_END)
 		{
 			if (DEBUG)
 				cout << "END gefunden" << endl;
-			instructions.push_back({END});
+			Instruction end = {END};
+			end.row = errorCounter;
+			instructions.push_back(end);
 			return true;
 		}
 
@@ -721,7 +854,7 @@ namespace Klangraum
 		// NOTE: Kommentare werden vorher entfernt und mit Leerzeile ersetzt, um Zeilennummern
 		// beizubehalten! (verbesserungswürdig)
 		//------------------------------------------------------------------------------------------
-		else if (std::regex_match(input, match, pattern7))
+		else if (kind == LINE_COMMENT)
 		{
 			// Kommt erst einmal nicht zum Einsatz. Code wird in loadFile() von Kommentaren bereinigt.
 			if (DEBUG)
@@ -754,8 +887,9 @@ namespace Klangraum
 			// Zahlen in Sourcecode Instructions sind immer STATIC
 			reg.registerType = STATIC;
 			reg.registerName = registerName;
-			reg.registerValue = stof(registerName);
-			// if (DEBUG) cout << reg.registerValue;
+			reg.initValue = stof(registerName);
+			reg.isLiteral = true;
+			// if (DEBUG) cout << reg.initValue;
 			registers.push_back(reg);
 			// Ermittle Index des neu angelegten Registers
 			return findRegisterIndexByName(registers, registerName);
@@ -773,112 +907,201 @@ namespace Klangraum
 		return -1;
 	}
 
+	// Registerwerte als dichtes Array anlegen (Struct of Arrays)
+	// Reihenfolge: alle beschreibbaren Register (CCR zuerst, Index 0), danach das Konstantensegment.
+	// Literale, die nie Ziel einer Instruktion sind, landen im Konstantensegment und werden nach
+	// Wert zusammengefasst (z.B. "0.5" und "0.50" belegen nur einen Platz).
+	void FX8010::layoutRegisters()
+	{
+		// Literale, die beschrieben werden (R bzw. Ziel eines Delay-Reads), brauchen einen eigenen Platz
+		std::vector<bool> isWritten(registers.size(), false);
+		for (const auto &instruction : instructions)
+		{
+			if (instruction.opcode == IDELAY || instruction.opcode == XDELAY)
+			{
+				if (registers[instruction.operand1].registerType == READ)
+					isWritten[instruction.operand2] = true;
+			}
+			else if (instruction.opcode != SKIP && instruction.opcode != END)
+				isWritten[instruction.operand1] = true;
+		}
+
+		registerValues.clear();
+		registerValues.reserve(registers.size());
+
+		// Beschreibbare Register
+		for (size_t i = 0; i < registers.size(); i++)
+		{
+			GPR &reg = registers[i];
+			if (reg.isLiteral && !isWritten[i])
+				continue;
+			reg.valueIndex = static_cast<int>(registerValues.size());
+			registerValues.push_back(reg.initValue);
+		}
+		constantSegmentStart = static_cast<int>(registerValues.size());
+
+		// Konstantensegment, Schluessel ist das Bitmuster (0.0 und -0.0 bleiben getrennt)
+		std::unordered_map<uint32_t, int> constantIndex;
+		for (size_t i = 0; i < registers.size(); i++)
+		{
+			GPR &reg = registers[i];
+			if (!reg.isLiteral || isWritten[i])
+				continue;
+			uint32_t bits;
+			memcpy(&bits, &reg.initValue, sizeof(bits));
+			auto it = constantIndex.find(bits);
+			if (it == constantIndex.end())
+			{
+				it = constantIndex.emplace(bits, static_cast<int>(registerValues.size())).first;
+				registerValues.push_back(reg.initValue);
+			}
+			reg.valueIndex = it->second;
+		}
+
+		if (DEBUG)
+			cout << "Registerwerte: " << constantSegmentStart << " GPR + " << registerValues.size() - constantSegmentStart
+				 << " Konstanten = " << registerValues.size() * sizeof(float) << " Bytes" << endl;
+	}
+
 	// CHECKED
 	bool FX8010::loadFile(const string &path)
 	{
-		ifstream file(path);  // Dateipfad zum Textfile (im Binary-Ordner)
-		string line;		  // einzelne Zeile
-		vector<string> lines; // mehrere Zeilen
+		ifstream file(path); // Dateipfad zum Textfile (im Binary-Ordner)
 		if (DEBUG)
 			cout << "Lade File: " << path << endl;
-		if (file)
+		if (!file)
 		{
 			if (DEBUG)
-				cout << "Parse Quellcode. NOTE: Kommentarzeilen werden durch Leerzeilen ersetzt." << endl;
-			if (DEBUG)
-				printLine(80);
-			while (getline(file, line)) // Zeile für Zeile einlesen
-			{
-				// Entferne den Kommentartext
-				std::string cleanedCode;
-				size_t commentPos = line.find(';');
-				if (commentPos != std::string::npos)
-				{
-					line = line.substr(0, commentPos);
-				}
+				cout << colorMap[COLOR_RED] << "Fehler beim Oeffnen der Datei." << colorMap[COLOR_NULL] << endl;
+			return false;
+		}
+		// Ganze Datei lesen, geparst wird im Speicher
+		const std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		return loadFromMemory(source.data(), source.size());
+	}
 
-				// Hänge die gereinigte Zeile an den bereinigten Code an
-				cleanedCode += line;
-				cleanedCode += '\n';
+	bool FX8010::loadFromString(const std::string &source)
+	{
+		return loadFromMemory(source.data(), source.size());
+	}
 
-				// In Kleinbuchstaben umwandeln
-				for (char &c : line)
-				{
-					c = std::tolower(c);
-				}
+	// CHECKED
+	// Zeilen wie getline() ('\n', eine letzte Zeile ohne Umbruch zaehlt mit), Kommentare ab ';'
+	// entfernen, in Kleinbuchstaben umwandeln und direkt pruefen (ein Durchlauf, kein Zeilenvektor)
+	bool FX8010::loadFromMemory(const char *data, size_t size)
+	{
+		if (DEBUG)
+			cout << "Parse Quellcode. NOTE: Kommentarzeilen werden durch Leerzeilen ersetzt." << endl;
+		if (DEBUG)
+			printLine(80);
 
-				// Zeile (String) in Vector schreiben
-				lines.push_back(line);
-			}
+		// Syntaxcheck/Parser/Mapper
+		//--------------------------------------------------------------------------------
+		std::string line;
+		int numLines = 0;
+		size_t position = 0;
+		while (position < size)
+		{
+			const char *begin = data + position;
+			const char *newline = static_cast<const char *>(memchr(begin, '\n', size - position));
+			const size_t length = (newline != nullptr) ? static_cast<size_t>(newline - begin) : size - position;
+			position += length + 1;
+			// CRLF: '\r' gehoert nicht zur Zeile
+			const size_t content = (length > 0 && begin[length - 1] == '\r') ? length - 1 : length;
 
-			// Syntaxcheck/Parser/Mapper
-			//--------------------------------------------------------------------------------
-			// TODO: Überprüfe jede mögliche Deklaration/Instruktion mit bestimmtem Regex-Muster.
-			// zusätzlich Range-Check, ...
+			// Entferne den Kommentartext
+			const char *comment = static_cast<const char *>(memchr(begin, ';', content));
+			line.assign(begin, (comment != nullptr) ? static_cast<size_t>(comment - begin) : content);
 
-			for (const string &line : lines)
-			{
-				if (DEBUG)
-					cout << "Zeile " << errorCounter << ": ";
-				syntaxCheck(line);
-				errorCounter++;
-			}
+			// In Kleinbuchstaben umwandeln
+			for (char &c : line)
+				c = std::tolower(c);
 
-			// Auf das letzte Vektor-Element zugreifen
-			// TODO: Sinnvoll?
-			string lastElement = lines.back();
-			// Wenn kein END Keyword gefunden wird
-			if (lastElement != "end")
-			{
-				error.errorDescription = errorMap[ERROR_NO_END_FOUND];
-				error.errorRow = errorCounter;
-				errorList.push_back(error);
-				if (DEBUG)
-					cout << "Kein 'END' gefunden" << endl;
-			}
+			if (DEBUG)
+				cout << "Zeile " << errorCounter << ": ";
+			syntaxCheck(line);
+			errorCounter++;
+			numLines++;
+		}
 
+		// Wenn kein END Keyword gefunden wird (letzte Zeile)
+		if (numLines == 0 || line != "end")
+		{
+			error.errorDescription = errorMap[ERROR_NO_END_FOUND];
+			error.errorRow = errorCounter;
+			errorList.push_back(error);
 			if (DEBUG)
-				printLine(80);
+				cout << "Kein 'END' gefunden" << endl;
+		}
 
-			// Wenn errorList > 1 (1. error ist ERROR_NONE)
-			int numErrors = static_cast<int>(errorList.size());
-			if (numErrors > 1)
-			{
-				if (DEBUG)
-					cout << colorMap[COLOR_RED] << "Syntaxfehler gefunden" << colorMap[COLOR_NULL] << endl; // Ausgabe Syntaxfehler mit Zeilennummer, beginnend mit 0
+		if (DEBUG)
+			printLine(80);
 
-				for (int i = 1; i < numErrors; i++)
-				{
-					if (DEBUG)
-						cout << errorList[i].errorDescription << " (" << errorList[i].errorRow << ")" << endl;
-				}
-				if (DEBUG)
-					printLine(80);
-				return false;
-			}
-			else
+		// Wenn errorList > 1 (1. error ist ERROR_NONE)
+		int numErrors = static_cast<int>(errorList.size());
+		if (numErrors > 1)
+		{
+			if (DEBUG)
+				cout << colorMap[COLOR_RED] << "Syntaxfehler gefunden" << colorMap[COLOR_NULL] << endl; // Ausgabe Syntaxfehler mit Zeilennummer, beginnend mit 0
+
+			for (int i = 1; i < numErrors; i++)
 			{
 				if (DEBUG)
-					cout << colorMap[COLOR_GREEN] << "Keine Syntaxfehler gefunden." << colorMap[COLOR_NULL] << endl;
-				if (DEBUG)
-					printLine(80);
-					isReady = true;
+					cout << errorList[i].errorDescription << " (" << errorList[i].errorRow << ")" << endl;
 			}
+			if (DEBUG)
+				printLine(80);
+			return false;
 		}
 		else
 		{
 			if (DEBUG)
-				cout << colorMap[COLOR_RED] << "Fehler beim Oeffnen der Datei." << colorMap[COLOR_NULL] << endl;
-			return false;
+				cout << colorMap[COLOR_GREEN] << "Keine Syntaxfehler gefunden." << colorMap[COLOR_NULL] << endl;
+			if (DEBUG)
+				printLine(80);
+			// Optimieren, Registerwerte anordnen, dann Befehlsstrom fuer den dekodierten Interpreter erzeugen
+			optimize();
+			layoutRegisters();
+			finishLoad();
 		}
 		return true;
 	}
 
+	void FX8010::finishLoad()
+	{
+		setupSmoothing();
+		layoutDelayLines();
+		decode();
+		isReady = true;
+		// JIT gewuenscht? Sonst Fallback auf den dekodierten Interpreter.
+		// Alter Maschinencode gehoert zum vorherigen Programm.
+		jitFunction = nullptr;
+		if (engineType == ENGINE_JIT && !compileJIT())
+			engineType = ENGINE_DECODED;
+		if (engineType == ENGINE_FIXED)
+			decodeFixed();
+	}
+
 	// CHECKED
 	// Um zu prüfen, ob ein GPR mit registerName="a" bereits im Vector registers vorhanden ist
 	// Wenn nicht gefunden gib -1 zurück, wenn ja gib den Index zurück.
 	int FX8010::findRegisterIndexByName(const std::vector<GPR> &registers, const std::string &name)
 	{
+		// Eigene Register ueber den Namensindex. Parser und Optimierer haengen nur an, neue Register
+		// werden hier nachgetragen. Bei gleichen Namen gilt wie bei der linearen Suche das erste.
+		if (&registers == &this->registers)
+		{
+			if (indexedRegisters > registers.size())
+			{
+				registerIndexByName.clear();
+				indexedRegisters = 0;
+			}
+			for (; indexedRegisters < registers.size(); indexedRegisters++)
+				registerIndexByName.emplace(registers[indexedRegisters].registerName, static_cast<int>(indexedRegisters));
+			const auto found = registerIndexByName.find(name);
+			return (found == registerIndexByName.end()) ? -1 : found->second;
+		}
+
 		for (int i = 0; i < registers.size(); ++i)
 		{
 			if (registers[i].registerName == name)
@@ -904,66 +1127,191 @@ namespace Klangraum
 	}
 
 	// CHECKED
-	// Implement a method to write a sample into each delay line. When writing a sample,
-	// you need to update the write position and wrap it around if it exceeds the buffer size.
-	inline void FX8010::writeSmallDelay(float sample, int position_)
+	// Implement a method to write a sample into each delay line.
+	// Die Position laeuft nicht mehr je Zugriff, sondern einmal je Samplezyklus weiter (endDelayBlock()).
+	inline void FX8010::writeSmallDelay(float sample, int position_, int tap)
 	{
-		// Range-Check
-		position_ = std::max(0, std::min(position_, iTRAMSize - 1));
-		// Schreibe Sample in Delayline
-		smallDelayBuffer[smallDelayWritePos + position_] = sample;
-		// Inkrementiere Schreibpointer (Ringpuffer)
-		smallDelayWritePos = (smallDelayWritePos + 1) % iTRAMSize;
+		const int frame = currentDelayFrame();
+		if (smallDelayBlockMode)
+			delayTaps[tap].block[frame] = sample;
+		else
+			smallDelayBuffer[(smallDelayPos + frame - position_) & smallDelayMask] = sample;
 	}
 
-	inline void FX8010::writeLargeDelay(float sample, int position_)
+	inline void FX8010::writeLargeDelay(float sample, int position_, int tap)
 	{
-		// Range-Check
-		position_ = std::max(0, std::min(position_, xTRAMSize - 1));
-		// Schreibe Sample in Delayline
-		largeDelayBuffer[largeDelayWritePos + position_] = sample;
-		// Inkrementiere Schreibpointer (Ringpuffer)
-		largeDelayWritePos = (largeDelayWritePos + 1) % xTRAMSize;
+		const int frame = currentDelayFrame();
+		if (largeDelayBlockMode)
+			delayTaps[tap].block[frame] = sample;
+		else
+			largeDelayBuffer[(largeDelayPos + frame - position_) & largeDelayMask] = sample;
 	}
 
 	// CHECKED
 	// Implement a method to read a sample from each delay line.
-	// To do linear Interpolation, you need to find the fractional part of the read position
-	// and interpolate between the two adjacent samples.
+	// Lese- und Schreibadresse beziehen sich auf dieselbe Position: gelesen wird das Sample,
+	// das (Leseadresse - Schreibadresse) Samplezyklen vorher geschrieben wurde.
+	inline float FX8010::readSmallDelay(int position_, int tap)
+	{
+		const int frame = currentDelayFrame();
+		if (smallDelayBlockMode)
+			return delayTaps[tap].block[frame];
+		return smallDelayBuffer[(smallDelayPos + frame - position_) & smallDelayMask];
+	}
+
+	inline float FX8010::readLargeDelay(int position_, int tap)
+	{
+		const int frame = currentDelayFrame();
+		if (largeDelayBlockMode)
+			return delayTaps[tap].block[frame];
+		return largeDelayBuffer[(largeDelayPos + frame - position_) & largeDelayMask];
+	}
+
+	// Delaylines nach dem Laden: Zweierpotenz-Ringpuffer und Taps fuer den Block-Modus
+	void FX8010::layoutDelayLines()
+	{
+		// Ringgroesse = naechste Zweierpotenz (MAX_IDELAY_SIZE/MAX_XDELAY_SIZE sind Zweierpotenzen)
+		auto ringMask = [](int size)
+		{
+			int ring = 1;
+			while (ring < size)
+				ring <<= 1;
+			return ring - 1;
+		};
+		smallDelayMask = ringMask(std::min(std::max(iTRAMSize, 1), MAX_IDELAY_SIZE));
+		largeDelayMask = ringMask(std::min(std::max(xTRAMSize, 1), MAX_XDELAY_SIZE));
+		smallDelayPos = 0;
+		largeDelayPos = 0;
+		delayFrame = 0;
+		// Genau die benoetigte Groesse, der alte Puffer wird freigegeben
+		std::vector<float, AlignedAllocator<float, 64>>(smallDelayMask + 1, 0.0f).swap(smallDelayBuffer);
+		std::vector<float, AlignedAllocator<float, 64>>(largeDelayMask + 1, 0.0f).swap(largeDelayBuffer);
+
+		// Vom Programm beschriebene Register (Adresse nicht konstant im Block)
+		std::vector<bool> isWritten(registers.size(), false);
+		for (const auto &instruction : instructions)
+		{
+			if (instruction.opcode == IDELAY || instruction.opcode == XDELAY)
+			{
+				if (registers[instruction.operand1].registerType == READ)
+					isWritten[instruction.operand2] = true;
+			}
+			else
+				isWritten[instruction.operand1] = true;
+		}
+
+		delayTaps.clear();
+		for (auto &instruction : instructions)
+		{
+			instruction.delayTap = -1;
+			if (instruction.opcode != IDELAY && instruction.opcode != XDELAY)
+				continue;
+			const int type = registers[instruction.operand1].registerType;
+			if (type != READ && type != WRITE)
+				continue;
+			const GPR &Y = registers[instruction.operand4];
+			DelayTap tap;
+			tap.isLarge = instruction.opcode == XDELAY;
+			tap.isWrite = type == WRITE;
+			tap.isConstant = !isWritten[instruction.operand4] && Y.registerType != INPUT && Y.registerName != "noise";
+			tap.address = &registerValues[Y.valueIndex];
+			instruction.delayTap = static_cast<int>(delayTaps.size());
+			delayTaps.push_back(tap);
+		}
+
+		delayTapBuffer.assign(delayTaps.size() * DELAY_BLOCK, 0.0f);
+		for (size_t t = 0; t < delayTaps.size(); t++)
+			delayTaps[t].block = delayTapBuffer.data() + t * DELAY_BLOCK;
+		smallDelayBlockMode = false;
+		largeDelayBlockMode = false;
+
+		if (DEBUG)
+			cout << "TRAM: iTRAM " << smallDelayMask + 1 << ", xTRAM " << largeDelayMask + 1 << " Samples (Zweierpotenz), " << delayTaps.size() << " Taps" << endl;
+	}
 
-	inline float FX8010::readSmallDelay(int position_)
+	// Block-Modus fuer eine Delayline pruefen und die Tap-Puffer fuellen
+	bool FX8010::beginDelayLine(bool isLarge, float *buffer, int mask, int position, int numFrames)
 	{
-		// Erläuterung zum Ringpuffer:
-		// Lesepointer läuft Schreibpointer hinterher!
-		// Grundzustand: Lesepointer zeigt auf letztes Element in der Delayline (Index: iTRAMSize - 1),
-		// Schreibpointer zeigt auf 1. Element. (Index: 0)
-		// Wenn Lesepointer (position_ > 0) müssen wir diesen zurückstellen im Gegensatz zu Schreibpointer,
-		// der vorgestellt werden muss, wenn wir spaeter Schreiben wollen! Normalerweise bleibt der dieser
-		// zu Beginn auf Index: 0.
-		// Beide Pointer werden beim Aufruf der Methoden inkrementiert mit Wraparound.
-
-		// Range-Check
-		// smallDelayReadPos wird mit (iTRAMSize-1) initialisiert, welches das letzte Element ist!
-		position_ = std::max(0, std::min(position_, iTRAMSize - 1));
-
-		// Lese Sample aus Delayline
-		// Mit (smallDelayReadPos - position_) stellen wir den Lesepointer zurück.
-		// NOTE: Modulo Operator sorgt für einen Wraparound.
-		float out = smallDelayBuffer[(smallDelayReadPos - position_) % iTRAMSize];
-		// Inkrementiere Lesepointer (Ringpuffer mit Wraparound)
-		smallDelayReadPos = (smallDelayReadPos + 1) % iTRAMSize;
-		return out;
+		if (numFrames > DELAY_BLOCK || numFrames > mask + 1)
+			return false;
+
+		bool hasTaps = false;
+		for (auto &tap : delayTaps)
+		{
+			if (tap.isLarge != isLarge)
+				continue;
+			if (!tap.isConstant)
+				return false;
+			tap.offset = static_cast<int>(*tap.address) & mask;
+			hasTaps = true;
+		}
+		if (!hasTaps)
+			return false;
+
+		// Kein Tap darf im Block lesen, was ein anderer im selben Block schreibt,
+		// zwei Schreibtaps duerfen sich im Block nicht ueberschneiden (ausser bei gleicher Adresse).
+		for (const auto &write : delayTaps)
+		{
+			if (write.isLarge != isLarge || !write.isWrite)
+				continue;
+			for (const auto &other : delayTaps)
+			{
+				if (other.isLarge != isLarge || &other == &write)
+					continue;
+				if (other.isWrite && other.offset == write.offset)
+					continue;
+				if (((other.offset - write.offset) & mask) < numFrames)
+					return false;
+			}
+		}
+
+		// Lesetaps: Werte des Blocks, Schreibtaps: alter Inhalt (SKIP kann Schreibzugriffe auslassen)
+		for (auto &tap : delayTaps)
+		{
+			if (tap.isLarge != isLarge)
+				continue;
+			const int start = (position - tap.offset) & mask;
+			const int first = std::min(numFrames, mask + 1 - start);
+			std::memcpy(tap.block, buffer + start, first * sizeof(float));
+			std::memcpy(tap.block + first, buffer, (numFrames - first) * sizeof(float));
+		}
+		return true;
 	}
 
-	inline float FX8010::readLargeDelay(int position_)
+	// Schreibtaps in Programmreihenfolge zurueck in den Ringpuffer
+	void FX8010::endDelayLine(bool isLarge, float *buffer, int mask, int position, int numFrames)
 	{
-		// Range-Check
-		position_ = std::max(0, std::min(position_, xTRAMSize - 1));
-		// Lese Sample aus Delayline
-		float out = largeDelayBuffer[(largeDelayReadPos - position_) % xTRAMSize];
-		// Inkrementiere Lesepointer (Ringpuffer)
-		largeDelayReadPos = (largeDelayReadPos + 1) % xTRAMSize;
-		return out;
+		for (const auto &tap : delayTaps)
+		{
+			if (tap.isLarge != isLarge || !tap.isWrite)
+				continue;
+			const int start = (position - tap.offset) & mask;
+			const int first = std::min(numFrames, mask + 1 - start);
+			std::memcpy(buffer + start, tap.block, first * sizeof(float));
+			std::memcpy(buffer, tap.block + first, (numFrames - first) * sizeof(float));
+		}
+	}
+
+	void FX8010::beginDelayBlock(int numFrames)
+	{
+		delayFrame = 0;
+		// Die Festkomma-Engine hat einen eigenen TRAM (int32)
+		const bool blockMode = engineType != ENGINE_FIXED && !delayTaps.empty();
+		smallDelayBlockMode = blockMode && beginDelayLine(false, smallDelayBuffer.data(), smallDelayMask, smallDelayPos, numFrames);
+		largeDelayBlockMode = blockMode && beginDelayLine(true, largeDelayBuffer.data(), largeDelayMask, largeDelayPos, numFrames);
+	}
+
+	void FX8010::endDelayBlock(int numFrames)
+	{
+		if (smallDelayBlockMode)
+			endDelayLine(false, smallDelayBuffer.data(), smallDelayMask, smallDelayPos, numFrames);
+		if (largeDelayBlockMode)
+			endDelayLine(true, largeDelayBuffer.data(), largeDelayMask, largeDelayPos, numFrames);
+		smallDelayBlockMode = false;
+		largeDelayBlockMode = false;
+		smallDelayPos = (smallDelayPos + numFrames) & smallDelayMask;
+		largeDelayPos = (largeDelayPos + numFrames) & largeDelayMask;
+		delayFrame = 0;
 	}
 
 	// Registerwerte ausgeben
@@ -988,6 +1336,54 @@ namespace Klangraum
 		return instructionCounter;
 	}
 
+	// CHECKED
+	// Speicherbedarf je Bereich. Vektoren mit capacity(), Maps/Strings geschaetzt.
+	FX8010::MemoryFootprint FX8010::getMemoryFootprint()
+	{
+		// Heap-Anteil eines Strings (kurze Strings liegen im Objekt)
+		auto stringBytes = [](const std::string &text)
+		{
+			return (text.capacity() > 15) ? text.capacity() + 1 : 0;
+		};
+		// std::map Knoten: Wert + Baumzeiger/Farbe
+		auto mapNodeBytes = [](size_t valueSize)
+		{
+			return valueSize + 4 * sizeof(void *);
+		};
+		auto vectorBytes = [](const auto &vector)
+		{
+			return vector.capacity() * sizeof(vector[0]);
+		};
+
+		MemoryFootprint footprint;
+		footprint.object = sizeof(FX8010);
+
+		footprint.registers = vectorBytes(registers) + vectorBytes(registerValues) + vectorBytes(fixedValues) + fixedIsInteger.capacity() / 8;
+		for (const auto &reg : registers)
+			footprint.registers += stringBytes(reg.registerName);
+
+		footprint.instructions = vectorBytes(instructions) + vectorBytes(decodedInstructions) + vectorBytes(fixedInstructions) + jitMemory.getSize();
+
+		for (const auto &pair : errorMap)
+			footprint.tables += mapNodeBytes(sizeof(pair)) + stringBytes(pair.second);
+		footprint.tables += metaMap.bucket_count() * sizeof(void *);
+		for (const auto &pair : metaMap)
+			footprint.tables += sizeof(pair) + 2 * sizeof(void *) + stringBytes(pair.first) + stringBytes(pair.second);
+		footprint.tables += vectorBytes(controlRegisters) + vectorBytes(errorList);
+		for (const auto &name : controlRegisters)
+			footprint.tables += stringBytes(name);
+
+		footprint.tram = vectorBytes(smallDelayBuffer) + vectorBytes(largeDelayBuffer) + vectorBytes(fixedSmallDelay) + vectorBytes(fixedLargeDelay) + vectorBytes(delayTaps) + vectorBytes(delayTapBuffer);
+
+		footprint.buffers = vectorBytes(outputBuffer) + vectorBytes(inputFrame) + vectorBytes(inputRegisters) + vectorBytes(outputRegisters) + vectorBytes(fixedInputs) + vectorBytes(fixedOutputs) + vectorBytes(jitFrameInputs) + vectorBytes(jitFrameOutputs) + vectorBytes(resamplerBuffer) + vectorBytes(resamplerCoreInputs) + vectorBytes(resamplerCoreOutputs) + vectorBytes(resamplerHostInputs) + vectorBytes(resamplerHostOutputs) + vectorBytes(eventInputs) + vectorBytes(eventOutputs) + eventQueue.getMemoryFootprint();
+		footprint.buffers += vectorBytes(smootherOf) + vectorBytes(smootherHandle) + vectorBytes(smootherType) + vectorBytes(smootherTime) + vectorBytes(smootherRemaining) + vectorBytes(smootherCurrent) + vectorBytes(smootherTarget) + vectorBytes(smootherIncrement) + vectorBytes(smootherCoefficient) + vectorBytes(smootherLinear);
+		if (hostSampleRate != SAMPLERATE)
+			footprint.buffers += inputResampler.getMemoryFootprint() + outputResampler.getMemoryFootprint();
+
+		footprint.total = footprint.object + footprint.registers + footprint.instructions + footprint.tables + footprint.tram + footprint.buffers;
+		return footprint;
+	}
+
 	// Fast White Noise
 	// Linear Feedback Shift Register (LFSR) als Pseudo-Zufallszahlengenerator
 	float FX8010::whitenoise()
@@ -995,7 +1391,8 @@ namespace Klangraum
 		float noise = 0.0f;
 		g_x1 ^= g_x2;
 		noise = g_x2 * g_fScale;
-		g_x2 += g_x1;
+		// Wraparound wie in der Festkomma-Engine, ohne Ueberlauf von int32_t
+		g_x2 = static_cast<int32_t>(static_cast<uint32_t>(g_x2) + static_cast<uint32_t>(g_x1));
 		return noise;
 	}
 
@@ -1019,9 +1416,182 @@ namespace Klangraum
         return static_cast<int32_t>(floatValue * static_cast<float>(INT32_MAX));
     }
 
-	// Main process loop
+	// Kompatibilitaets-Wrapper: 1 Sample (alle Kanaele) je Aufruf
+	// NOTE: Rueckgabe per Value kostet eine Vektorkopie je Sample. Besser processBlock() nutzen!
 	std::vector<float> FX8010::process(const std::vector<float> &inputBuffer)
+	{
+		// Ohne gueltiges Programm (nicht geladen oder Syntaxfehler) sind instructions evtl. nur
+		// teilweise geparst und registerValues nicht angelegt: Stille
+		if (!isReady)
+		{
+			std::fill(outputBuffer.begin(), outputBuffer.end(), 0.0f);
+			return outputBuffer;
+		}
+		beginDelayBlock(1);
+		processSample(inputBuffer.data());
+		endDelayBlock(1);
+		return outputBuffer;
+	}
 
+	// Blockverarbeitung mit planaren, vom Aufrufer verwalteten Buffern (inputs[Kanal][Sample])
+	// Keine Heap-Allokation, kein Kopieren von Vektoren je Sample.
+	void FX8010::processBlock(const float *const *inputs, float *const *outputs, int numFrames)
+	{
+		// Ohne gueltiges Programm Stille, wie process()
+		if (!isReady)
+		{
+			for (int c = 0; c < numChannels; c++)
+				std::fill(outputs[c], outputs[c] + numFrames, 0.0f);
+			std::fill(outputBuffer.begin(), outputBuffer.end(), 0.0f);
+			return;
+		}
+		const int64_t blockStart = sampleTime.load(std::memory_order_relaxed);
+		// Faellige Events anwenden, dann bis zum naechsten Event rechnen
+		int done = 0;
+		while (done < numFrames)
+		{
+			int end = numFrames;
+			while (const ParameterEvent *event = eventQueue.peek())
+			{
+				if (event->sampleTime > blockStart + done)
+				{
+					end = static_cast<int>(std::min<int64_t>(event->sampleTime - blockStart, numFrames));
+					break;
+				}
+				if (event->handle < constantSegmentStart)
+					setRegisterValue(event->handle, event->value);
+				eventQueue.pop();
+			}
+			// Laufende Controls alle SMOOTHING_STEP Samples einen Schritt weiter
+			if (numActiveSmoothers > 0)
+			{
+				if (smoothingCountdown <= 0)
+				{
+					advanceSmoothing();
+					smoothingCountdown = SMOOTHING_STEP;
+				}
+				end = std::min(end, done + smoothingCountdown);
+				smoothingCountdown -= end - done;
+			}
+			processSegment(inputs, outputs, done, end - done);
+			done = end;
+		}
+		sampleTime.store(blockStart + numFrames, std::memory_order_relaxed);
+	}
+
+	void FX8010::processSegment(const float *const *inputs, float *const *outputs, int offset, int numFrames)
+	{
+		if (offset > 0)
+		{
+			for (int c = 0; c < numChannels; c++)
+			{
+				eventInputs[c] = inputs[c] + offset;
+				eventOutputs[c] = outputs[c] + offset;
+			}
+			inputs = eventInputs.data();
+			outputs = eventOutputs.data();
+		}
+		if (hostSampleRate != SAMPLERATE)
+			processBlockResampled(inputs, outputs, numFrames);
+		else
+			processBlockCore(inputs, outputs, numFrames);
+	}
+
+	void FX8010::processBlockCore(const float *const *inputs, float *const *outputs, int numFrames)
+	{
+		// TRAM: Block-Modus waehlen, Positionen laufen am Blockende um numFrames weiter
+		beginDelayBlock(numFrames);
+
+		if (engineType == ENGINE_JIT)
+			processBlockJIT(inputs, outputs, numFrames);
+		else if (engineType == ENGINE_FIXED)
+			processBlockFixed(inputs, outputs, numFrames);
+		else
+		{
+			float *frame = inputFrame.data();
+			const float *outputFrame = outputBuffer.data();
+
+			for (int i = 0; i < numFrames; i++)
+			{
+				// Planare Eingaenge in einen Frame umsortieren
+				for (int j = 0; j < numChannels; j++)
+					frame[j] = inputs[j][i];
+
+				delayFrame = i;
+				processSample(frame);
+
+				// Frame in planare Ausgaenge schreiben
+				for (int j = 0; j < numChannels; j++)
+					outputs[j][i] = outputFrame[j];
+			}
+		}
+
+		endDelayBlock(numFrames);
+	}
+
+	// 1 Samplezyklus mit dem gewaehlten Interpreter
+	inline void FX8010::processSample(const float *inputFrame)
+	{
+		if (engineType == ENGINE_DECODED)
+			processSampleDecoded(inputFrame);
+		else if (engineType == ENGINE_JIT || engineType == ENGINE_FIXED)
+		{
+			// JIT und Festkomma arbeiten planar, 1 Frame ueber inputFrame/outputBuffer
+			if (inputFrame != this->inputFrame.data())
+				std::copy(inputFrame, inputFrame + numChannels, this->inputFrame.begin());
+			if (engineType == ENGINE_JIT)
+				processBlockJIT(jitFrameInputs.data(), jitFrameOutputs.data(), 1);
+			else
+				processBlockFixed(jitFrameInputs.data(), jitFrameOutputs.data(), 1);
+		}
+		else
+			processSampleSwitch(inputFrame);
+	}
+
+	// Ganzer Block im JIT-Code
+	void FX8010::processBlockJIT(const float *const *inputs, float *const *outputs, int numFrames)
+	{
+		// Kein Maschinencode (z.B. ENGINE_JIT gewaehlt, aber loadFile() fehlgeschlagen): Stille
+		if (jitFunction == nullptr)
+		{
+			for (int c = 0; c < numChannels; c++)
+				std::fill(outputs[c], outputs[c] + numFrames, 0.0f);
+			std::fill(outputBuffer.begin(), outputBuffer.end(), 0.0f);
+			return;
+		}
+		jitContext.inputs = inputs;
+		jitContext.outputs = outputs;
+		jitContext.instructionCount = 0;
+		jitFunction(&jitContext, numFrames);
+		jitContext.frameOffset = 0;
+		instructionCounter += static_cast<int>(jitContext.instructionCount);
+
+		// Outputbuffer wie beim dekodierten Interpreter nachfuehren
+		for (const auto &io : outputRegisters)
+			outputBuffer[io.IOIndex] = *io.value;
+	}
+
+	// CHECKED
+	// Interpreter waehlen. Der JIT wird bei Bedarf uebersetzt, vor loadFile() erst beim Laden.
+	bool FX8010::setEngineType(EngineType type)
+	{
+		// Festkomma-Engine hat eigene Register/TRAM, Zustand beim Umschalten uebernehmen
+		if (isReady && engineType == ENGINE_FIXED && type != ENGINE_FIXED)
+			syncFromFixed();
+		else if (isReady && engineType != ENGINE_FIXED && type == ENGINE_FIXED)
+			decodeFixed();
+		if (type == ENGINE_JIT && isReady && jitFunction == nullptr && !compileJIT())
+		{
+			// Fallback: dekodierter Interpreter
+			engineType = ENGINE_DECODED;
+			return false;
+		}
+		engineType = type;
+		return true;
+	}
+
+	// Main process loop (1 Samplezyklus), Referenz-Interpreter
+	inline void FX8010::processSampleSwitch(const float *inputFrame)
 	{
 		// End-Flag fuer einen Samplezyklus. Wird mit END im Sourcecode gesetzt.
 		bool isEND = false;
@@ -1043,31 +1613,37 @@ namespace Klangraum
 					int operand3Index = instruction.operand3;
 					int operand4Index = instruction.operand4;
 
-					// Zugriff auf die GPR und deren Daten
-					GPR &R = registers[operand1Index]; // read/write
-					GPR &A = registers[operand2Index]; // read/write
-					GPR &X = registers[operand3Index]; // read/write
-					GPR &Y = registers[operand4Index]; // read/write
+					// Zugriff auf die Metadaten der GPR (Typ, Name, IOIndex)
+					const GPR &gprR = registers[operand1Index];
+					const GPR &gprA = registers[operand2Index];
+					const GPR &gprX = registers[operand3Index];
+					const GPR &gprY = registers[operand4Index];
+
+					// Zugriff auf die Registerwerte
+					float &R = registerValues[gprR.valueIndex]; // read/write
+					float &A = registerValues[gprA.valueIndex]; // read/write
+					float &X = registerValues[gprX.valueIndex]; // read/write
+					float &Y = registerValues[gprY.valueIndex]; // read/write
 
 					// Hier werden nur Instruktionen mit entsprechendem Flag getestet, welches im Parser gesetzt wurde!
 					if (instruction.hasInput)
 					{
-						if (A.registerType == INPUT)
-							A.registerValue = inputBuffer[A.IOIndex];
-						if (X.registerType == INPUT)
-							X.registerValue = inputBuffer[A.IOIndex];
-						if (Y.registerType == INPUT)
-							Y.registerValue = inputBuffer[A.IOIndex];
+						if (gprA.registerType == INPUT)
+							A = inputFrame[gprA.IOIndex];
+						if (gprX.registerType == INPUT)
+							X = inputFrame[gprX.IOIndex];
+						if (gprY.registerType == INPUT)
+							Y = inputFrame[gprY.IOIndex];
 					}
 					// Hier genügt es, wenn ein Register NOISE sein kann. (deswegen else if)
 					if (instruction.hasNoise)
 					{
-						if (A.registerName == "noise")
-							A.registerValue = whitenoise();
-						else if (X.registerName == "noise")
-							X.registerValue = whitenoise();
-						else if (Y.registerName == "noise")
-							Y.registerValue = whitenoise();
+						if (gprA.registerName == "noise")
+							A = whitenoise();
+						else if (gprX.registerName == "noise")
+							X = whitenoise();
+						else if (gprY.registerName == "noise")
+							Y = whitenoise();
 					}
 
 					// Befehlsdecoder
@@ -1076,139 +1652,158 @@ namespace Klangraum
 					{
 					case MACS:
 						// R = A + X * Y
-						R.registerValue = A.registerValue + X.registerValue * Y.registerValue;
-						accumulator = R.registerValue; // Copy unsaturated value into accumulator
+						R = A + X * Y;
+						accumulator = R; // Copy unsaturated value into accumulator
 						// Saturation
-						R.registerValue = saturate(R.registerValue, 1.0f);
+						R = saturate(R, 1.0f);
 						// Set CCR register based on R
-						setCCR(R.registerValue);
+						setCCR(R);
 						break;
 					case MACSN:
 						// R = A - X * Y
-						R.registerValue = A.registerValue - X.registerValue * Y.registerValue;
-						accumulator = R.registerValue; // Copy unsaturated value into accumulator
+						R = A - X * Y;
+						accumulator = R; // Copy unsaturated value into accumulator
 						// Saturation
-						R.registerValue = saturate(R.registerValue, 1.0f);
+						R = saturate(R, 1.0f);
 						// Set CCR register based on R
-						setCCR(R.registerValue);
+						setCCR(R);
 						break;
 					case MACINTS:
 						// R = A + X * Y
-						R.registerValue = A.registerValue + X.registerValue * Y.registerValue;
-						accumulator = R.registerValue; // Copy unsaturated value into accumulator
+						R = A + X * Y;
+						accumulator = R; // Copy unsaturated value into accumulator
 						// Saturation
-						R.registerValue = saturate(R.registerValue, 1.0);
+						R = saturate(R, 1.0);
 						// Set CCR register based on R
-						setCCR(R.registerValue);
+						setCCR(R);
 						break;
 					case ACC3:
 						// R = A + X + Y
-						R.registerValue = A.registerValue + X.registerValue + Y.registerValue;
-						accumulator = R.registerValue; // Copy unsaturated value into accumulator
+						R = A + X + Y;
+						accumulator = R; // Copy unsaturated value into accumulator
 						// Saturation
-						R.registerValue = saturate(R.registerValue, 1.0);
+						R = saturate(R, 1.0);
 						// Set CCR register based on R
-						setCCR(R.registerValue);
+						setCCR(R);
 						break;
 					case LOG:
-						// TODO: Y = sign
-						R.registerValue = linearInterpolate(A.registerValue, lookupTablesLog[static_cast<int32_t>(X.registerValue)], -1.0, 1.0);
-						accumulator = R.registerValue;
+						// X = Exponentenbereich, Y = Vorzeichen (siehe FX8010LogExp.h)
+						R = logLinear(A, static_cast<int32_t>(X), static_cast<int32_t>(Y));
+						accumulator = R;
 						// Set CCR register based on R
-						setCCR(R.registerValue);
+						setCCR(R);
 						break;
 					case EXP:
-						R.registerValue = linearInterpolate(A.registerValue, lookupTablesExp[static_cast<int32_t>(X.registerValue)], -1.0, 1.0);
-						accumulator = R.registerValue;
+						R = expLinear(A, static_cast<int32_t>(X), static_cast<int32_t>(Y));
+						accumulator = R;
 						// Set CCR register based on R
-						setCCR(R.registerValue);
+						setCCR(R);
 						break;
 					case MACW:
-						R.registerValue = A.registerValue + wrapAround(X.registerValue * Y.registerValue); // TODO: Check
-						accumulator = R.registerValue;
+						R = A + wrapAround(X * Y); // TODO: Check
+						accumulator = R;
 						// Set CCR register based on R
-						setCCR(R.registerValue);
+						setCCR(R);
 						break;
 					case MACWN:
-						R.registerValue = A.registerValue - wrapAround(X.registerValue * Y.registerValue); // TODO: Check
-						accumulator = R.registerValue;
+						R = A - wrapAround(X * Y); // TODO: Check
+						accumulator = R;
 						// Set CCR register based on R
-						setCCR(R.registerValue);
+						setCCR(R);
 						break;
 					case MACINTW:
-						R.registerValue = wrapAround(A.registerValue + X.registerValue * Y.registerValue); // TODO: Check
-						accumulator = R.registerValue;
+						R = wrapAround(A + X * Y); // TODO: Check
+						accumulator = R;
 						// Set CCR register based on R
-						setCCR(R.registerValue);
+						setCCR(R);
 						break;
 					case MACMV:
-						accumulator = accumulator + (X.registerValue * Y.registerValue);
-						R.registerValue = A.registerValue;
+						accumulator = accumulator + (X * Y);
+						R = A;
 						// Set CCR register based on R
-						setCCR(R.registerValue);
+						setCCR(R);
 						break;
 					case ANDXOR:
-						R.registerValue = logicOps(A, X, Y);
+						R = logicOps(A, X, Y);
 						// Set CCR register based on R
-						setCCR(R.registerValue);
+						setCCR(R);
 						break;
 					case TSTNEG:
 						// TODO: Check
 						// Komplement ~ Funktioniert nur mit Integern, deswegen in einfache Binärdarstellung umwandeln
-						R.registerValue = A.registerValue >= Y.registerValue ? X.registerValue : intToFloat(~floatToInt(X.registerValue));
-						accumulator = R.registerValue;
+						R = A >= Y ? X : intToFloat(~floatToInt(X));
+						accumulator = R;
 						// Set CCR register based on R
-						setCCR(R.registerValue);
+						setCCR(R);
 						break;
 					case LIMIT:
-						R.registerValue = A.registerValue >= Y.registerValue ? X.registerValue : Y.registerValue;
-						accumulator = R.registerValue;
+						R = A >= Y ? X : Y;
+						accumulator = R;
 						// Set CCR register based on R
-						setCCR(R.registerValue);
+						setCCR(R);
 						break;
 					case LIMITN:
-						R.registerValue = A.registerValue < Y.registerValue ? X.registerValue : Y.registerValue;
-						accumulator = R.registerValue;
+						R = A < Y ? X : Y;
+						accumulator = R;
 						// Set CCR register based on R
-						setCCR(R.registerValue);
+						setCCR(R);
 						break;
 					case SKIP:
 						// Wenn X = CCR, dann überspringe Y Instructions.
-						if (static_cast<int32_t>(X.registerValue) == registers[0].registerValue)
-							numSkip = static_cast<int>(Y.registerValue);
+						if (static_cast<int32_t>(X) == registerValues[0])
+							numSkip = static_cast<int>(Y);
 						break;
 					case INTERP:
-						R.registerValue = (1.0 - X.registerValue) * A.registerValue + (X.registerValue * Y.registerValue);
-						accumulator = R.registerValue;
+						R = (1.0 - X) * A + (X * Y);
+						accumulator = R;
 						// Saturation
-						R.registerValue = saturate(R.registerValue, 1.0);
+						R = saturate(R, 1.0);
 						// Set CCR register based on R
-						setCCR(R.registerValue);
+						setCCR(R);
 						break;
 					case IDELAY:
 						// READ, A, AT, Y
-						if (R.registerType == READ)
+						if (gprR.registerType == READ)
 						{
-							A.registerValue = readSmallDelay(static_cast<int>(Y.registerValue)); // Y = Adresse, (Y-2048) mit 11 Bit Shift
+							A = readSmallDelay(static_cast<int>(Y), instruction.delayTap); // Y = Adresse, (Y-2048) mit 11 Bit Shift
 						}
 						// WRITE, A, AT, Y
-						else if (R.registerType == WRITE)
+						else if (gprR.registerType == WRITE)
 						{
-							writeSmallDelay(A.registerValue, static_cast<int>(Y.registerValue)); // A = value
+							writeSmallDelay(A, static_cast<int>(Y), instruction.delayTap); // A = value
 						}
 						break;
 					case XDELAY:
 						// READ, A, AT, Y
-						if (R.registerType == READ)
+						if (gprR.registerType == READ)
 						{
-							A.registerValue = readLargeDelay(static_cast<int>(Y.registerValue));
+							A = readLargeDelay(static_cast<int>(Y), instruction.delayTap);
 						}
 						// WRITE, A, AT, Y
-						else if (R.registerType == WRITE)
+						else if (gprR.registerType == WRITE)
 						{
-							writeLargeDelay(A.registerValue, static_cast<int>(Y.registerValue));
+							writeLargeDelay(A, static_cast<int>(Y), instruction.delayTap);
 						}
 						break;
+					case MOVS:
+						// Interne Opcodes des Optimierers, Akkumulator/Saturation/CCR wie MACS
+						R = A;
+						accumulator = R;
+						R = saturate(R, 1.0f);
+						setCCR(R);
+						break;
+					case ADDS:
+						R = A + X;
+						accumulator = R;
+						R = saturate(R, 1.0f);
+						setCCR(R);
+						break;
+					case MULS:
+						R = X * Y;
+						accumulator = R;
+						R = saturate(R, 1.0f);
+						setCCR(R);
+						break;
 					case END:
 						// End of sample cycle
 						isEND = true;
@@ -1223,14 +1818,7 @@ namespace Klangraum
 
 					// Anzeige der Registerwerte
 					if (PRINT_REGISTERS && !isEND)
-						printRegisters(opcode, R.registerValue, A.registerValue, X.registerValue, Y.registerValue, accumulator);
-
-					// wenn R = OUTPUT Typ
-					if (R.registerType == OUTPUT)
-					{
-						// Schreibe R in den Outputbuffer mit Index (für Mehrkanal)
-						outputBuffer[R.IOIndex] = R.registerValue;
-					}
+						printRegisters(opcode, R, A, X, Y, accumulator);
 				}
 				else
 				{
@@ -1244,8 +1832,543 @@ namespace Klangraum
 		// TODO: Reset aller TEMP GPR
 		// NOTE: Not really needed, performance issue
 
-		// Gib Vektor mit (Mehrkanal-)Sample(s) an VST zurück
-		return outputBuffer;
+		// OUTPUT Register in den Outputbuffer (für Mehrkanal), wie bei den anderen Engines am Ende
+		// des Samplezyklus. So landen auch Delay-Lesezugriffe (xdelay read, out_r, ...) im Ausgang.
+		for (const auto &io : outputRegisters)
+			outputBuffer[io.IOIndex] = *io.value;
+	}
+
+	// Dekodierter Interpreter (direct threaded)
+	//--------------------------------------------------------------------------------
+	// decode() uebersetzt die Instruktionen nach loadFile() einmalig in einen kompakten
+	// Strom aus Handler-Pointern mit bereits aufgeloesten Operanden-Pointern. Im Samplezyklus
+	// bleibt je Instruktion nur noch ein indirekter Sprung plus die eigentliche Arithmetik.
+	// Jeder Handler gibt die naechste auszufuehrende Instruktion zurueck (END: nullptr).
+
+	// Policies fuer den dekodierten Interpreter
+	// Sample:      Rechentyp der Arithmetik (die Register selbst bleiben float)
+	// Accumulator: Typ des Akkumulators
+	// TRACE:       Registerausgabe nach jeder Instruktion (PRINT_REGISTERS)
+	// CCR:         CCR nach jeder Instruktion setzen (nur noetig, wenn das Programm CCR liest)
+	template <typename SampleType, typename AccumulatorType, bool Trace, bool UseCCR>
+	struct EnginePolicy
+	{
+		typedef SampleType Sample;
+		typedef AccumulatorType Accumulator;
+		static const bool TRACE = Trace;
+		static const bool CCR = UseCCR;
+	};
+
+	template <bool Trace, bool UseCCR>
+	using ReferencePolicy = EnginePolicy<float, double, Trace, UseCCR>;
+	template <bool Trace, bool UseCCR>
+	using FastPolicy = EnginePolicy<float, float, Trace, UseCCR>;
+	template <bool Trace, bool UseCCR>
+	using AccuratePolicy = EnginePolicy<double, double, Trace, UseCCR>;
+
+	template <typename Policy>
+	struct FX8010::Ops
+	{
+		typedef FX8010::DecodedInstruction DI;
+		typedef typename Policy::Sample S;
+		typedef typename Policy::Accumulator Acc;
+
+		// wie saturate(x, 1.0)
+		static inline S saturate(const S x)
+		{
+			return (x >= S(1)) ? S(1) : ((x <= S(-1)) ? S(-1) : x);
+		}
+
+		// wie wrapAround(), das Borrow Flag wird von setCCR() ohnehin ueberschrieben
+		static inline S wrap(const S a)
+		{
+			return (a >= S(1)) ? a - S(2) : ((a < S(-1)) ? a + S(2) : a);
+		}
+
+		// Saturation entfaellt, wenn der Optimierer den Wertebereich [-1.0, 1.0] bewiesen hat
+		// (nur fuer float Arithmetik, mit double koennte das Zwischenergebnis knapp darueber liegen)
+		template <bool Saturate>
+		static inline S sat(const S x)
+		{
+			return (Saturate || !std::is_same<S, float>::value) ? saturate(x) : x;
+		}
+
+		// CCR nur, wenn das Programm CCR liest und das Ergebnis dieser Instruktion gelesen werden kann
+		template <bool WriteCCR>
+		static inline void setCCR(FX8010 &dsp, const float result)
+		{
+			if (Policy::CCR && WriteCCR)
+				dsp.setCCR(result);
+		}
+
+		template <bool WriteCCR, bool Saturate>
+		static const DI *macs(FX8010 &dsp, const DI *ip)
+		{
+			// R = A + X * Y
+			const S r = S(*ip->A) + S(*ip->X) * S(*ip->Y);
+			dsp.accumulator = Acc(r);
+			*ip->R = sat<Saturate>(r);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR, bool Saturate>
+		static const DI *macsn(FX8010 &dsp, const DI *ip)
+		{
+			// R = A - X * Y
+			const S r = S(*ip->A) - S(*ip->X) * S(*ip->Y);
+			dsp.accumulator = Acc(r);
+			*ip->R = sat<Saturate>(r);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR, bool Saturate>
+		static const DI *acc3(FX8010 &dsp, const DI *ip)
+		{
+			// R = A + X + Y
+			const S r = S(*ip->A) + S(*ip->X) + S(*ip->Y);
+			dsp.accumulator = Acc(r);
+			*ip->R = sat<Saturate>(r);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR, bool Saturate>
+		static const DI *log(FX8010 &dsp, const DI *ip)
+		{
+			*ip->R = logLinear(*ip->A, static_cast<int32_t>(*ip->X), static_cast<int32_t>(*ip->Y));
+			dsp.accumulator = Acc(*ip->R);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR, bool Saturate>
+		static const DI *exp(FX8010 &dsp, const DI *ip)
+		{
+			*ip->R = expLinear(*ip->A, static_cast<int32_t>(*ip->X), static_cast<int32_t>(*ip->Y));
+			dsp.accumulator = Acc(*ip->R);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR, bool Saturate>
+		static const DI *macw(FX8010 &dsp, const DI *ip)
+		{
+			*ip->R = S(*ip->A) + wrap(S(*ip->X) * S(*ip->Y));
+			dsp.accumulator = Acc(*ip->R);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR, bool Saturate>
+		static const DI *macwn(FX8010 &dsp, const DI *ip)
+		{
+			*ip->R = S(*ip->A) - wrap(S(*ip->X) * S(*ip->Y));
+			dsp.accumulator = Acc(*ip->R);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR, bool Saturate>
+		static const DI *macintw(FX8010 &dsp, const DI *ip)
+		{
+			*ip->R = wrap(S(*ip->A) + S(*ip->X) * S(*ip->Y));
+			dsp.accumulator = Acc(*ip->R);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR, bool Saturate>
+		static const DI *macmv(FX8010 &dsp, const DI *ip)
+		{
+			dsp.accumulator = Acc(dsp.accumulator) + Acc(S(*ip->X) * S(*ip->Y));
+			*ip->R = *ip->A;
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR, bool Saturate>
+		static const DI *andxor(FX8010 &dsp, const DI *ip)
+		{
+			*ip->R = dsp.logicOps(*ip->A, *ip->X, *ip->Y);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR, bool Saturate>
+		static const DI *tstneg(FX8010 &dsp, const DI *ip)
+		{
+			*ip->R = *ip->A >= *ip->Y ? *ip->X : dsp.intToFloat(~dsp.floatToInt(*ip->X));
+			dsp.accumulator = Acc(*ip->R);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR, bool Saturate>
+		static const DI *limit(FX8010 &dsp, const DI *ip)
+		{
+			*ip->R = *ip->A >= *ip->Y ? *ip->X : *ip->Y;
+			dsp.accumulator = Acc(*ip->R);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR, bool Saturate>
+		static const DI *limitn(FX8010 &dsp, const DI *ip)
+		{
+			*ip->R = *ip->A < *ip->Y ? *ip->X : *ip->Y;
+			dsp.accumulator = Acc(*ip->R);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		static const DI *skip(FX8010 &dsp, const DI *ip)
+		{
+			// Wenn X = CCR, dann ueberspringe Y Instructions.
+			if (static_cast<int32_t>(*ip->X) == dsp.registerValues[0])
+			{
+				int numSkip = static_cast<int>(*ip->Y);
+				// Wie im Referenz-Interpreter: ein negativer Zaehler ueberspringt genau 1 Instruktion
+				if (numSkip < 0)
+					numSkip = 1;
+				const DI *first = dsp.decodedInstructions.data();
+				const int numInstructions = static_cast<int>(dsp.decodedInstructions.size());
+				// Sprung ueber END hinaus setzt (wie die do-while-Schleife) am Programmanfang fort
+				return first + (static_cast<int>(ip - first) + 1 + numSkip) % numInstructions;
+			}
+			return ip + 1;
+		}
+
+		template <bool WriteCCR, bool Saturate>
+		static const DI *interp(FX8010 &dsp, const DI *ip)
+		{
+			// Referenz rechnet hier in double (1.0 - X), Fast bleibt in float
+			typedef typename std::conditional<std::is_same<Acc, double>::value, double, S>::type T;
+			const S r = S((T(1) - T(*ip->X)) * T(*ip->A) + (S(*ip->X) * S(*ip->Y)));
+			dsp.accumulator = Acc(r);
+			*ip->R = sat<Saturate>(r);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		// Interne Opcodes des Optimierers
+		template <bool WriteCCR, bool Saturate>
+		static const DI *movs(FX8010 &dsp, const DI *ip)
+		{
+			// R = A
+			const S r = S(*ip->A);
+			dsp.accumulator = Acc(r);
+			*ip->R = sat<Saturate>(r);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR, bool Saturate>
+		static const DI *adds(FX8010 &dsp, const DI *ip)
+		{
+			// R = A + X
+			const S r = S(*ip->A) + S(*ip->X);
+			dsp.accumulator = Acc(r);
+			*ip->R = sat<Saturate>(r);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR, bool Saturate>
+		static const DI *muls(FX8010 &dsp, const DI *ip)
+		{
+			// R = X * Y
+			const S r = S(*ip->X) * S(*ip->Y);
+			dsp.accumulator = Acc(r);
+			*ip->R = sat<Saturate>(r);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		static const DI *idelayRead(FX8010 &dsp, const DI *ip)
+		{
+			*ip->A = dsp.readSmallDelay(static_cast<int>(*ip->Y), ip->delayTap);
+			return ip + 1;
+		}
+
+		static const DI *idelayWrite(FX8010 &dsp, const DI *ip)
+		{
+			dsp.writeSmallDelay(*ip->A, static_cast<int>(*ip->Y), ip->delayTap);
+			return ip + 1;
+		}
+
+		static const DI *xdelayRead(FX8010 &dsp, const DI *ip)
+		{
+			*ip->A = dsp.readLargeDelay(static_cast<int>(*ip->Y), ip->delayTap);
+			return ip + 1;
+		}
+
+		static const DI *xdelayWrite(FX8010 &dsp, const DI *ip)
+		{
+			dsp.writeLargeDelay(*ip->A, static_cast<int>(*ip->Y), ip->delayTap);
+			return ip + 1;
+		}
+
+		static const DI *nop(FX8010 &, const DI *ip)
+		{
+			return ip + 1;
+		}
+
+		static const DI *end(FX8010 &, const DI *)
+		{
+			return nullptr;
+		}
+
+		// Vorstufe fuer Instruktionen mit NOISE Operand: neuer Zufallswert, dann die eigentliche Operation
+		static const DI *noise(FX8010 &dsp, const DI *ip)
+		{
+			*ip->N = dsp.whitenoise();
+			return ip->exec(dsp, ip);
+		}
+
+		// Registerausgabe nach der Operation (nur in TRACE Instanzen)
+		template <Handler H>
+		static const DI *traced(FX8010 &dsp, const DI *ip)
+		{
+			const DI *next = H(dsp, ip);
+			dsp.printRegisters(ip->opcode, *ip->R, *ip->A, *ip->X, *ip->Y, dsp.accumulator);
+			return next;
+		}
+
+		template <Handler H>
+		static constexpr Handler handler()
+		{
+			return Policy::TRACE ? traced<H> : H;
+		}
+
+		static HandlerTable table()
+		{
+			// NOISE ruft exec auf, das Tracing steckt dann schon in der Operation
+			HandlerTable t;
+			// Varianten [writesCCR][saturates] je arithmetischem Opcode
+#define FX8010_VARIANTS(name)                        \
+	t.name[0][0] = handler<name<false, false>>();    \
+	t.name[0][1] = handler<name<false, true>>();     \
+	t.name[1][0] = handler<name<true, false>>();     \
+	t.name[1][1] = handler<name<true, true>>();
+			FX8010_VARIANTS(macs)
+			FX8010_VARIANTS(macsn)
+			FX8010_VARIANTS(acc3)
+			FX8010_VARIANTS(log)
+			FX8010_VARIANTS(exp)
+			FX8010_VARIANTS(macw)
+			FX8010_VARIANTS(macwn)
+			FX8010_VARIANTS(macintw)
+			FX8010_VARIANTS(macmv)
+			FX8010_VARIANTS(andxor)
+			FX8010_VARIANTS(tstneg)
+			FX8010_VARIANTS(limit)
+			FX8010_VARIANTS(limitn)
+			FX8010_VARIANTS(interp)
+			FX8010_VARIANTS(movs)
+			FX8010_VARIANTS(adds)
+			FX8010_VARIANTS(muls)
+#undef FX8010_VARIANTS
+			t.skip = handler<skip>();
+			t.idelayRead = handler<idelayRead>();
+			t.idelayWrite = handler<idelayWrite>();
+			t.xdelayRead = handler<xdelayRead>();
+			t.xdelayWrite = handler<xdelayWrite>();
+			t.nop = handler<nop>();
+			t.end = end;
+			t.noise = noise;
+			return t;
+		}
+	};
+
+	// CHECKED
+	bool FX8010::programReadsCCR()
+	{
+		for (const auto &instruction : instructions)
+		{
+			if (instruction.opcode == SKIP)
+				return true;
+			// END hat keine Operanden
+			if (instruction.opcode != END && (instruction.operand2 == 0 || instruction.operand3 == 0 || instruction.operand4 == 0))
+				return true;
+		}
+		return false;
+	}
+
+	// Factory: Policy-Instanz passend zu Genauigkeit, Programm (CCR gelesen?) und Build (PRINT_REGISTERS)
+	FX8010::HandlerTable FX8010::selectHandlers()
+	{
+		const bool ccr = programReadsCCR();
+		const bool trace = PRINT_REGISTERS;
+
+		switch (precision)
+		{
+		case PRECISION_FAST:
+			if (trace)
+				return Ops<FastPolicy<PRINT_REGISTERS, true>>::table();
+			return ccr ? Ops<FastPolicy<false, true>>::table() : Ops<FastPolicy<false, false>>::table();
+		case PRECISION_ACCURATE:
+			if (trace)
+				return Ops<AccuratePolicy<PRINT_REGISTERS, true>>::table();
+			return ccr ? Ops<AccuratePolicy<false, true>>::table() : Ops<AccuratePolicy<false, false>>::table();
+		default:
+			if (trace)
+				return Ops<ReferencePolicy<PRINT_REGISTERS, true>>::table();
+			return ccr ? Ops<ReferencePolicy<false, true>>::table() : Ops<ReferencePolicy<false, false>>::table();
+		}
+	}
+
+	// CHECKED
+	void FX8010::setPrecision(Precision precision_)
+	{
+		precision = precision_;
+		if (!isReady)
+			return;
+		decode();
+		// JIT Code ruft die alten Handler auf und rechnet nur mit Referenz-Genauigkeit
+		jitFunction = nullptr;
+		if (engineType == ENGINE_JIT && !compileJIT())
+			engineType = ENGINE_DECODED;
+	}
+
+	// CHECKED
+	// Uebersetzt instructions in decodedInstructions (einmalig nach dem Laden)
+	void FX8010::decode()
+	{
+		const HandlerTable ops = selectHandlers();
+
+		decodedInstructions.clear();
+		decodedInstructions.reserve(instructions.size());
+		inputRegisters.clear();
+		outputRegisters.clear();
+
+		// I/O Register werden je Samplezyklus einmal gesetzt bzw. ausgelesen
+		for (auto &reg : registers)
+		{
+			if (reg.registerType == INPUT)
+				inputRegisters.push_back({&registerValues[reg.valueIndex], reg.IOIndex, static_cast<int>(&reg - registers.data())});
+			else if (reg.registerType == OUTPUT)
+				outputRegisters.push_back({&registerValues[reg.valueIndex], reg.IOIndex, static_cast<int>(&reg - registers.data())});
+		}
+
+		for (size_t i = 0; i < instructions.size(); i++)
+		{
+			const Instruction &instruction = instructions[i];
+			DecodedInstruction decoded;
+			decoded.opcode = instruction.opcode;
+			decoded.delayTap = instruction.delayTap;
+			const GPR &R = registers[instruction.operand1];
+			const GPR &A = registers[instruction.operand2];
+			const GPR &X = registers[instruction.operand3];
+			const GPR &Y = registers[instruction.operand4];
+			decoded.R = &registerValues[R.valueIndex];
+			decoded.A = &registerValues[A.valueIndex];
+			decoded.X = &registerValues[X.valueIndex];
+			decoded.Y = &registerValues[Y.valueIndex];
+
+			switch (instruction.opcode)
+			{
+			case MACS:
+			case MACINTS:
+				decoded.exec = ops.macs[instruction.writesCCR][instruction.saturates];
+				break;
+			case MACSN:
+				decoded.exec = ops.macsn[instruction.writesCCR][instruction.saturates];
+				break;
+			case ACC3:
+				decoded.exec = ops.acc3[instruction.writesCCR][instruction.saturates];
+				break;
+			case LOG:
+				decoded.exec = ops.log[instruction.writesCCR][instruction.saturates];
+				break;
+			case EXP:
+				decoded.exec = ops.exp[instruction.writesCCR][instruction.saturates];
+				break;
+			case MACW:
+				decoded.exec = ops.macw[instruction.writesCCR][instruction.saturates];
+				break;
+			case MACWN:
+				decoded.exec = ops.macwn[instruction.writesCCR][instruction.saturates];
+				break;
+			case MACINTW:
+				decoded.exec = ops.macintw[instruction.writesCCR][instruction.saturates];
+				break;
+			case MACMV:
+				decoded.exec = ops.macmv[instruction.writesCCR][instruction.saturates];
+				break;
+			case ANDXOR:
+				decoded.exec = ops.andxor[instruction.writesCCR][instruction.saturates];
+				break;
+			case TSTNEG:
+				decoded.exec = ops.tstneg[instruction.writesCCR][instruction.saturates];
+				break;
+			case LIMIT:
+				decoded.exec = ops.limit[instruction.writesCCR][instruction.saturates];
+				break;
+			case LIMITN:
+				decoded.exec = ops.limitn[instruction.writesCCR][instruction.saturates];
+				break;
+			case SKIP:
+				decoded.exec = ops.skip;
+				break;
+			case INTERP:
+				decoded.exec = ops.interp[instruction.writesCCR][instruction.saturates];
+				break;
+			case IDELAY:
+				decoded.exec = (R.registerType == READ) ? ops.idelayRead : (R.registerType == WRITE) ? ops.idelayWrite : ops.nop;
+				break;
+			case XDELAY:
+				decoded.exec = (R.registerType == READ) ? ops.xdelayRead : (R.registerType == WRITE) ? ops.xdelayWrite : ops.nop;
+				break;
+			case MOVS:
+				decoded.exec = ops.movs[instruction.writesCCR][instruction.saturates];
+				break;
+			case ADDS:
+				decoded.exec = ops.adds[instruction.writesCCR][instruction.saturates];
+				break;
+			case MULS:
+				decoded.exec = ops.muls[instruction.writesCCR][instruction.saturates];
+				break;
+			case END:
+				// Wie im Referenz-Interpreter beendet nur das END am Programmende den Samplezyklus
+				decoded.exec = (i + 1 == instructions.size()) ? ops.end : ops.nop;
+				break;
+			default:
+				decoded.exec = ops.nop;
+				break;
+			}
+
+			// Wie im Referenz-Interpreter wird nur der erste NOISE Operand neu belegt
+			decoded.handler = decoded.exec;
+			if (instruction.hasNoise)
+			{
+				decoded.N = (A.registerName == "noise") ? decoded.A : (X.registerName == "noise") ? decoded.X : decoded.Y;
+				decoded.handler = ops.noise;
+			}
+
+			decodedInstructions.push_back(decoded);
+		}
+	}
+
+	// Main process loop (1 Samplezyklus), dekodierter Interpreter
+	inline void FX8010::processSampleDecoded(const float *inputFrame)
+	{
+		// Eingaenge einmal je Samplezyklus in die INPUT Register uebernehmen
+		for (const auto &io : inputRegisters)
+			*io.value = inputFrame[io.IOIndex];
+
+		// Dispatch-Loop: je Instruktion ein indirekter Sprung
+		const DecodedInstruction *ip = decodedInstructions.empty() ? nullptr : decodedInstructions.data();
+		while (ip != nullptr)
+		{
+			ip = ip->handler(*this, ip);
+			instructionCounter++;
+		}
+
+		// OUTPUT Register in den Outputbuffer (für Mehrkanal)
+		for (const auto &io : outputRegisters)
+			outputBuffer[io.IOIndex] = *io.value;
 	}
 
 } // namespace Klangraum
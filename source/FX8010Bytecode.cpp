@@ -0,0 +1,435 @@
+// Copyright 2023 Klangraum
+// Bytecode lesen/schreiben (Format: include/FX8010Bytecode.h)
+// Beim Laden wird jeder Wert geprueft (Indizes, Groessen, Strings), eine defekte oder fremde Datei
+// liefert false und einen Eintrag in getErrorList(), nie einen Zugriff ausserhalb der Daten.
+
+#include "../include/FX8010.h"
+#include "../include/helpers.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Klangraum
+{
+	namespace
+	{
+		inline size_t alignSection(const size_t offset)
+		{
+			return (offset + BYTECODE_ALIGNMENT - 1) & ~static_cast<size_t>(BYTECODE_ALIGNMENT - 1);
+		}
+
+		// Abschnitt liegt ausgerichtet und vollstaendig in der Datei
+		inline bool isValidSection(const BytecodeSection &section, const size_t elementSize, const uint32_t fileSize)
+		{
+			return section.offset % BYTECODE_ALIGNMENT == 0 && static_cast<uint64_t>(section.offset) + static_cast<uint64_t>(section.count) * elementSize <= fileSize;
+		}
+
+		// Element i eines Abschnitts (memcpy, die Daten muessen nicht ausgerichtet sein)
+		template <typename T>
+		inline T readElement(const uint8_t *data, const BytecodeSection &section, const size_t i)
+		{
+			T element;
+			memcpy(&element, data + section.offset + i * sizeof(T), sizeof(T));
+			return element;
+		}
+	}
+
+	// BytecodeFile
+	//--------------------------------------------------------------------------------
+
+	bool BytecodeFile::open(const std::string &path)
+	{
+		close();
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		const void *view = (mapping != nullptr) ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (view == nullptr)
+		{
+			if (mapping != nullptr)
+				CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+		fileHandle = file;
+		mappingHandle = mapping;
+		memory = view;
+		size = static_cast<size_t>(fileSize.QuadPart);
+#else
+		const int file = ::open(path.c_str(), O_RDONLY);
+		if (file < 0)
+			return false;
+		struct stat status;
+		if (fstat(file, &status) != 0 || status.st_size <= 0)
+		{
+			::close(file);
+			return false;
+		}
+		void *view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		// Die Abbildung bleibt auch ohne Dateideskriptor gueltig
+		::close(file);
+		if (view == MAP_FAILED)
+			return false;
+		memory = view;
+		size = static_cast<size_t>(status.st_size);
+#endif
+		return true;
+	}
+
+	void BytecodeFile::close()
+	{
+		if (memory == nullptr)
+			return;
+#ifdef _WIN32
+		UnmapViewOfFile(memory);
+		CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+		mappingHandle = nullptr;
+		fileHandle = nullptr;
+#else
+		munmap(const_cast<void *>(memory), size);
+#endif
+		memory = nullptr;
+		size = 0;
+	}
+
+	// FX8010
+	//--------------------------------------------------------------------------------
+
+	// CHECKED
+	std::vector<uint8_t> FX8010::getBytecode()
+	{
+		std::vector<uint8_t> bytecode;
+		if (!isReady)
+			return bytecode;
+
+		std::string strings;
+		auto addString = [&strings](const std::string &text)
+		{
+			BytecodeString string = {static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(text.size())};
+			strings += text;
+			return string;
+		};
+
+		BytecodeHeader header = {};
+		memcpy(header.magic, BYTECODE_MAGIC, sizeof(header.magic));
+		header.version = BYTECODE_VERSION;
+		header.byteOrder = BYTECODE_BYTE_ORDER;
+		header.constantSegmentStart = constantSegmentStart;
+		header.iTRAMSize = iTRAMSize;
+		header.xTRAMSize = xTRAMSize;
+		header.maxIOIndex = -1;
+		header.optimizerEnabled = optimizerReport.enabled ? 1 : 0;
+		header.instructionsBefore = optimizerReport.instructionsBefore;
+		header.instructionsAfter = optimizerReport.instructionsAfter;
+		header.foldedConstants = optimizerReport.foldedConstants;
+		header.propagatedCopies = optimizerReport.propagatedCopies;
+		header.reducedInstructions = optimizerReport.reducedInstructions;
+		header.removedDeadWrites = optimizerReport.removedDeadWrites;
+		header.elidedCCR = optimizerReport.elidedCCR;
+		header.elidedSaturation = optimizerReport.elidedSaturation;
+
+		// Startwerte aus den Deklarationen, nicht der aktuelle Zustand
+		std::vector<float> values(registerValues.size(), 0.0f);
+		std::vector<BytecodeRegister> bytecodeRegisters;
+		bytecodeRegisters.reserve(registers.size());
+		for (const auto &reg : registers)
+		{
+			BytecodeRegister entry = {};
+			entry.registerType = reg.registerType;
+			entry.name = addString(reg.registerName);
+			entry.initValue = reg.initValue;
+			entry.IOIndex = reg.IOIndex;
+			entry.valueIndex = reg.valueIndex;
+			entry.smoothingType = reg.smoothingType;
+			entry.smoothingTime = reg.smoothingTime;
+			entry.isBorrow = reg.isBorrow ? 1 : 0;
+			entry.isLiteral = reg.isLiteral ? 1 : 0;
+			bytecodeRegisters.push_back(entry);
+			values[reg.valueIndex] = reg.initValue;
+			if (reg.registerType == INPUT || reg.registerType == OUTPUT)
+				header.maxIOIndex = std::max(header.maxIOIndex, static_cast<int32_t>(reg.IOIndex));
+		}
+
+		std::vector<BytecodeInstruction> bytecodeInstructions;
+		bytecodeInstructions.reserve(instructions.size());
+		for (const auto &instruction : instructions)
+		{
+			BytecodeInstruction entry = {};
+			entry.opcode = instruction.opcode;
+			entry.operand1 = instruction.operand1;
+			entry.operand2 = instruction.operand2;
+			entry.operand3 = instruction.operand3;
+			entry.operand4 = instruction.operand4;
+			entry.row = instruction.row;
+			entry.hasInput = instruction.hasInput ? 1 : 0;
+			entry.hasOutput = instruction.hasOutput ? 1 : 0;
+			entry.hasNoise = instruction.hasNoise ? 1 : 0;
+			entry.writesCCR = instruction.writesCCR ? 1 : 0;
+			entry.saturates = instruction.saturates ? 1 : 0;
+			bytecodeInstructions.push_back(entry);
+		}
+
+		std::vector<BytecodeString> controls;
+		for (const auto &name : controlRegisters)
+			controls.push_back(addString(name));
+
+		std::vector<BytecodeMetaEntry> meta;
+		for (const auto &pair : metaMap)
+		{
+			BytecodeMetaEntry entry;
+			entry.key = addString(pair.first);
+			entry.value = addString(pair.second);
+			meta.push_back(entry);
+		}
+
+		// Abschnitte hintereinander, jeder ausgerichtet
+		size_t offset = sizeof(BytecodeHeader);
+		auto place = [&offset](BytecodeSection &section, size_t count, size_t elementSize)
+		{
+			offset = alignSection(offset);
+			section.offset = static_cast<uint32_t>(offset);
+			section.count = static_cast<uint32_t>(count);
+			offset += count * elementSize;
+		};
+		place(header.registers, bytecodeRegisters.size(), sizeof(BytecodeRegister));
+		place(header.values, values.size(), sizeof(float));
+		place(header.instructions, bytecodeInstructions.size(), sizeof(BytecodeInstruction));
+		place(header.controls, controls.size(), sizeof(BytecodeString));
+		place(header.meta, meta.size(), sizeof(BytecodeMetaEntry));
+		place(header.strings, strings.size(), 1);
+		header.fileSize = static_cast<uint32_t>(offset);
+
+		bytecode.assign(offset, 0);
+		auto copy = [&bytecode](const BytecodeSection &section, const void *source, size_t elementSize)
+		{
+			if (section.count > 0)
+				memcpy(bytecode.data() + section.offset, source, section.count * elementSize);
+		};
+		memcpy(bytecode.data(), &header, sizeof(header));
+		copy(header.registers, bytecodeRegisters.data(), sizeof(BytecodeRegister));
+		copy(header.values, values.data(), sizeof(float));
+		copy(header.instructions, bytecodeInstructions.data(), sizeof(BytecodeInstruction));
+		copy(header.controls, controls.data(), sizeof(BytecodeString));
+		copy(header.meta, meta.data(), sizeof(BytecodeMetaEntry));
+		copy(header.strings, strings.data(), 1);
+		return bytecode;
+	}
+
+	bool FX8010::saveBytecode(const std::string &path)
+	{
+		const std::vector<uint8_t> bytecode = getBytecode();
+		if (bytecode.empty())
+			return false;
+		ofstream file(path, std::ios::binary);
+		file.write(reinterpret_cast<const char *>(bytecode.data()), static_cast<std::streamsize>(bytecode.size()));
+		return static_cast<bool>(file);
+	}
+
+	bool FX8010::loadBytecode(const std::string &path)
+	{
+		if (DEBUG)
+			cout << "Lade Bytecode: " << path << endl;
+		BytecodeFile file;
+		if (!file.open(path))
+		{
+			bytecodeError("Datei nicht lesbar");
+			return false;
+		}
+		return loadBytecodeFromMemory(file.data(), file.getSize());
+	}
+
+	void FX8010::bytecodeError(const std::string &reason)
+	{
+		error.errorDescription = errorMap[ERROR_INVALID_BYTECODE] + " (" + reason + ")";
+		error.errorRow = 0;
+		errorList.push_back(error);
+		if (DEBUG)
+			cout << colorMap[COLOR_RED] << error.errorDescription << colorMap[COLOR_NULL] << endl;
+	}
+
+	// CHECKED
+	bool FX8010::loadBytecodeFromMemory(const void *data, size_t size)
+	{
+		if (isReady)
+		{
+			bytecodeError("Instanz hat bereits ein Programm");
+			return false;
+		}
+		const uint8_t *bytes = static_cast<const uint8_t *>(data);
+		BytecodeHeader header;
+		if (data == nullptr || size < sizeof(header))
+		{
+			bytecodeError("zu kurz");
+			return false;
+		}
+		memcpy(&header, bytes, sizeof(header));
+		if (memcmp(header.magic, BYTECODE_MAGIC, sizeof(header.magic)) != 0 || header.byteOrder != BYTECODE_BYTE_ORDER)
+		{
+			bytecodeError("kein FX8010 Bytecode oder andere Byte-Reihenfolge");
+			return false;
+		}
+		if (header.version != BYTECODE_VERSION)
+		{
+			bytecodeError("Version " + std::to_string(header.version) + ", erwartet " + std::to_string(BYTECODE_VERSION));
+			return false;
+		}
+		if (header.fileSize > size || !isValidSection(header.registers, sizeof(BytecodeRegister), header.fileSize) || !isValidSection(header.values, sizeof(float), header.fileSize) ||
+			!isValidSection(header.instructions, sizeof(BytecodeInstruction), header.fileSize) || !isValidSection(header.controls, sizeof(BytecodeString), header.fileSize) ||
+			!isValidSection(header.meta, sizeof(BytecodeMetaEntry), header.fileSize) || !isValidSection(header.strings, 1, header.fileSize))
+		{
+			bytecodeError("Abschnitt ausserhalb der Datei");
+			return false;
+		}
+
+		const int numRegisters = static_cast<int>(header.registers.count);
+		const int numValues = static_cast<int>(header.values.count);
+		if (numRegisters < 4 || header.constantSegmentStart < 0 || header.constantSegmentStart > numValues || header.iTRAMSize < 0 || header.iTRAMSize > MAX_IDELAY_SIZE ||
+			header.xTRAMSize < 0 || header.xTRAMSize > MAX_XDELAY_SIZE || header.instructions.count == 0)
+		{
+			bytecodeError("ungueltiger Header");
+			return false;
+		}
+		if (header.maxIOIndex >= numChannels)
+		{
+			error.errorDescription = errorMap[ERROR_IO_INDEX_OUT_OF_RANGE];
+			error.errorRow = 0;
+			errorList.push_back(error);
+			return false;
+		}
+
+		const char *pool = reinterpret_cast<const char *>(bytes + header.strings.offset);
+		bool stringsValid = true;
+		auto readString = [&](const BytecodeString &string)
+		{
+			if (static_cast<uint64_t>(string.offset) + string.length > header.strings.count)
+			{
+				stringsValid = false;
+				return std::string();
+			}
+			return std::string(pool + string.offset, string.length);
+		};
+
+		// Register
+		std::vector<GPR> loadedRegisters(numRegisters);
+		for (int i = 0; i < numRegisters; i++)
+		{
+			const BytecodeRegister entry = readElement<BytecodeRegister>(bytes, header.registers, i);
+			GPR &reg = loadedRegisters[i];
+			reg.registerType = entry.registerType;
+			reg.registerName = readString(entry.name);
+			reg.initValue = entry.initValue;
+			reg.IOIndex = entry.IOIndex;
+			reg.isBorrow = entry.isBorrow != 0;
+			reg.valueIndex = entry.valueIndex;
+			reg.isLiteral = entry.isLiteral != 0;
+			reg.smoothingType = entry.smoothingType;
+			reg.smoothingTime = entry.smoothingTime;
+			const bool isIO = reg.registerType == INPUT || reg.registerType == OUTPUT;
+			if (reg.registerType < STATIC || reg.registerType > CCR || reg.valueIndex < 0 || reg.valueIndex >= numValues ||
+				reg.smoothingType < SMOOTHING_NONE || reg.smoothingType > SMOOTHING_ONE_POLE || (isIO && (reg.IOIndex < 0 || reg.IOIndex > header.maxIOIndex)))
+			{
+				bytecodeError("Register " + std::to_string(i));
+				return false;
+			}
+		}
+		// Spezialregister wie in initialize()
+		if (!stringsValid || loadedRegisters[0].registerType != CCR || loadedRegisters[1].registerType != READ || loadedRegisters[2].registerType != WRITE || loadedRegisters[3].registerType != AT)
+		{
+			bytecodeError("Register");
+			return false;
+		}
+
+		// Instruktionen, die letzte beendet den Samplezyklus
+		std::vector<Instruction> loadedInstructions(header.instructions.count);
+		for (size_t i = 0; i < loadedInstructions.size(); i++)
+		{
+			const BytecodeInstruction entry = readElement<BytecodeInstruction>(bytes, header.instructions, i);
+			Instruction &instruction = loadedInstructions[i];
+			instruction.opcode = entry.opcode;
+			instruction.operand1 = entry.operand1;
+			instruction.operand2 = entry.operand2;
+			instruction.operand3 = entry.operand3;
+			instruction.operand4 = entry.operand4;
+			instruction.row = entry.row;
+			instruction.hasInput = entry.hasInput != 0;
+			instruction.hasOutput = entry.hasOutput != 0;
+			instruction.hasNoise = entry.hasNoise != 0;
+			instruction.writesCCR = entry.writesCCR != 0;
+			instruction.saturates = entry.saturates != 0;
+			const int operands[4] = {entry.operand1, entry.operand2, entry.operand3, entry.operand4};
+			bool valid = entry.opcode >= MACS && entry.opcode <= MULS;
+			for (const int operand : operands)
+				valid = valid && operand >= 0 && operand < numRegisters;
+			if (!valid)
+			{
+				bytecodeError("Instruktion " + std::to_string(i));
+				return false;
+			}
+		}
+		if (loadedInstructions.back().opcode != END)
+		{
+			bytecodeError("kein END");
+			return false;
+		}
+
+		std::vector<std::string> loadedControls(header.controls.count);
+		for (size_t i = 0; i < loadedControls.size(); i++)
+			loadedControls[i] = readString(readElement<BytecodeString>(bytes, header.controls, i));
+		std::unordered_map<std::string, std::string> loadedMeta;
+		for (size_t i = 0; i < header.meta.count; i++)
+		{
+			const BytecodeMetaEntry entry = readElement<BytecodeMetaEntry>(bytes, header.meta, i);
+			loadedMeta[readString(entry.key)] = readString(entry.value);
+		}
+		if (!stringsValid)
+		{
+			bytecodeError("String ausserhalb des Stringpools");
+			return false;
+		}
+
+		// Gueltig, uebernehmen
+		registers.swap(loadedRegisters);
+		registerIndexByName.clear();
+		indexedRegisters = 0;
+		registerValues.resize(numValues);
+		memcpy(registerValues.data(), bytes + header.values.offset, numValues * sizeof(float));
+		constantSegmentStart = header.constantSegmentStart;
+		instructions.swap(loadedInstructions);
+		iTRAMSize = header.iTRAMSize;
+		xTRAMSize = header.xTRAMSize;
+		controlRegisters.swap(loadedControls);
+		metaMap.swap(loadedMeta);
+
+		optimizerReport = OptimizerReport();
+		optimizerReport.enabled = header.optimizerEnabled != 0;
+		optimizerReport.instructionsBefore = header.instructionsBefore;
+		optimizerReport.instructionsAfter = header.instructionsAfter;
+		optimizerReport.foldedConstants = header.foldedConstants;
+		optimizerReport.propagatedCopies = header.propagatedCopies;
+		optimizerReport.reducedInstructions = header.reducedInstructions;
+		optimizerReport.removedDeadWrites = header.removedDeadWrites;
+		optimizerReport.elidedCCR = header.elidedCCR;
+		optimizerReport.elidedSaturation = header.elidedSaturation;
+
+		finishLoad();
+		return true;
+	}
+
+} // namespace Klangraum
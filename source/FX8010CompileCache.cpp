@@ -0,0 +1,275 @@
+// Copyright 2023 Klangraum
+// Compile-Cache fuer Preset-Bibliotheken (include/FX8010CompileCache.h)
+
+#include "../include/FX8010CompileCache.h"
+#include "../include/helpers.h"
+
+#include <cstdio>
+#include <fstream>
+
+namespace Klangraum
+{
+	namespace
+	{
+		// FNV-1a 64 Bit
+		const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+		const uint64_t FNV_PRIME = 1099511628211ULL;
+
+		inline uint64_t hashBytes(uint64_t hash, const void *data, size_t size)
+		{
+			const uint8_t *bytes = static_cast<const uint8_t *>(data);
+			for (size_t i = 0; i < size; i++)
+			{
+				hash ^= bytes[i];
+				hash *= FNV_PRIME;
+			}
+			return hash;
+		}
+
+		struct LibraryContext
+		{
+			FX8010CompileCache *cache;
+			std::vector<FX8010CompileCache::LibraryEntry> *results;
+		};
+	}
+
+	FX8010CompileCache::FX8010CompileCache(const std::string &directory, int numChannels, bool optimize)
+		: directory(directory), numChannels(numChannels), optimize(optimize)
+	{
+		// Pfade werden mit '/' zusammengesetzt (geht auch unter Windows)
+		while (this->directory.size() > 1 && (this->directory.back() == '/' || this->directory.back() == '\\'))
+			this->directory.pop_back();
+	}
+
+	// CHECKED
+	FX8010CompileCache::Key FX8010CompileCache::makeKey(const std::string &source) const
+	{
+		const uint32_t settings[4] = {COMPILER_VERSION, BYTECODE_VERSION, optimize ? 1u : 0u, static_cast<uint32_t>(numChannels)};
+		uint64_t hash = hashBytes(FNV_OFFSET, settings, sizeof(settings));
+		return hashBytes(hash, source.data(), source.size());
+	}
+
+	std::string FX8010CompileCache::getPath(Key key) const
+	{
+		char name[24];
+		snprintf(name, sizeof(name), "%016llx.dab", static_cast<unsigned long long>(key));
+		return directory + "/" + name;
+	}
+
+	// CHECKED
+	std::shared_ptr<const FX8010CompileCache::Program> FX8010CompileCache::compile(const std::string &source, std::vector<FX8010::MyError> *errors)
+	{
+		if (errors != nullptr)
+			errors->clear();
+		const Key key = makeKey(source);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			auto it = entries.find(key);
+			if (it != entries.end())
+			{
+				memoryHits.fetch_add(1, std::memory_order_relaxed);
+				return it->second;
+			}
+		}
+
+		if (!directory.empty())
+		{
+			std::shared_ptr<const Program> program = loadFromDisk(key);
+			if (program != nullptr)
+			{
+				diskHits.fetch_add(1, std::memory_order_relaxed);
+				return program;
+			}
+		}
+
+		// Ausserhalb der Sperre, mehrere Threads uebersetzen gleichzeitig
+		FX8010 dsp(numChannels);
+		dsp.setOptimizerEnabled(optimize);
+		const bool success = dsp.loadFromString(source);
+		if (errors != nullptr)
+			*errors = dsp.getErrorList();
+		if (!success)
+		{
+			failed.fetch_add(1, std::memory_order_relaxed);
+			if (DEBUG)
+				cout << colorMap[COLOR_RED] << "CompileCache: Quellcode fehlerhaft" << colorMap[COLOR_NULL] << endl;
+			return nullptr;
+		}
+		std::shared_ptr<Program> program = makeProgram(key, dsp);
+		compiled.fetch_add(1, std::memory_order_relaxed);
+		if (!directory.empty())
+			saveToDisk(*program);
+		return insert(program);
+	}
+
+	std::shared_ptr<const FX8010CompileCache::Program> FX8010CompileCache::compileFile(const std::string &path, std::vector<FX8010::MyError> *errors)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+		{
+			if (errors != nullptr)
+			{
+				FX8010::MyError error;
+				error.errorDescription = "Datei nicht lesbar: " + path;
+				error.errorRow = 0;
+				*errors = {error};
+			}
+			failed.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		const std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		return compile(source, errors);
+	}
+
+	void FX8010CompileCache::compileTask(void *context, int index)
+	{
+		LibraryContext *library = static_cast<LibraryContext *>(context);
+		LibraryEntry &entry = (*library->results)[index];
+		entry.program = library->cache->compileFile(entry.path, &entry.errors);
+	}
+
+	// CHECKED
+	std::vector<FX8010CompileCache::LibraryEntry> FX8010CompileCache::compileLibrary(const std::vector<std::string> &paths, FX8010ThreadPool *pool)
+	{
+		std::vector<LibraryEntry> results(paths.size());
+		for (size_t i = 0; i < paths.size(); i++)
+			results[i].path = paths[i];
+		if (results.empty())
+			return results;
+
+		std::unique_ptr<FX8010ThreadPool> ownPool;
+		if (pool == nullptr)
+		{
+			ownPool.reset(new FX8010ThreadPool());
+			pool = ownPool.get();
+		}
+		LibraryContext context = {this, &results};
+		pool->run(static_cast<int>(results.size()), compileTask, &context);
+		return results;
+	}
+
+	// CHECKED
+	std::shared_ptr<const FX8010CompileCache::Program> FX8010CompileCache::loadFromDisk(Key key)
+	{
+		BytecodeFile file(getPath(key));
+		if (!file.isOpen())
+			return nullptr;
+		// Laden prueft die Datei vollstaendig und liefert die Metadaten
+		FX8010 dsp(numChannels);
+		if (!dsp.loadBytecodeFromMemory(file.data(), file.getSize()))
+		{
+			if (DEBUG)
+				cout << colorMap[COLOR_RED] << "CompileCache: " << getPath(key) << " ungueltig, wird neu uebersetzt" << colorMap[COLOR_NULL] << endl;
+			return nullptr;
+		}
+		std::shared_ptr<Program> program = std::make_shared<Program>();
+		program->key = key;
+		const uint8_t *bytes = static_cast<const uint8_t *>(file.data());
+		program->bytecode.assign(bytes, bytes + file.getSize());
+		program->metaData = dsp.getMetaData();
+		program->name = program->metaData.count("name") ? program->metaData["name"] : "";
+		program->guid = program->metaData.count("guid") ? program->metaData["guid"] : "";
+		return insert(program);
+	}
+
+	// CHECKED
+	void FX8010CompileCache::saveToDisk(const Program &program)
+	{
+		// Erst unter eigenem Namen schreiben, dann umbenennen: parallele Leser sehen nie eine halbe Datei
+		const std::string path = getPath(program.key);
+		const std::string temporary = path + "." + std::to_string(temporaryCounter.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+		bool success;
+		{
+			std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char *>(program.bytecode.data()), static_cast<std::streamsize>(program.bytecode.size()));
+			success = static_cast<bool>(file);
+		}
+		// Unter Windows scheitert rename() an einer vorhandenen Datei, die ist dann schon aktuell
+		if (!success || std::rename(temporary.c_str(), path.c_str()) != 0)
+		{
+			std::remove(temporary.c_str());
+			if (DEBUG && !success)
+				cout << colorMap[COLOR_RED] << "CompileCache: " << path << " kann nicht geschrieben werden" << colorMap[COLOR_NULL] << endl;
+		}
+	}
+
+	std::shared_ptr<FX8010CompileCache::Program> FX8010CompileCache::makeProgram(Key key, FX8010 &dsp)
+	{
+		std::shared_ptr<Program> program = std::make_shared<Program>();
+		program->key = key;
+		program->bytecode = dsp.getBytecode();
+		program->metaData = dsp.getMetaData();
+		program->name = program->metaData.count("name") ? program->metaData["name"] : "";
+		program->guid = program->metaData.count("guid") ? program->metaData["guid"] : "";
+		return program;
+	}
+
+	// CHECKED
+	std::shared_ptr<const FX8010CompileCache::Program> FX8010CompileCache::insert(std::shared_ptr<Program> program)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		// Ein anderer Thread war mit demselben Quellcode schneller
+		auto it = entries.find(program->key);
+		if (it != entries.end())
+			return it->second;
+		entries[program->key] = program;
+		// Gleicher Name in mehreren Presets: der zuletzt eingetragene gewinnt
+		if (!program->name.empty())
+			nameIndex[program->name] = program->key;
+		if (!program->guid.empty())
+			guidIndex[program->guid] = program->key;
+		return program;
+	}
+
+	std::shared_ptr<const FX8010CompileCache::Program> FX8010CompileCache::find(Key key)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = entries.find(key);
+		return (it != entries.end()) ? it->second : nullptr;
+	}
+
+	std::shared_ptr<const FX8010CompileCache::Program> FX8010CompileCache::findByName(const std::string &name)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = nameIndex.find(name);
+		return (it != nameIndex.end()) ? entries[it->second] : nullptr;
+	}
+
+	std::shared_ptr<const FX8010CompileCache::Program> FX8010CompileCache::findByGuid(const std::string &guid)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = guidIndex.find(guid);
+		return (it != guidIndex.end()) ? entries[it->second] : nullptr;
+	}
+
+	// CHECKED
+	std::unique_ptr<FX8010> FX8010CompileCache::createInstance(const Program &program, int numChannels, FX8010::EngineType type, int hostSampleRate)
+	{
+		std::unique_ptr<FX8010> dsp(new FX8010(numChannels));
+		dsp->setHostSampleRate(hostSampleRate);
+		// Vor dem Laden nur gemerkt, loadBytecodeFromMemory() uebersetzt fuer diese Engine
+		dsp->setEngineType(type);
+		if (!dsp->loadBytecodeFromMemory(program.bytecode.data(), program.bytecode.size()))
+			return nullptr;
+		return dsp;
+	}
+
+	void FX8010CompileCache::clear()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		entries.clear();
+		nameIndex.clear();
+		guidIndex.clear();
+	}
+
+	FX8010CompileCache::Statistics FX8010CompileCache::getStatistics() const
+	{
+		Statistics statistics;
+		statistics.memoryHits = memoryHits.load(std::memory_order_relaxed);
+		statistics.diskHits = diskHits.load(std::memory_order_relaxed);
+		statistics.compiled = compiled.load(std::memory_order_relaxed);
+		statistics.failed = failed.load(std::memory_order_relaxed);
+		return statistics;
+	}
+
+} // namespace Klangraum
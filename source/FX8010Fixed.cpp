@@ -0,0 +1,673 @@
+// Copyright 2023 Klangraum
+// Festkomma-Engine (ENGINE_FIXED)
+// GPR und TRAM sind int32 (Q31 bzw. Integer), der Akkumulator hat 67 Bit (Q62 + 4 Guard Bits).
+// ANDXOR, TSTNEG, Wraparound und Borrow arbeiten direkt auf den Bits, ohne den Umweg ueber
+// floatToInt()/intToFloat() der float Engines. Der Befehlsstrom ist wie beim dekodierten
+// Interpreter aufgebaut (Handler + Operanden-Pointer), nur eben auf fixedValues.
+//
+// Welche Werte sind Integer statt Q31? (Konvertierung beim Umschalten und in get/setRegisterValue())
+//   - CCR
+//   - Register und Literale mit Startwert |x| > 1.0 (wie im kX Assembler: 3 = Integer, 0.5 = Q31)
+//   - Operanden, die der Chip als Zahl liest: SKIP X/Y, LOG/EXP X/Y, TRAM Adresse (Y),
+//     Multiplikator Y von MACINTS/MACINTW. Literale bekommen dafuer eine eigene Integer-Kopie.
+// LOG/EXP ueber die Q31 Kernels aus FX8010LogExp.h (fuehrende Nullen statt IEEE Exponent).
+
+#include "../include/FX8010.h"
+#include "../include/helpers.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Klangraum
+{
+	namespace
+	{
+		const int64_t Q31_SCALE = int64_t(1) << 31;
+
+		// Laengste MAC-Kette, die als ein Block ausgefuehrt wird
+		const int MAX_MAC_CHAIN = 64;
+
+		inline int32_t saturate32(const int64_t x)
+		{
+			return (x >= INT32_MAX) ? INT32_MAX : ((x <= INT32_MIN) ? INT32_MIN : static_cast<int32_t>(x));
+		}
+
+		inline int32_t saturate32(const FixedWide &x)
+		{
+			return (x > FixedWide(INT32_MAX)) ? INT32_MAX : ((x < FixedWide(INT32_MIN)) ? INT32_MIN : static_cast<int32_t>(static_cast<int64_t>(x)));
+		}
+
+		// Untere 32 Bit (Zweierkomplement-Wraparound)
+		inline int32_t wrap32(const int64_t x)
+		{
+			return static_cast<int32_t>(static_cast<uint32_t>(static_cast<uint64_t>(x)));
+		}
+
+		inline bool outOfRange32(const int64_t x)
+		{
+			return x > INT32_MAX || x < INT32_MIN;
+		}
+
+		// x * 2^bits im Zweierkomplement (Linksschieben negativer Werte ist in C++17 undefiniert)
+		inline FixedWide shiftLeft(const FixedWide &x, const int bits)
+		{
+#if FX8010_HAS_INT128
+			return static_cast<FixedWide>(static_cast<unsigned __int128>(x) << bits);
+#else
+			// Die Ersatz-Struktur schiebt bereits auf uint64_t Haelften
+			return x << bits;
+#endif
+		}
+
+		// Akkumulator auf 67 Bit begrenzen (Ueberlauf der Guard Bits = Wraparound)
+		inline FixedWide wrap67(const FixedWide &x)
+		{
+			return shiftLeft(x, 61) >> 61;
+		}
+
+		// wie FX8010::setCCR(), 0x7FFFFFFF/0x80000000 entsprechen +1.0/-1.0
+		inline int32_t ccrOf(const int32_t result)
+		{
+			if (result == 0)
+				return 0b01000; // Zero
+			if (result == INT32_MAX)
+				return 0b10000; // Positive Saturation
+			if (result == INT32_MIN)
+				return 0b10100; // Negative Saturation
+			return (result < 0) ? 0b00110 : 0b00010; // Normalized Negative/Positive
+		}
+
+		// Summe der Q62 Produkte einer MAC-Kette
+		// Die Produkte werden in obere (signed) und untere (unsigned) 32 Bit zerlegt, so bleibt die
+		// Schleife in int64 und wird vom Compiler vektorisiert (pmuldq, mit -msse4.1 bzw. -mavx2).
+		inline FixedWide dotProduct(const int32_t *x, const int32_t *y, const int n)
+		{
+			int64_t high = 0;
+			int64_t low = 0;
+			for (int k = 0; k < n; k++)
+			{
+				const int64_t p = static_cast<int64_t>(x[k]) * y[k];
+				high += p >> 32;
+				low += p & 0xFFFFFFFF;
+			}
+			return shiftLeft(FixedWide(high), 32) + FixedWide(low);
+		}
+	}
+
+	// Handler der Festkomma-Engine, arithmetische Opcodes mit/ohne CCR (Optimierer)
+	// Saturation wird immer ausgefuehrt: in Q31 liegt schon 0.5 + 0.5 ausserhalb des Zahlenbereichs.
+	struct FX8010::FixedOps
+	{
+		typedef FX8010::FixedInstruction FI;
+
+		template <bool WriteCCR>
+		static inline void setCCR(FX8010 &dsp, const int32_t result, const bool borrow = false)
+		{
+			if (WriteCCR)
+				dsp.fixedValues[0] = ccrOf(result) | (borrow ? 0b00001 : 0);
+		}
+
+		// Q31 in den Akkumulator (Q62)
+		static inline int64_t toAccumulator(const int32_t a)
+		{
+			return static_cast<int64_t>(a) * Q31_SCALE;
+		}
+
+		template <bool WriteCCR>
+		static const FI *macs(FX8010 &dsp, const FI *ip)
+		{
+			// R = A + X * Y, passt ohne Guard Bits in int64
+			const int64_t r = toAccumulator(*ip->A) + static_cast<int64_t>(*ip->X) * *ip->Y;
+			dsp.fixedAccumulator = r;
+			*ip->R = saturate32(r >> 31);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR>
+		static const FI *macsn(FX8010 &dsp, const FI *ip)
+		{
+			// R = A - X * Y
+			const int64_t r = toAccumulator(*ip->A) - static_cast<int64_t>(*ip->X) * *ip->Y;
+			dsp.fixedAccumulator = r;
+			*ip->R = saturate32(r >> 31);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR>
+		static const FI *macw(FX8010 &dsp, const FI *ip)
+		{
+			// R = A + X * Y mit Wraparound, Borrow bei Ueberlauf
+			const int64_t r = toAccumulator(*ip->A) + static_cast<int64_t>(*ip->X) * *ip->Y;
+			dsp.fixedAccumulator = r;
+			*ip->R = wrap32(r >> 31);
+			setCCR<WriteCCR>(dsp, *ip->R, outOfRange32(r >> 31));
+			return ip + 1;
+		}
+
+		template <bool WriteCCR>
+		static const FI *macwn(FX8010 &dsp, const FI *ip)
+		{
+			const int64_t r = toAccumulator(*ip->A) - static_cast<int64_t>(*ip->X) * *ip->Y;
+			dsp.fixedAccumulator = r;
+			*ip->R = wrap32(r >> 31);
+			setCCR<WriteCCR>(dsp, *ip->R, outOfRange32(r >> 31));
+			return ip + 1;
+		}
+
+		template <bool WriteCCR>
+		static const FI *macints(FX8010 &dsp, const FI *ip)
+		{
+			// R = A + X * Y, Integer-Multiplikation
+			const int64_t r = static_cast<int64_t>(*ip->A) + static_cast<int64_t>(*ip->X) * *ip->Y;
+			dsp.fixedAccumulator = wrap67(shiftLeft(FixedWide(r), 31));
+			*ip->R = saturate32(r);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR>
+		static const FI *macintw(FX8010 &dsp, const FI *ip)
+		{
+			const int64_t r = static_cast<int64_t>(*ip->A) + static_cast<int64_t>(*ip->X) * *ip->Y;
+			dsp.fixedAccumulator = wrap67(shiftLeft(FixedWide(r), 31));
+			*ip->R = wrap32(r);
+			setCCR<WriteCCR>(dsp, *ip->R, outOfRange32(r));
+			return ip + 1;
+		}
+
+		template <bool WriteCCR>
+		static const FI *acc3(FX8010 &dsp, const FI *ip)
+		{
+			// R = A + X + Y
+			const int64_t r = static_cast<int64_t>(*ip->A) + *ip->X + *ip->Y;
+			dsp.fixedAccumulator = shiftLeft(FixedWide(r), 31);
+			*ip->R = saturate32(r);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR>
+		static const FI *macmv(FX8010 &dsp, const FI *ip)
+		{
+			// Akkumulator += X * Y, R = A
+			dsp.fixedAccumulator = wrap67(dsp.fixedAccumulator + FixedWide(static_cast<int64_t>(*ip->X) * *ip->Y));
+			*ip->R = *ip->A;
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		// MAC-Kette: ip->length aufeinanderfolgende MACMV in einem Block
+		// decodeFixed() stellt sicher, dass kein X/Y der Kette ein R der Kette liest,
+		// die Produkte koennen also vor den Kopien gebildet werden.
+		template <bool WriteCCR>
+		static const FI *macmvChain(FX8010 &dsp, const FI *ip)
+		{
+			const int n = ip->length;
+			alignas(64) int32_t x[MAX_MAC_CHAIN];
+			alignas(64) int32_t y[MAX_MAC_CHAIN];
+			for (int k = 0; k < n; k++)
+			{
+				x[k] = *ip[k].X;
+				y[k] = *ip[k].Y;
+			}
+			dsp.fixedAccumulator = wrap67(dsp.fixedAccumulator + dotProduct(x, y, n));
+			for (int k = 0; k < n; k++)
+				*ip[k].R = *ip[k].A;
+			// Nur das CCR der letzten Instruktion ist sichtbar
+			setCCR<WriteCCR>(dsp, *ip[n - 1].R);
+			return ip + n;
+		}
+
+		template <bool WriteCCR>
+		static const FI *andxor(FX8010 &dsp, const FI *ip)
+		{
+			// Alle Sonderfaelle aus logicOps() sind (A and X) xor Y
+			*ip->R = (*ip->A & *ip->X) ^ *ip->Y;
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR>
+		static const FI *tstneg(FX8010 &dsp, const FI *ip)
+		{
+			*ip->R = (*ip->A >= *ip->Y) ? *ip->X : ~*ip->X;
+			dsp.fixedAccumulator = toAccumulator(*ip->R);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR>
+		static const FI *limit(FX8010 &dsp, const FI *ip)
+		{
+			*ip->R = (*ip->A >= *ip->Y) ? *ip->X : *ip->Y;
+			dsp.fixedAccumulator = toAccumulator(*ip->R);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR>
+		static const FI *limitn(FX8010 &dsp, const FI *ip)
+		{
+			*ip->R = (*ip->A < *ip->Y) ? *ip->X : *ip->Y;
+			dsp.fixedAccumulator = toAccumulator(*ip->R);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR>
+		static const FI *interp(FX8010 &dsp, const FI *ip)
+		{
+			// R = A + X * (Y - A), (Y - A) hat 33 Bit
+			const FixedWide r = FixedWide(toAccumulator(*ip->A)) + FixedWide(static_cast<int64_t>(*ip->X) * (static_cast<int64_t>(*ip->Y) - *ip->A));
+			dsp.fixedAccumulator = r;
+			*ip->R = saturate32(r >> 31);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR>
+		static const FI *log(FX8010 &dsp, const FI *ip)
+		{
+			*ip->R = logLinearQ31(*ip->A, *ip->X, *ip->Y);
+			dsp.fixedAccumulator = toAccumulator(*ip->R);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR>
+		static const FI *exp(FX8010 &dsp, const FI *ip)
+		{
+			*ip->R = expLinearQ31(*ip->A, *ip->X, *ip->Y);
+			dsp.fixedAccumulator = toAccumulator(*ip->R);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		// Interne Opcodes des Optimierers
+		template <bool WriteCCR>
+		static const FI *movs(FX8010 &dsp, const FI *ip)
+		{
+			// R = A
+			*ip->R = *ip->A;
+			dsp.fixedAccumulator = toAccumulator(*ip->R);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR>
+		static const FI *adds(FX8010 &dsp, const FI *ip)
+		{
+			// R = A + X
+			const int64_t r = static_cast<int64_t>(*ip->A) + *ip->X;
+			dsp.fixedAccumulator = shiftLeft(FixedWide(r), 31);
+			*ip->R = saturate32(r);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		template <bool WriteCCR>
+		static const FI *muls(FX8010 &dsp, const FI *ip)
+		{
+			// R = X * Y
+			const int64_t r = static_cast<int64_t>(*ip->X) * *ip->Y;
+			dsp.fixedAccumulator = r;
+			*ip->R = saturate32(r >> 31);
+			setCCR<WriteCCR>(dsp, *ip->R);
+			return ip + 1;
+		}
+
+		static const FI *skip(FX8010 &dsp, const FI *ip)
+		{
+			// Wenn X = CCR, dann ueberspringe Y Instructions (wie der dekodierte Interpreter)
+			if (*ip->X == dsp.fixedValues[0])
+			{
+				int numSkip = *ip->Y;
+				if (numSkip < 0)
+					numSkip = 1;
+				const FI *first = dsp.fixedInstructions.data();
+				const int numInstructions = static_cast<int>(dsp.fixedInstructions.size());
+				return first + (static_cast<int>(ip - first) + 1 + numSkip) % numInstructions;
+			}
+			return ip + 1;
+		}
+
+		// TRAM: Adresse wie readSmallDelay()/writeSmallDelay(), Zweierpotenz-Ring mit Maske
+		static const FI *idelayRead(FX8010 &dsp, const FI *ip)
+		{
+			*ip->A = dsp.fixedSmallDelay[(static_cast<uint32_t>(dsp.smallDelayPos + dsp.delayFrame) - static_cast<uint32_t>(*ip->Y)) & dsp.smallDelayMask];
+			return ip + 1;
+		}
+
+		static const FI *idelayWrite(FX8010 &dsp, const FI *ip)
+		{
+			dsp.fixedSmallDelay[(static_cast<uint32_t>(dsp.smallDelayPos + dsp.delayFrame) - static_cast<uint32_t>(*ip->Y)) & dsp.smallDelayMask] = *ip->A;
+			return ip + 1;
+		}
+
+		static const FI *xdelayRead(FX8010 &dsp, const FI *ip)
+		{
+			*ip->A = dsp.fixedLargeDelay[(static_cast<uint32_t>(dsp.largeDelayPos + dsp.delayFrame) - static_cast<uint32_t>(*ip->Y)) & dsp.largeDelayMask];
+			return ip + 1;
+		}
+
+		static const FI *xdelayWrite(FX8010 &dsp, const FI *ip)
+		{
+			dsp.fixedLargeDelay[(static_cast<uint32_t>(dsp.largeDelayPos + dsp.delayFrame) - static_cast<uint32_t>(*ip->Y)) & dsp.largeDelayMask] = *ip->A;
+			return ip + 1;
+		}
+
+		static const FI *nop(FX8010 &, const FI *ip)
+		{
+			return ip + 1;
+		}
+
+		static const FI *end(FX8010 &, const FI *)
+		{
+			return nullptr;
+		}
+
+		// Vorstufe fuer NOISE: derselbe LFSR wie whitenoise(), g_x2 ist bereits der Q31 Wert
+		static const FI *noise(FX8010 &dsp, const FI *ip)
+		{
+			dsp.g_x1 ^= dsp.g_x2;
+			*ip->N = dsp.g_x2;
+			dsp.g_x2 = static_cast<int32_t>(static_cast<uint32_t>(dsp.g_x2) + static_cast<uint32_t>(dsp.g_x1));
+			return ip->exec(dsp, ip);
+		}
+	};
+
+	// CHECKED
+	int32_t FX8010::toFixed(int valueIndex, float value)
+	{
+		if (fixedIsInteger[valueIndex])
+			return static_cast<int32_t>(std::max(-2147483648.0f, std::min(value, 2147483520.0f)));
+		return floatToQ31(value);
+	}
+
+	// CHECKED
+	float FX8010::fromFixed(int valueIndex)
+	{
+		const int32_t value = fixedValues[valueIndex];
+		return fixedIsInteger[valueIndex] ? static_cast<float>(value) : q31ToFloat(value);
+	}
+
+	// Uebersetzt instructions in fixedInstructions und uebernimmt den float Zustand
+	void FX8010::decodeFixed()
+	{
+		const int numValues = static_cast<int>(registerValues.size());
+
+		// Integer oder Q31? Zuerst nach Startwert, dann nach Verwendung als Zahl
+		fixedIsInteger.assign(numValues, false);
+		fixedIsInteger[0] = true; // CCR
+		for (const auto &reg : registers)
+			if (reg.valueIndex >= 0 && std::abs(reg.initValue) > 1.0f)
+				fixedIsInteger[reg.valueIndex] = true;
+
+		// Operand k (2 = A, 3 = X, 4 = Y) wird als Zahl gelesen
+		auto isIntegerOperand = [](const Instruction &instruction, int k)
+		{
+			switch (instruction.opcode)
+			{
+			case SKIP:
+			case LOG:
+			case EXP:
+				return k == 3 || k == 4;
+			case IDELAY:
+			case XDELAY:
+			case MACINTS:
+			case MACINTW:
+				return k == 4;
+			default:
+				return false;
+			}
+		};
+
+		// Literale (Konstantensegment) bekommen fuer diese Operanden eine Integer-Kopie,
+		// nach Wert dedupliziert. operandValue[i][k]: Werteindex des Operanden in fixedValues
+		std::vector<std::array<int, 5>> operandValue(instructions.size());
+		std::map<int32_t, int> integerConstants;
+		std::vector<int32_t> integerConstantValues;
+		for (size_t i = 0; i < instructions.size(); i++)
+		{
+			const Instruction &instruction = instructions[i];
+			const int operands[5] = {0, instruction.operand1, instruction.operand2, instruction.operand3, instruction.operand4};
+			for (int k = 1; k <= 4; k++)
+			{
+				const int valueIndex = registers[operands[k]].valueIndex;
+				operandValue[i][k] = valueIndex;
+				if (instruction.opcode == END || !isIntegerOperand(instruction, k) || fixedIsInteger[valueIndex])
+					continue;
+				if (valueIndex < constantSegmentStart)
+				{
+					fixedIsInteger[valueIndex] = true;
+					continue;
+				}
+				const int32_t value = static_cast<int32_t>(registerValues[valueIndex]);
+				auto it = integerConstants.find(value);
+				if (it == integerConstants.end())
+				{
+					it = integerConstants.insert({value, numValues + static_cast<int>(integerConstantValues.size())}).first;
+					integerConstantValues.push_back(value);
+				}
+				operandValue[i][k] = it->second;
+			}
+		}
+
+		// Werte uebernehmen
+		fixedValues.assign(numValues + integerConstantValues.size(), 0);
+		fixedIsInteger.resize(fixedValues.size(), true);
+		for (int i = 0; i < numValues; i++)
+			fixedValues[i] = toFixed(i, registerValues[i]);
+		std::copy(integerConstantValues.begin(), integerConstantValues.end(), fixedValues.begin() + numValues);
+
+		fixedSmallDelay.resize(smallDelayMask + 1);
+		for (int i = 0; i <= smallDelayMask; i++)
+			fixedSmallDelay[i] = floatToQ31(smallDelayBuffer[i]);
+		fixedLargeDelay.resize(largeDelayMask + 1);
+		for (int i = 0; i <= largeDelayMask; i++)
+			fixedLargeDelay[i] = floatToQ31(largeDelayBuffer[i]);
+
+		// Akkumulator: Q62, ausserhalb von int64 (|x| >= 2.0) begrenzt
+		fixedAccumulator = static_cast<int64_t>(std::max(-1.99, std::min(accumulator, 1.99)) * 4611686018427387904.0);
+
+		// I/O Register
+		fixedInputs.clear();
+		fixedOutputs.clear();
+		for (const auto &reg : registers)
+		{
+			if (reg.registerType == INPUT)
+				fixedInputs.push_back({&fixedValues[reg.valueIndex], reg.IOIndex});
+			else if (reg.registerType == OUTPUT)
+				fixedOutputs.push_back({&fixedValues[reg.valueIndex], reg.IOIndex});
+		}
+
+		// Befehlsstrom
+		const bool ccrUsed = programReadsCCR();
+		fixedInstructions.clear();
+		fixedInstructions.reserve(instructions.size());
+		for (size_t i = 0; i < instructions.size(); i++)
+		{
+			const Instruction &instruction = instructions[i];
+			const bool writesCCR = ccrUsed && instruction.writesCCR;
+			FixedInstruction fixed;
+			fixed.opcode = instruction.opcode;
+			fixed.writesCCR = writesCCR;
+			fixed.R = &fixedValues[operandValue[i][1]];
+			fixed.A = &fixedValues[operandValue[i][2]];
+			fixed.X = &fixedValues[operandValue[i][3]];
+			fixed.Y = &fixedValues[operandValue[i][4]];
+			const int typeR = registers[instruction.operand1].registerType;
+
+#define FX8010_FIXED(name) (writesCCR ? FixedOps::name<true> : FixedOps::name<false>)
+			switch (instruction.opcode)
+			{
+			case MACS:
+				fixed.exec = FX8010_FIXED(macs);
+				break;
+			case MACSN:
+				fixed.exec = FX8010_FIXED(macsn);
+				break;
+			case MACW:
+				fixed.exec = FX8010_FIXED(macw);
+				break;
+			case MACWN:
+				fixed.exec = FX8010_FIXED(macwn);
+				break;
+			case MACINTS:
+				fixed.exec = FX8010_FIXED(macints);
+				break;
+			case MACINTW:
+				fixed.exec = FX8010_FIXED(macintw);
+				break;
+			case ACC3:
+				fixed.exec = FX8010_FIXED(acc3);
+				break;
+			case MACMV:
+				fixed.exec = FX8010_FIXED(macmv);
+				break;
+			case ANDXOR:
+				fixed.exec = FX8010_FIXED(andxor);
+				break;
+			case TSTNEG:
+				fixed.exec = FX8010_FIXED(tstneg);
+				break;
+			case LIMIT:
+				fixed.exec = FX8010_FIXED(limit);
+				break;
+			case LIMITN:
+				fixed.exec = FX8010_FIXED(limitn);
+				break;
+			case LOG:
+				fixed.exec = FX8010_FIXED(log);
+				break;
+			case EXP:
+				fixed.exec = FX8010_FIXED(exp);
+				break;
+			case INTERP:
+				fixed.exec = FX8010_FIXED(interp);
+				break;
+			case SKIP:
+				fixed.exec = FixedOps::skip;
+				break;
+			case IDELAY:
+				fixed.exec = (typeR == READ) ? FixedOps::idelayRead : (typeR == WRITE) ? FixedOps::idelayWrite : FixedOps::nop;
+				break;
+			case XDELAY:
+				fixed.exec = (typeR == READ) ? FixedOps::xdelayRead : (typeR == WRITE) ? FixedOps::xdelayWrite : FixedOps::nop;
+				break;
+			case MOVS:
+				fixed.exec = FX8010_FIXED(movs);
+				break;
+			case ADDS:
+				fixed.exec = FX8010_FIXED(adds);
+				break;
+			case MULS:
+				fixed.exec = FX8010_FIXED(muls);
+				break;
+			case END:
+				fixed.exec = (i + 1 == instructions.size()) ? FixedOps::end : FixedOps::nop;
+				break;
+			default:
+				fixed.exec = FixedOps::nop;
+				break;
+			}
+
+			fixed.handler = fixed.exec;
+			if (instruction.hasNoise)
+			{
+				const GPR &A = registers[instruction.operand2];
+				const GPR &X = registers[instruction.operand3];
+				fixed.N = (A.registerName == "noise") ? fixed.A : (X.registerName == "noise") ? fixed.X : fixed.Y;
+				fixed.handler = FixedOps::noise;
+			}
+
+			fixedInstructions.push_back(fixed);
+		}
+
+		// MAC-Ketten: aufeinanderfolgende MACMV ohne NOISE/CCR Operanden, deren X/Y kein
+		// vorheriges R der Kette lesen. SKIP kann mitten in eine Kette springen, deshalb
+		// behalten die uebrigen Glieder ihren Einzel-Handler.
+		int numChains = 0;
+		for (size_t i = 0; i < fixedInstructions.size();)
+		{
+			auto isLink = [&](size_t k)
+			{
+				const Instruction &instruction = instructions[k];
+				return instruction.opcode == MACMV && !instruction.hasNoise && operandValue[k][1] != 0 && operandValue[k][2] != 0 && operandValue[k][3] != 0 && operandValue[k][4] != 0;
+			};
+			size_t n = 0;
+			while (i + n < fixedInstructions.size() && n < MAX_MAC_CHAIN && isLink(i + n))
+			{
+				const FixedInstruction &link = fixedInstructions[i + n];
+				bool readsChain = false;
+				for (size_t k = 0; k < n; k++)
+					readsChain |= (link.X == fixedInstructions[i + k].R || link.Y == fixedInstructions[i + k].R);
+				if (readsChain)
+					break;
+				n++;
+			}
+			if (n >= 2)
+			{
+				FixedInstruction &head = fixedInstructions[i];
+				head.length = static_cast<int>(n);
+				head.exec = head.handler = fixedInstructions[i + n - 1].writesCCR ? FixedOps::macmvChain<true> : FixedOps::macmvChain<false>;
+				numChains++;
+			}
+			i += std::max<size_t>(n, 1);
+		}
+#undef FX8010_FIXED
+
+		if (DEBUG)
+			cout << "Festkomma: " << fixedInstructions.size() << " Instruktionen, " << integerConstantValues.size() << " Integer-Konstanten, " << numChains << " MAC-Ketten" << endl;
+	}
+
+	// CHECKED
+	void FX8010::syncFromFixed()
+	{
+		// Das Konstantensegment ist read-only und bleibt unveraendert
+		for (int i = 0; i < constantSegmentStart; i++)
+			registerValues[i] = fromFixed(i);
+		for (int i = 0; i <= smallDelayMask; i++)
+			smallDelayBuffer[i] = q31ToFloat(fixedSmallDelay[i]);
+		for (int i = 0; i <= largeDelayMask; i++)
+			largeDelayBuffer[i] = q31ToFloat(fixedLargeDelay[i]);
+		accumulator = static_cast<double>(static_cast<int64_t>(fixedAccumulator >> 31)) / Q31_SCALE;
+		// Festkomma-TRAM freigeben, decodeFixed() legt ihn beim naechsten Umschalten neu an
+		std::vector<int32_t, AlignedAllocator<int32_t, 64>>().swap(fixedSmallDelay);
+		std::vector<int32_t, AlignedAllocator<int32_t, 64>>().swap(fixedLargeDelay);
+	}
+
+	// Ganzer Block in der Festkomma-Engine, Wandlung float <-> Q31 nur an den I/O Registern
+	void FX8010::processBlockFixed(const float *const *inputs, float *const *outputs, int numFrames)
+	{
+		const FixedInstruction *first = fixedInstructions.empty() ? nullptr : fixedInstructions.data();
+		int64_t executed = 0;
+
+		for (int i = 0; i < numFrames; i++)
+		{
+			for (const auto &io : fixedInputs)
+				*io.value = floatToQ31(inputs[io.IOIndex][i]);
+			delayFrame = i;
+
+			const FixedInstruction *ip = first;
+			while (ip != nullptr)
+			{
+				const FixedInstruction *current = ip;
+				ip = ip->handler(*this, ip);
+				executed += current->length;
+				if (PRINT_REGISTERS)
+					printRegisters(current->opcode, q31ToFloat(*current->R), q31ToFloat(*current->A), q31ToFloat(*current->X), q31ToFloat(*current->Y),
+								   static_cast<double>(static_cast<int64_t>(fixedAccumulator >> 31)) / Q31_SCALE);
+			}
+
+			for (const auto &io : fixedOutputs)
+				outputBuffer[io.IOIndex] = q31ToFloat(*io.value);
+			for (int j = 0; j < numChannels; j++)
+				outputs[j][i] = outputBuffer[j];
+		}
+		instructionCounter += static_cast<int>(executed);
+	}
+
+} // namespace Klangraum
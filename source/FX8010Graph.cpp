@@ -0,0 +1,343 @@
+// Copyright 2023 Klangraum
+
+#include "../include/FX8010Graph.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Klangraum
+{
+	namespace
+	{
+		// Lebensdauer eines Arena-Puffers in Ebenen [first, last]
+		struct BufferInterval
+		{
+			int first;
+			int last;
+			size_t *offset;
+		};
+	}
+
+	int FX8010Graph::findNode(const std::string &name)
+	{
+		for (size_t i = 0; i < nodes.size(); i++)
+			if (nodes[i].name == name)
+				return static_cast<int>(i);
+		return -1;
+	}
+
+	// CHECKED
+	int FX8010Graph::addNode(const std::string &name, const std::string &path, int numChannels)
+	{
+		std::unique_ptr<FX8010> program(new FX8010(numChannels));
+		if (!program->loadFile(path))
+		{
+			if (DEBUG)
+				cout << "Graph: " << path << " konnte nicht geladen werden" << endl;
+			return -1;
+		}
+		return addNode(name, std::move(program));
+	}
+
+	// CHECKED
+	int FX8010Graph::addNode(const std::string &name, std::unique_ptr<FX8010> program)
+	{
+		if (!program || findNode(name) != -1)
+			return -1;
+		Node node;
+		node.name = name;
+		node.numChannels = program->getChannels();
+		node.program = std::move(program);
+		node.sources.resize(node.numChannels);
+		nodes.push_back(std::move(node));
+		isPrepared = false;
+		return static_cast<int>(nodes.size()) - 1;
+	}
+
+	FX8010 *FX8010Graph::getNode(const std::string &name)
+	{
+		const int index = findNode(name);
+		return (index < 0) ? nullptr : nodes[index].program.get();
+	}
+
+	bool FX8010Graph::addSource(int node, int input, const Source &source)
+	{
+		if (node < 0 || input < 0 || input >= nodes[node].numChannels)
+			return false;
+		nodes[node].sources[input].push_back(source);
+		isPrepared = false;
+		return true;
+	}
+
+	// CHECKED
+	bool FX8010Graph::connect(const std::string &from, int output, const std::string &to, int input, float gain)
+	{
+		const int source = findNode(from);
+		if (source < 0 || output < 0 || output >= nodes[source].numChannels)
+			return false;
+		return addSource(findNode(to), input, {source, output, gain});
+	}
+
+	bool FX8010Graph::connect(const std::string &from, const std::string &outputRegister, const std::string &to, const std::string &inputRegister, float gain)
+	{
+		FX8010 *source = getNode(from);
+		FX8010 *destination = getNode(to);
+		if (source == nullptr || destination == nullptr)
+			return false;
+		return connect(from, source->getIOIndex(outputRegister), to, destination->getIOIndex(inputRegister), gain);
+	}
+
+	bool FX8010Graph::connectInput(int hostInput, const std::string &to, int input, float gain)
+	{
+		if (hostInput < 0)
+			return false;
+		return addSource(findNode(to), input, {-1, hostInput, gain});
+	}
+
+	bool FX8010Graph::connectOutput(const std::string &from, int output, int hostOutput, float gain)
+	{
+		const int source = findNode(from);
+		if (source < 0 || output < 0 || output >= nodes[source].numChannels || hostOutput < 0)
+			return false;
+		if (static_cast<int>(hostOutputSources.size()) <= hostOutput)
+			hostOutputSources.resize(hostOutput + 1);
+		hostOutputSources[hostOutput].push_back({source, output, gain});
+		isPrepared = false;
+		return true;
+	}
+
+	// CHECKED
+	bool FX8010Graph::prepare(int numHostInputs_, int numHostOutputs_, int maxBlockSize_)
+	{
+		isPrepared = false;
+		numHostInputs = std::max(numHostInputs_, 0);
+		numHostOutputs = std::max(numHostOutputs_, 0);
+		maxBlockSize = std::max(maxBlockSize_, 1);
+		const int numNodes = static_cast<int>(nodes.size());
+
+		// Topologische Sortierung (Kahn), Ebene = laengster Pfad von einem Knoten ohne Vorgaenger
+		std::vector<int> pending(numNodes, 0);
+		std::vector<std::vector<int>> successors(numNodes);
+		for (int n = 0; n < numNodes; n++)
+			for (const auto &input : nodes[n].sources)
+				for (const auto &source : input)
+					if (source.node >= 0)
+					{
+						successors[source.node].push_back(n);
+						pending[n]++;
+					}
+
+		std::vector<int> ready;
+		for (int n = 0; n < numNodes; n++)
+		{
+			nodes[n].level = 0;
+			if (pending[n] == 0)
+				ready.push_back(n);
+		}
+		int numSorted = 0;
+		while (!ready.empty())
+		{
+			const int n = ready.back();
+			ready.pop_back();
+			numSorted++;
+			for (const int s : successors[n])
+			{
+				nodes[s].level = std::max(nodes[s].level, nodes[n].level + 1);
+				if (--pending[s] == 0)
+					ready.push_back(s);
+			}
+		}
+		if (numSorted < numNodes)
+		{
+			if (DEBUG)
+				cout << "Graph: Zyklus, " << numNodes - numSorted << " Knoten ohne Reihenfolge" << endl;
+			return false;
+		}
+
+		levels.clear();
+		for (int n = 0; n < numNodes; n++)
+		{
+			if (static_cast<int>(levels.size()) <= nodes[n].level)
+				levels.resize(nodes[n].level + 1);
+			levels[nodes[n].level].push_back(n);
+		}
+		const int numLevels = static_cast<int>(levels.size());
+
+		// Letzte Ebene, die einen Ausgang liest. Die Hostausgaenge werden nach allen Ebenen gemischt.
+		std::vector<std::vector<int>> lastUse(numNodes);
+		for (int n = 0; n < numNodes; n++)
+		{
+			nodes[n].outputOffset.assign(nodes[n].numChannels, 0);
+			nodes[n].inputOffset.assign(nodes[n].numChannels, 0);
+			nodes[n].inputMode.assign(nodes[n].numChannels, INPUT_SILENCE);
+			lastUse[n].assign(nodes[n].numChannels, nodes[n].level);
+		}
+		for (int n = 0; n < numNodes; n++)
+			for (const auto &input : nodes[n].sources)
+				for (const auto &source : input)
+					if (source.node >= 0)
+						lastUse[source.node][source.channel] = std::max(lastUse[source.node][source.channel], nodes[n].level);
+		for (const auto &output : hostOutputSources)
+			for (const auto &source : output)
+				lastUse[source.node][source.channel] = numLevels;
+
+		// Eingaenge aufloesen: nur Summen und Gains brauchen einen eigenen Puffer
+		std::vector<BufferInterval> intervals;
+		for (int n = 0; n < numNodes; n++)
+		{
+			Node &node = nodes[n];
+			for (int c = 0; c < node.numChannels; c++)
+			{
+				intervals.push_back({node.level, lastUse[n][c], &node.outputOffset[c]});
+
+				const auto &input = node.sources[c];
+				if (input.empty())
+					node.inputMode[c] = INPUT_SILENCE;
+				else if (input.size() == 1 && input[0].gain == 1.0f)
+					node.inputMode[c] = (input[0].node >= 0) ? INPUT_NODE : INPUT_HOST;
+				else
+				{
+					node.inputMode[c] = INPUT_MIX;
+					intervals.push_back({node.level, node.level, &node.inputOffset[c]});
+				}
+			}
+		}
+
+		// Greedy: Puffer in der Reihenfolge ihres Beginns, ein Slot ist frei, wenn sein letzter Nutzer
+		// in einer frueheren Ebene liegt
+		stride = (static_cast<size_t>(maxBlockSize) + 15) & ~static_cast<size_t>(15);
+		std::stable_sort(intervals.begin(), intervals.end(), [](const BufferInterval &a, const BufferInterval &b)
+						 { return a.first < b.first; });
+		std::vector<int> slotEnd;
+		for (const auto &interval : intervals)
+		{
+			size_t slot = 0;
+			while (slot < slotEnd.size() && slotEnd[slot] >= interval.first)
+				slot++;
+			if (slot == slotEnd.size())
+				slotEnd.push_back(interval.last);
+			else
+				slotEnd[slot] = interval.last;
+			*interval.offset = slot * stride;
+		}
+		arena.assign(slotEnd.size() * stride, 0.0f);
+		silence.assign(stride, 0.0f);
+
+		// Feste Pointer, Hosteingaenge werden je Block gesetzt
+		for (auto &node : nodes)
+		{
+			node.inputs.assign(node.numChannels, silence.data());
+			node.outputs.resize(node.numChannels);
+			for (int c = 0; c < node.numChannels; c++)
+			{
+				node.outputs[c] = arena.data() + node.outputOffset[c];
+				if (node.inputMode[c] == INPUT_NODE)
+				{
+					const Source &source = node.sources[c][0];
+					node.inputOffset[c] = nodes[source.node].outputOffset[source.channel];
+					node.inputs[c] = arena.data() + node.inputOffset[c];
+				}
+				else if (node.inputMode[c] == INPUT_MIX)
+					node.inputs[c] = arena.data() + node.inputOffset[c];
+			}
+		}
+
+		if (DEBUG)
+			cout << "Graph: " << numNodes << " Knoten, " << numLevels << " Ebenen, " << slotEnd.size() << " Puffer (" << intervals.size() << " ohne Wiederverwendung)" << endl;
+
+		isPrepared = true;
+		return true;
+	}
+
+	void FX8010Graph::runNode(int n, const float *const *hostInputs, int offset, int numFrames)
+	{
+		Node &node = nodes[n];
+		for (int c = 0; c < node.numChannels; c++)
+		{
+			if (node.inputMode[c] == INPUT_HOST)
+			{
+				const int channel = node.sources[c][0].channel;
+				node.inputs[c] = (channel < numHostInputs) ? hostInputs[channel] + offset : silence.data();
+			}
+			else if (node.inputMode[c] == INPUT_MIX)
+			{
+				float *mix = arena.data() + node.inputOffset[c];
+				std::fill(mix, mix + numFrames, 0.0f);
+				for (const auto &source : node.sources[c])
+				{
+					const float *x;
+					if (source.node >= 0)
+						x = arena.data() + nodes[source.node].outputOffset[source.channel];
+					else if (source.channel < numHostInputs)
+						x = hostInputs[source.channel] + offset;
+					else
+						continue;
+					for (int i = 0; i < numFrames; i++)
+						mix[i] += source.gain * x[i];
+				}
+			}
+		}
+		node.program->processBlock(node.inputs.data(), node.outputs.data(), numFrames);
+	}
+
+	void FX8010Graph::runNodeTask(void *context, int index)
+	{
+		FX8010Graph &graph = *static_cast<FX8010Graph *>(context);
+		graph.runNode(graph.levels[graph.currentLevel][index], graph.currentInputs, graph.currentOffset, graph.currentFrames);
+	}
+
+	void FX8010Graph::runLevel(int level, const float *const *hostInputs, int offset, int numFrames)
+	{
+		if (!pool)
+		{
+			for (const int n : levels[level])
+				runNode(n, hostInputs, offset, numFrames);
+			return;
+		}
+		currentLevel = level;
+		currentOffset = offset;
+		currentFrames = numFrames;
+		currentInputs = hostInputs;
+		pool->run(static_cast<int>(levels[level].size()), &FX8010Graph::runNodeTask, this);
+	}
+
+	// CHECKED
+	void FX8010Graph::setNumThreads(int numThreads)
+	{
+		pool.reset(numThreads > 0 ? new FX8010ThreadPool(numThreads) : nullptr);
+	}
+
+	// CHECKED
+	void FX8010Graph::processBlock(const float *const *inputs, float *const *outputs, int numFrames)
+	{
+		if (!isPrepared)
+		{
+			for (int c = 0; c < numHostOutputs; c++)
+				std::fill(outputs[c], outputs[c] + numFrames, 0.0f);
+			return;
+		}
+
+		for (int offset = 0; offset < numFrames; offset += maxBlockSize)
+		{
+			const int chunk = std::min(maxBlockSize, numFrames - offset);
+			for (int level = 0; level < static_cast<int>(levels.size()); level++)
+				runLevel(level, inputs, offset, chunk);
+
+			// Hostausgaenge aus den Knotenausgaengen mischen
+			for (int c = 0; c < numHostOutputs; c++)
+			{
+				float *y = outputs[c] + offset;
+				std::fill(y, y + chunk, 0.0f);
+				if (c >= static_cast<int>(hostOutputSources.size()))
+					continue;
+				for (const auto &source : hostOutputSources[c])
+				{
+					const float *x = arena.data() + nodes[source.node].outputOffset[source.channel];
+					for (int i = 0; i < chunk; i++)
+						y[i] += source.gain * x[i];
+				}
+			}
+		}
+	}
+
+} // namespace Klangraum
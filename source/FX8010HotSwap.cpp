@@ -0,0 +1,403 @@
+// Copyright 2023 Klangraum
+
+#include "../include/FX8010HotSwap.h"
+
+#include <chrono>
+#include <iterator>
+
+namespace Klangraum
+{
+	namespace
+	{
+		// ms, so oft holt der Compile-Thread ausgediente Programme ab
+		const int RETIRE_INTERVAL = 10;
+
+		// Delayline-Inhalt nach Alter kopieren: das Sample, das eine Leseadresse d im naechsten
+		// Samplezyklus liefert, liegt bei (Position - d) & Maske. Adressen 0..count-1 liefern danach
+		// dasselbe wie im alten Programm.
+		template <typename Source, typename Target, typename Convert>
+		void copyDelayHistory(const Source *source, int sourceMask, int sourcePosition, Target *target, int targetMask, int targetPosition, int count, Convert convert)
+		{
+			for (int d = 0; d < count; d++)
+				target[(targetPosition - d) & targetMask] = convert(source[(sourcePosition - d) & sourceMask]);
+		}
+	}
+
+	// FX8010: Zustand uebernehmen
+	//--------------------------------------------------------------------------------
+
+	// CHECKED
+	void FX8010::migrateStateFrom(FX8010 &previous, const std::vector<std::pair<int, int>> &registerMap)
+	{
+		for (const auto &entry : registerMap)
+		{
+			const float value = previous.getRegisterValue(entry.first);
+			// Laeuft im alten Programm eine Glaettung, gilt deren Ziel
+			float target = value;
+			if (!previous.smootherOf.empty() && previous.smootherOf[entry.first] >= 0 && previous.smootherOf[entry.first] < previous.numActiveSmoothers)
+				target = previous.smootherTarget[previous.smootherOf[entry.first]];
+
+			if (!smootherOf.empty() && smootherOf[entry.second] >= 0)
+			{
+				const int k = smootherOf[entry.second];
+				smootherCurrent[k] = smootherTarget[k] = value;
+				storeRegisterValue(entry.second, value);
+				if (target != value)
+					setSmoothingTarget(k, target);
+			}
+			else if (engineType == ENGINE_FIXED && isReady && previous.engineType == ENGINE_FIXED && previous.isReady && fixedIsInteger[entry.second] == previous.fixedIsInteger[entry.first])
+			{
+				// Festkomma direkt, ohne Rundung ueber float
+				registerValues[entry.second] = target;
+				fixedValues[entry.second] = previous.fixedValues[entry.first];
+			}
+			else
+				storeRegisterValue(entry.second, target);
+		}
+
+		migrateDelayLine(previous, false);
+		migrateDelayLine(previous, true);
+		sampleTime.store(previous.getSampleTime(), std::memory_order_relaxed);
+		// NOISE laeuft mit derselben Folge weiter
+		g_x1 = previous.g_x1;
+		g_x2 = previous.g_x2;
+	}
+
+	void FX8010::migrateDelayLine(FX8010 &previous, bool isLarge)
+	{
+		const int previousMask = isLarge ? previous.largeDelayMask : previous.smallDelayMask;
+		const int previousPosition = isLarge ? previous.largeDelayPos : previous.smallDelayPos;
+		const int mask = isLarge ? largeDelayMask : smallDelayMask;
+		const int position = isLarge ? largeDelayPos : smallDelayPos;
+		const int count = std::min(previousMask, mask) + 1;
+
+		// Die Festkomma-Engine haelt die Delaylines in eigenen Puffern
+		if (previous.engineType == ENGINE_FIXED && previous.isReady)
+		{
+			const int32_t *source = isLarge ? previous.fixedLargeDelay.data() : previous.fixedSmallDelay.data();
+			if (engineType == ENGINE_FIXED && isReady)
+				copyDelayHistory(source, previousMask, previousPosition, isLarge ? fixedLargeDelay.data() : fixedSmallDelay.data(), mask, position, count, [](int32_t x)
+								 { return x; });
+			else
+				copyDelayHistory(source, previousMask, previousPosition, isLarge ? largeDelayBuffer.data() : smallDelayBuffer.data(), mask, position, count, q31ToFloat);
+		}
+		else
+		{
+			const float *source = isLarge ? previous.largeDelayBuffer.data() : previous.smallDelayBuffer.data();
+			if (engineType == ENGINE_FIXED && isReady)
+				copyDelayHistory(source, previousMask, previousPosition, isLarge ? fixedLargeDelay.data() : fixedSmallDelay.data(), mask, position, count, floatToQ31);
+			else
+				copyDelayHistory(source, previousMask, previousPosition, isLarge ? largeDelayBuffer.data() : smallDelayBuffer.data(), mask, position, count, [](float x)
+								 { return x; });
+		}
+	}
+
+	// FX8010HotSwap
+	//--------------------------------------------------------------------------------
+
+	FX8010HotSwap::FX8010HotSwap(int numChannels_) : numChannels(numChannels_)
+	{
+		fadeBuffer.assign(static_cast<size_t>(numChannels) * CROSSFADE_CHUNK, 0.0f);
+		fadeOutputs.resize(numChannels);
+		for (int c = 0; c < numChannels; c++)
+			fadeOutputs[c] = fadeBuffer.data() + c * CROSSFADE_CHUNK;
+		chunkInputs.resize(numChannels);
+		chunkOutputs.resize(numChannels);
+		worker = std::thread(&FX8010HotSwap::workerLoop, this);
+	}
+
+	FX8010HotSwap::~FX8010HotSwap()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopWorker = true;
+		}
+		workerSignal.notify_one();
+		worker.join();
+		// Audio-Thread laeuft nicht mehr, jede Generation liegt in genau einem Slot
+		delete pending.load();
+		delete retired.load();
+		delete fading;
+		delete active;
+	}
+
+	void FX8010HotSwap::setHostSampleRate(int sampleRate)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		hostSampleRate = sampleRate;
+	}
+
+	void FX8010HotSwap::setEngineType(FX8010::EngineType type)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		engineType = type;
+	}
+
+	void FX8010HotSwap::setOptimizerEnabled(bool enabled)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		optimizerEnabled = enabled;
+	}
+
+	int FX8010HotSwap::compile(const std::string &source)
+	{
+		int number;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			// Ein noch nicht begonnener Auftrag wird ersetzt
+			requestedSource = source;
+			requestWaiting = true;
+			number = ++requestedNumber;
+		}
+		workerSignal.notify_one();
+		return number;
+	}
+
+	int FX8010HotSwap::compileFile(const std::string &path)
+	{
+		ifstream file(path);
+		if (!file)
+		{
+			if (DEBUG)
+				cout << colorMap[COLOR_RED] << "Fehler beim Oeffnen der Datei." << colorMap[COLOR_NULL] << endl;
+			return -1;
+		}
+		return compile(std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>()));
+	}
+
+	FX8010HotSwap::CompileResult FX8010HotSwap::getLastResult()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return lastResult;
+	}
+
+	bool FX8010HotSwap::waitForCompile(int request, int timeoutMilliseconds)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		return resultSignal.wait_for(lock, std::chrono::milliseconds(timeoutMilliseconds), [this, request]
+									 { return compiledNumber >= request; });
+	}
+
+	// CHECKED
+	bool FX8010HotSwap::setRegisterValue(const std::string &registerName, float value, int64_t sampleTime)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (newest == nullptr)
+			return false;
+		// Das neueste Programm und, solange es noch nicht laeuft, sein Vorgaenger (Lebensdauer: mutex)
+		bool sent = false;
+		Generation *targets[2] = {newest, newest->activated.load(std::memory_order_acquire) ? nullptr : newest->base};
+		for (Generation *generation : targets)
+		{
+			if (generation == nullptr)
+				continue;
+			const int handle = generation->program->getRegisterHandle(registerName);
+			if (handle >= 0 && generation->program->pushParameterEvent(handle, value, sampleTime))
+				sent = true;
+		}
+		return sent;
+	}
+
+	void FX8010HotSwap::workerLoop()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (!stopWorker)
+		{
+			// Ohne Auftrag regelmaessig aufwachen und ausgediente Programme freigeben
+			workerSignal.wait_for(lock, std::chrono::milliseconds(RETIRE_INTERVAL), [this]
+								  { return stopWorker || requestWaiting; });
+			collectRetired();
+			if (stopWorker || !requestWaiting)
+				continue;
+
+			const std::string source = std::move(requestedSource);
+			const int number = requestedNumber;
+			const int sampleRate = hostSampleRate;
+			const FX8010::EngineType type = engineType;
+			const bool optimize = optimizerEnabled;
+			requestWaiting = false;
+
+			// Uebersetzen ohne Lock, compile() und setRegisterValue() bleiben ansprechbar
+			lock.unlock();
+			CompileResult result;
+			result.request = number;
+			std::unique_ptr<FX8010> program = build(source, sampleRate, type, optimize, result);
+			lock.lock();
+
+			if (program)
+				publish(std::move(program));
+			lastResult = std::move(result);
+			compiledNumber = number;
+			resultSignal.notify_all();
+		}
+	}
+
+	std::unique_ptr<FX8010> FX8010HotSwap::build(const std::string &source, int sampleRate, FX8010::EngineType type, bool optimize, CompileResult &result)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		std::unique_ptr<FX8010> program(new FX8010(numChannels));
+		program->setHostSampleRate(sampleRate);
+		program->setOptimizerEnabled(optimize);
+		// Vor dem Laden nur gemerkt, loadFromString() uebersetzt fuer diese Engine
+		program->setEngineType(type);
+		result.success = program->loadFromString(source);
+		result.errors = program->getErrorList();
+		auto end = std::chrono::high_resolution_clock::now();
+		result.milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+		if (DEBUG)
+			cout << "HotSwap: Auftrag " << result.request << (result.success ? " uebersetzt (" : " fehlerhaft (") << result.milliseconds << " ms)" << endl;
+		if (!result.success)
+			return nullptr;
+		return program;
+	}
+
+	// CHECKED
+	void FX8010HotSwap::publish(std::unique_ptr<FX8010> program)
+	{
+		Generation *generation = new Generation;
+		generation->program = std::move(program);
+
+		// Noch nicht uebernommenes Programm zurueckholen und ersetzen, es hat denselben Vorgaenger
+		Generation *unclaimed = pending.exchange(nullptr, std::memory_order_acq_rel);
+		if (unclaimed != nullptr)
+		{
+			generation->base = unclaimed->base;
+			delete unclaimed;
+		}
+		else
+			generation->base = newest;
+
+		if (generation->base != nullptr)
+			mapRegisters(*generation);
+		newest = generation;
+		pending.store(generation, std::memory_order_release);
+	}
+
+	void FX8010HotSwap::collectRetired()
+	{
+		Generation *generation = retired.exchange(nullptr, std::memory_order_acq_rel);
+		if (generation == nullptr)
+			return;
+		if (newest != nullptr && newest->base == generation)
+			newest->base = nullptr;
+		delete generation;
+	}
+
+	// CHECKED
+	// Gleichnamige STATIC/CONTROL Register (beschreibbar, kein Literal), bei gleichen Namen gilt das erste
+	void FX8010HotSwap::mapRegisters(Generation &generation)
+	{
+		const FX8010 &previous = *generation.base->program;
+		const FX8010 &program = *generation.program;
+		auto isState = [](const FX8010 &dsp, const FX8010::GPR &reg)
+		{
+			return (reg.registerType == FX8010::STATIC || reg.registerType == FX8010::CONTROL) && !reg.isLiteral && reg.valueIndex >= 0 && reg.valueIndex < dsp.constantSegmentStart;
+		};
+
+		std::unordered_map<std::string, int> previousHandles;
+		for (const auto &reg : previous.registers)
+		{
+			if (isState(previous, reg))
+				previousHandles.emplace(reg.registerName, reg.valueIndex);
+		}
+
+		std::vector<bool> mapped(program.registerValues.size(), false);
+		for (const auto &reg : program.registers)
+		{
+			if (!isState(program, reg) || mapped[reg.valueIndex])
+				continue;
+			auto it = previousHandles.find(reg.registerName);
+			if (it == previousHandles.end())
+				continue;
+			mapped[reg.valueIndex] = true;
+			generation.registerMap.emplace_back(it->second, reg.valueIndex);
+		}
+		if (DEBUG)
+			cout << "HotSwap: " << generation.registerMap.size() << " Register werden uebernommen" << endl;
+	}
+
+	// CHECKED
+	void FX8010HotSwap::processBlock(const float *const *inputs, float *const *outputs, int numFrames)
+	{
+		// Neues Programm nur uebernehmen, wenn keine Ueberblendung laeuft und der Retired-Slot frei ist
+		if (fading == nullptr && retired.load(std::memory_order_acquire) == nullptr && pending.load(std::memory_order_relaxed) != nullptr)
+		{
+			Generation *next = pending.exchange(nullptr, std::memory_order_acq_rel);
+			if (next != nullptr)
+			{
+				if (active != nullptr && next->base == active)
+					next->program->migrateStateFrom(*active->program, next->registerMap);
+				next->activated.store(true, std::memory_order_release);
+
+				const int length = crossfadeSamples.load(std::memory_order_relaxed);
+				if (active != nullptr && length > 0)
+				{
+					fading = active;
+					fadePosition = 0;
+					fadeLength = length;
+				}
+				else if (active != nullptr)
+					retired.store(active, std::memory_order_release);
+				active = next;
+				swapCount.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		if (active == nullptr)
+		{
+			for (int c = 0; c < numChannels; c++)
+				std::fill(outputs[c], outputs[c] + numFrames, 0.0f);
+			return;
+		}
+		if (fading != nullptr)
+			processCrossfade(inputs, outputs, numFrames);
+		else
+			active->program->processBlock(inputs, outputs, numFrames);
+	}
+
+	void FX8010HotSwap::processCrossfade(const float *const *inputs, float *const *outputs, int numFrames)
+	{
+		int done = 0;
+		while (done < numFrames)
+		{
+			// Waehrend der Ueberblendung in Stuecken von CROSSFADE_CHUNK (Puffer fuer das alte Programm)
+			const int n = (fading != nullptr && numFrames - done > CROSSFADE_CHUNK) ? CROSSFADE_CHUNK : numFrames - done;
+			for (int c = 0; c < numChannels; c++)
+			{
+				chunkInputs[c] = inputs[c] + done;
+				chunkOutputs[c] = outputs[c] + done;
+			}
+
+			if (fading == nullptr)
+			{
+				active->program->processBlock(chunkInputs.data(), chunkOutputs.data(), n);
+				break;
+			}
+
+			// Altes Programm zuerst, falls Ein- und Ausgaenge dieselben Puffer sind
+			fading->program->processBlock(chunkInputs.data(), fadeOutputs.data(), n);
+			active->program->processBlock(chunkInputs.data(), chunkOutputs.data(), n);
+
+			// Linear (beide Programme sind meist korreliert)
+			const float step = 1.0f / fadeLength;
+			for (int c = 0; c < numChannels; c++)
+			{
+				float *out = chunkOutputs[c];
+				const float *old = fadeOutputs[c];
+				for (int i = 0; i < n; i++)
+				{
+					const float gain = std::min((fadePosition + i + 1) * step, 1.0f);
+					out[i] = old[i] + gain * (out[i] - old[i]);
+				}
+			}
+			fadePosition += n;
+			if (fadePosition >= fadeLength)
+			{
+				retired.store(fading, std::memory_order_release);
+				fading = nullptr;
+			}
+			done += n;
+		}
+	}
+
+} // namespace Klangraum
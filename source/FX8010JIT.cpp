@@ -0,0 +1,948 @@
+// Copyright 2023 Klangraum
+
+#include "../include/FX8010.h"
+#include "../include/helpers.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if FX8010_JIT_SUPPORTED
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#endif
+
+namespace Klangraum
+{
+	// Ausfuehrbarer Speicher
+	//--------------------------------------------------------------------------------
+
+	bool ExecutableMemory::assign(const std::vector<uint8_t> &code)
+	{
+		release();
+#if FX8010_JIT_SUPPORTED
+		if (code.empty())
+			return false;
+#ifdef _WIN32
+		void *block = VirtualAlloc(nullptr, code.size(), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+		if (block == nullptr)
+			return false;
+		memcpy(block, code.data(), code.size());
+		DWORD oldProtect;
+		if (!VirtualProtect(block, code.size(), PAGE_EXECUTE_READ, &oldProtect))
+		{
+			VirtualFree(block, 0, MEM_RELEASE);
+			return false;
+		}
+		FlushInstructionCache(GetCurrentProcess(), block, code.size());
+#else
+		void *block = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (block == MAP_FAILED)
+			return false;
+		memcpy(block, code.data(), code.size());
+		// W^X: erst nach dem Kopieren ausfuehrbar machen
+		if (mprotect(block, code.size(), PROT_READ | PROT_EXEC) != 0)
+		{
+			munmap(block, code.size());
+			return false;
+		}
+#endif
+		memory = block;
+		size = code.size();
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void ExecutableMemory::release()
+	{
+#if FX8010_JIT_SUPPORTED
+		if (memory != nullptr)
+		{
+#ifdef _WIN32
+			VirtualFree(memory, 0, MEM_RELEASE);
+#else
+			munmap(memory, size);
+#endif
+		}
+#endif
+		memory = nullptr;
+		size = 0;
+	}
+
+	// Assembler
+	//--------------------------------------------------------------------------------
+
+	void X86Emitter::emit32(uint32_t value)
+	{
+		for (int i = 0; i < 4; i++)
+			emit8(static_cast<uint8_t>(value >> (8 * i)));
+	}
+
+	void X86Emitter::emit64(uint64_t value)
+	{
+		for (int i = 0; i < 8; i++)
+			emit8(static_cast<uint8_t>(value >> (8 * i)));
+	}
+
+	// REX Praefix, nur wenn noetig (W: 64 Bit, R: reg >= 8, B: rm/base >= 8)
+	void X86Emitter::rex(bool w, int reg, int rm)
+	{
+		uint8_t value = 0x40 | (w ? 0x08 : 0) | ((reg & 8) ? 0x04 : 0) | ((rm & 8) ? 0x01 : 0);
+		if (value != 0x40)
+			emit8(value);
+	}
+
+	// ModRM (+SIB/Displacement) fuer Register, [base + disp32] oder RIP-relative Konstante
+	void X86Emitter::modrm(int reg, const Operand &rm)
+	{
+		switch (rm.kind)
+		{
+		case Operand::XMM:
+			emit8(0xc0 | ((reg & 7) << 3) | (rm.reg & 7));
+			break;
+		case Operand::MEMORY:
+			emit8(0x80 | ((reg & 7) << 3) | (rm.reg & 7));
+			// RSP/R12 als Basis benoetigen ein SIB Byte
+			if ((rm.reg & 7) == RSP)
+				emit8(0x24);
+			emit32(static_cast<uint32_t>(rm.disp));
+			break;
+		case Operand::CONSTANT:
+			emit8(0x05 | ((reg & 7) << 3));
+			constantFixups.push_back({code.size(), rm.disp});
+			emit32(0);
+			break;
+		}
+	}
+
+	X86Emitter::Operand X86Emitter::addConstant(const void *data, size_t bytes)
+	{
+		// Gleiche Konstanten nur einmal ablegen
+		for (size_t offset = 0; offset + bytes <= constantPool.size(); offset += 8)
+		{
+			if (memcmp(&constantPool[offset], data, bytes) == 0)
+				return {Operand::CONSTANT, 0, static_cast<int32_t>(offset)};
+		}
+		const size_t offset = constantPool.size();
+		constantPool.resize(offset + 8, 0); // 8 Byte Raster, passt fuer float und double
+		memcpy(&constantPool[offset], data, bytes);
+		return {Operand::CONSTANT, 0, static_cast<int32_t>(offset)};
+	}
+
+	X86Emitter::Operand X86Emitter::constantFloat(float value)
+	{
+		return addConstant(&value, sizeof(value));
+	}
+
+	X86Emitter::Operand X86Emitter::constantDouble(double value)
+	{
+		return addConstant(&value, sizeof(value));
+	}
+
+	int X86Emitter::newLabel()
+	{
+		labelPositions.push_back(-1);
+		return static_cast<int>(labelPositions.size()) - 1;
+	}
+
+	void X86Emitter::bind(int label)
+	{
+		labelPositions[label] = static_cast<int>(code.size());
+	}
+
+	void X86Emitter::jmp(int label)
+	{
+		emit8(0xe9);
+		labelFixups.push_back({code.size(), label});
+		emit32(0);
+	}
+
+	void X86Emitter::jcc(Condition condition, int label)
+	{
+		emit8(0x0f);
+		emit8(0x80 | condition);
+		labelFixups.push_back({code.size(), label});
+		emit32(0);
+	}
+
+	void X86Emitter::sse(SSEPrefix prefix, SSEOp op, int reg, const Operand &rm)
+	{
+		if (prefix != PREFIX_NONE)
+			emit8(prefix);
+		rex(false, reg, rm.kind == Operand::CONSTANT ? 0 : rm.reg);
+		emit8(0x0f);
+		emit8(op);
+		modrm(reg, rm);
+	}
+
+	void X86Emitter::sseStore(SSEPrefix prefix, const Operand &rm, int reg)
+	{
+		sse(prefix, SSE_MOVS_STORE, reg, rm);
+	}
+
+	void X86Emitter::push(int reg)
+	{
+		rex(false, 0, reg);
+		emit8(0x50 | (reg & 7));
+	}
+
+	void X86Emitter::pop(int reg)
+	{
+		rex(false, 0, reg);
+		emit8(0x58 | (reg & 7));
+	}
+
+	void X86Emitter::movRegReg64(int dst, int src)
+	{
+		rex(true, src, dst);
+		emit8(0x89);
+		modrm(src, xmm(dst));
+	}
+
+	void X86Emitter::movRegMem64(int dst, int base, int32_t disp)
+	{
+		rex(true, dst, base);
+		emit8(0x8b);
+		modrm(dst, mem(base, disp));
+	}
+
+	void X86Emitter::movMemReg64(int base, int32_t disp, int src)
+	{
+		rex(true, src, base);
+		emit8(0x89);
+		modrm(src, mem(base, disp));
+	}
+
+	void X86Emitter::movImm64(int dst, uint64_t imm)
+	{
+		rex(true, 0, dst);
+		emit8(0xb8 | (dst & 7));
+		emit64(imm);
+	}
+
+	void X86Emitter::movImm32(int dst, int32_t imm)
+	{
+		rex(false, 0, dst);
+		emit8(0xb8 | (dst & 7));
+		emit32(static_cast<uint32_t>(imm));
+	}
+
+	void X86Emitter::movsxd(int dst, int src)
+	{
+		rex(true, dst, src);
+		emit8(0x63);
+		modrm(dst, xmm(src));
+	}
+
+	void X86Emitter::xorReg32(int dst, int src)
+	{
+		rex(false, src, dst);
+		emit8(0x31);
+		modrm(src, xmm(dst));
+	}
+
+	void X86Emitter::addRegReg64(int dst, int src)
+	{
+		rex(true, src, dst);
+		emit8(0x01);
+		modrm(src, xmm(dst));
+	}
+
+	void X86Emitter::addImm64(int dst, int32_t imm)
+	{
+		rex(true, 0, dst);
+		emit8(0x81);
+		modrm(0, xmm(dst));
+		emit32(static_cast<uint32_t>(imm));
+	}
+
+	void X86Emitter::subImm64(int dst, int32_t imm)
+	{
+		rex(true, 0, dst);
+		emit8(0x81);
+		modrm(5, xmm(dst));
+		emit32(static_cast<uint32_t>(imm));
+	}
+
+	void X86Emitter::cmpRegReg64(int a, int b)
+	{
+		rex(true, b, a);
+		emit8(0x39);
+		modrm(b, xmm(a));
+	}
+
+	void X86Emitter::testRegReg64(int a, int b)
+	{
+		rex(true, b, a);
+		emit8(0x85);
+		modrm(b, xmm(a));
+	}
+
+	void X86Emitter::shlImm64(int dst, uint8_t imm)
+	{
+		rex(true, 0, dst);
+		emit8(0xc1);
+		modrm(4, xmm(dst));
+		emit8(imm);
+	}
+
+	void X86Emitter::callReg(int reg)
+	{
+		rex(false, 0, reg);
+		emit8(0xff);
+		modrm(2, xmm(reg));
+	}
+
+	void X86Emitter::ret()
+	{
+		emit8(0xc3);
+	}
+
+	bool X86Emitter::finalize(std::vector<uint8_t> &out)
+	{
+		// Sprungziele eintragen (rel32 relativ zum Ende des Befehls)
+		for (const auto &fixup : labelFixups)
+		{
+			const int target = labelPositions[fixup.second];
+			if (target < 0)
+				return false; // Label nie gebunden
+			const int32_t rel = target - static_cast<int32_t>(fixup.first + 4);
+			memcpy(&code[fixup.first], &rel, 4);
+		}
+
+		// Konstantenpool 16 Byte aligned hinter den Code
+		out = code;
+		while (out.size() % 16 != 0)
+			out.push_back(0xcc); // int3
+		const size_t poolStart = out.size();
+		out.insert(out.end(), constantPool.begin(), constantPool.end());
+
+		for (const auto &fixup : constantFixups)
+		{
+			const int32_t rel = static_cast<int32_t>(poolStart + fixup.second) - static_cast<int32_t>(fixup.first + 4);
+			memcpy(&out[fixup.first], &rel, 4);
+		}
+		return true;
+	}
+
+	// JIT Compiler
+	//--------------------------------------------------------------------------------
+	// Uebersetzt die Instruktionsliste in eine Funktion, die einen ganzen Block verarbeitet.
+	// - Die am haeufigsten benutzten beschriebenen GPR (und CCR) liegen ueber den ganzen
+	//   Sample-Loop in XMM Registern, alle anderen werden direkt im Speicher adressiert.
+	// - SKIP wird zu echten Spruengen (die Sprungweite Y muss dafuer konstant sein).
+	// - LOG, EXP, ANDXOR, TSTNEG, Delaylines und NOISE rufen die Handler des dekodierten
+	//   Interpreters auf. Vor dem Aufruf werden die XMM Register in den Speicher geschrieben.
+	// - CCR und Akkumulator werden nur berechnet, wenn das Programm sie auch liest.
+	// Registerbelegung: RBX = Kontext, RBP = &accumulator, R12 = Frame-Offset (Bytes),
+	// R13 = Ende-Offset, R14 = Instruktionszaehler, R15 = Basis der Registerwerte.
+
+	namespace
+	{
+		typedef X86Emitter X;
+
+#ifdef _WIN32
+		const int ARG0 = X::RCX;
+		const int ARG1 = X::RDX;
+		// XMM6-15 sind nicht-fluechtig, bleiben ueber Helper-Aufrufe erhalten
+		const int FIRST_PINNED_XMM = 6;
+		const bool CALL_CLOBBERS_PINNED = false;
+		const int STACK_RESERVE = 8 + 32 + 10 * 16; // Alignment + Shadow Space + XMM6-15
+#else
+		const int ARG0 = X::RDI;
+		const int ARG1 = X::RSI;
+		// System V: alle XMM Register sind fluechtig
+		const int FIRST_PINNED_XMM = 4;
+		const bool CALL_CLOBBERS_PINNED = true;
+		const int STACK_RESERVE = 8; // Alignment
+#endif
+		const int NUM_PINNED_XMM = 16 - FIRST_PINNED_XMM;
+	}
+
+	bool FX8010::compileJIT()
+	{
+		jitFunction = nullptr;
+		jitMemory.release();
+
+#if !FX8010_JIT_SUPPORTED
+		return false;
+#else
+		// Der erzeugte Code rechnet wie der Referenz-Interpreter (float, double Akkumulator)
+		if (precision != PRECISION_REFERENCE)
+			return false;
+
+		const int numInstructions = static_cast<int>(instructions.size());
+		if (numInstructions == 0 || decodedInstructions.size() != instructions.size())
+			return false;
+
+		const int numRegisters = static_cast<int>(registers.size());
+		// Byte-Offset eines Registerwerts relativ zu R15
+		auto offsetOf = [&](int index)
+		{
+			return static_cast<int32_t>(registers[index].valueIndex * sizeof(float));
+		};
+
+		// Analyse
+		//----------------------------------------------------------------
+		// Welche Register werden beschrieben? Welche Instruktionen laufen ueber Helper?
+		std::vector<bool> isWritten(numRegisters, false);
+		std::vector<bool> usesHelper(numInstructions, false);
+		const bool ccrUsed = programReadsCCR();
+		bool accumulatorUsed = false;
+
+		for (int i = 0; i < numInstructions; i++)
+		{
+			const Instruction &instruction = instructions[i];
+			switch (instruction.opcode)
+			{
+			case SKIP:
+				break;
+			case IDELAY:
+			case XDELAY:
+				usesHelper[i] = true;
+				if (registers[instruction.operand1].registerType == READ)
+					isWritten[instruction.operand2] = true;
+				break;
+			case END:
+				break;
+			case LOG:
+			case EXP:
+			case ANDXOR:
+			case TSTNEG:
+				usesHelper[i] = true;
+				isWritten[instruction.operand1] = true;
+				break;
+			case MACMV:
+				accumulatorUsed = true;
+				isWritten[instruction.operand1] = true;
+				break;
+			default:
+				isWritten[instruction.operand1] = true;
+				break;
+			}
+			if (instruction.hasNoise)
+				usesHelper[i] = true;
+		}
+		// NOISE Register werden vom Helper beschrieben
+		for (int i = 0; i < numRegisters; i++)
+		{
+			if (registers[i].registerName == "noise")
+				isWritten[i] = true;
+		}
+
+		// Konstante Sprungweiten fuer SKIP
+		auto isConstant = [&](int index)
+		{
+			return !isWritten[index] && (registers[index].registerType == CONST || registers[index].isLiteral);
+		};
+
+		std::vector<bool> isTarget(numInstructions + 1, false);
+		std::vector<int> skipTarget(numInstructions, -1);
+		for (int i = 0; i < numInstructions; i++)
+		{
+			if (instructions[i].opcode != SKIP)
+				continue;
+			if (!isConstant(instructions[i].operand4))
+			{
+				if (DEBUG)
+					cout << "JIT: SKIP mit variabler Sprungweite wird nicht unterstuetzt" << endl;
+				return false;
+			}
+			int numSkip = static_cast<int>(valueOf(instructions[i].operand4));
+			if (numSkip == 0)
+				continue;
+			// wie im Interpreter: negativer Zaehler ueberspringt genau 1 Instruktion, Wraparound ueber END
+			if (numSkip < 0)
+				numSkip = 1;
+			skipTarget[i] = (i + 1 + numSkip) % numInstructions;
+			isTarget[skipTarget[i]] = true;
+		}
+
+		// Registerallokation: die meistbenutzten beschriebenen Register (und INPUT) in XMM Register
+		std::vector<int> useCount(numRegisters, 0);
+		for (int i = 0; i < numInstructions; i++)
+		{
+			if (usesHelper[i])
+				continue;
+			const Instruction &instruction = instructions[i];
+			useCount[instruction.operand1] += 2;
+			useCount[instruction.operand2]++;
+			useCount[instruction.operand3]++;
+			useCount[instruction.operand4]++;
+		}
+		if (ccrUsed)
+			useCount[0] += 2 * numInstructions; // CCR wird fast ueberall geschrieben
+
+		std::vector<int> candidates;
+		for (int i = 0; i < numRegisters; i++)
+		{
+			const int type = registers[i].registerType;
+			if (type == READ || type == WRITE || type == AT)
+				continue;
+			if (i == 0 && !ccrUsed)
+				continue;
+			if ((isWritten[i] || type == INPUT) && useCount[i] > 0)
+				candidates.push_back(i);
+		}
+		std::stable_sort(candidates.begin(), candidates.end(), [&](int a, int b)
+						 { return useCount[a] > useCount[b]; });
+		if (static_cast<int>(candidates.size()) > NUM_PINNED_XMM)
+			candidates.resize(NUM_PINNED_XMM);
+
+		std::vector<int> pinnedXMM(numRegisters, -1); // Register -> XMM
+		for (size_t k = 0; k < candidates.size(); k++)
+			pinnedXMM[candidates[k]] = FIRST_PINNED_XMM + static_cast<int>(k);
+
+		// Codeerzeugung
+		//----------------------------------------------------------------
+		X86Emitter e;
+		const X::Operand one = e.constantFloat(1.0f);
+		const X::Operand minusOne = e.constantFloat(-1.0f);
+		const X::Operand two = e.constantFloat(2.0f);
+		const X::Operand oneDouble = e.constantDouble(1.0);
+
+		uint32_t dirty = 0; // Bitmaske der XMM Register, die neuer als der Speicher sind
+		int pendingCount = 0;
+
+		auto operand = [&](int index)
+		{
+			return pinnedXMM[index] >= 0 ? X::xmm(pinnedXMM[index]) : X::mem(X::R15, offsetOf(index));
+		};
+		auto load = [&](int xmmDst, int index)
+		{
+			if (pinnedXMM[index] >= 0)
+				e.movaps(xmmDst, pinnedXMM[index]);
+			else
+				e.sse(X::PREFIX_SS, X::SSE_MOVS_LOAD, xmmDst, operand(index));
+		};
+		auto store = [&](int index, int xmmSrc)
+		{
+			if (pinnedXMM[index] >= 0)
+			{
+				e.movaps(pinnedXMM[index], xmmSrc);
+				dirty |= 1u << pinnedXMM[index];
+			}
+			else
+				e.sseStore(X::PREFIX_SS, operand(index), xmmSrc);
+		};
+		auto writeBack = [&](bool all)
+		{
+			for (int index : candidates)
+			{
+				if (all || (dirty & (1u << pinnedXMM[index])))
+					e.sseStore(X::PREFIX_SS, X::mem(X::R15, offsetOf(index)), pinnedXMM[index]);
+			}
+			dirty = 0;
+		};
+		auto reload = [&](int index)
+		{
+			if (pinnedXMM[index] >= 0)
+				e.sse(X::PREFIX_SS, X::SSE_MOVS_LOAD, pinnedXMM[index], X::mem(X::R15, offsetOf(index)));
+		};
+		auto flushCount = [&]()
+		{
+			if (pendingCount > 0)
+				e.addImm64(X::R14, pendingCount);
+			pendingCount = 0;
+		};
+		// Akkumulator = XMM0 (float), nur wenn MACMV vorkommt
+		auto storeAccumulator = [&]()
+		{
+			if (!accumulatorUsed)
+				return;
+			e.sse(X::PREFIX_SS, X::SSE_CVT, 1, X::xmm(0));
+			e.sseStore(X::PREFIX_SD, X::mem(X::RBP, 0), 1);
+		};
+		// Annotationen des Optimierers fuer die aktuelle Instruktion
+		bool instructionWritesCCR = true;
+		bool instructionSaturates = true;
+
+		// saturate(XMM0, 1.0)
+		auto saturate = [&]()
+		{
+			if (!instructionSaturates)
+				return;
+			e.sse(X::PREFIX_SS, X::SSE_MOVS_LOAD, 1, minusOne);
+			e.sse(X::PREFIX_SS, X::SSE_MAX, 1, X::xmm(0));
+			e.sse(X::PREFIX_SS, X::SSE_MOVS_LOAD, 0, one);
+			e.sse(X::PREFIX_SS, X::SSE_MIN, 0, X::xmm(1));
+		};
+		// wrapAround(XMMn)
+		auto wrapAround = [&](int reg)
+		{
+			const int lower = e.newLabel();
+			const int done = e.newLabel();
+			e.sse(X::PREFIX_NONE, X::SSE_UCOMIS, reg, one);
+			e.jcc(X::CC_B, lower);
+			e.sse(X::PREFIX_SS, X::SSE_SUB, reg, two);
+			e.jmp(done);
+			e.bind(lower);
+			e.sse(X::PREFIX_SS, X::SSE_MOVS_LOAD, 3, minusOne);
+			e.sse(X::PREFIX_NONE, X::SSE_UCOMIS, 3, X::xmm(reg));
+			e.jcc(X::CC_BE, done);
+			e.sse(X::PREFIX_SS, X::SSE_ADD, reg, two);
+			e.bind(done);
+		};
+		// setCCR(XMM0), gleiche Fallunterscheidung wie FX8010::setCCR()
+		auto setCCR = [&]()
+		{
+			if (!ccrUsed || !instructionWritesCCR)
+				return;
+			const int negative = e.newLabel();
+			const int done = e.newLabel();
+			e.sse(X::PREFIX_NONE, X::SSE_XORP, 1, X::xmm(1));
+			e.sse(X::PREFIX_NONE, X::SSE_UCOMIS, 0, X::xmm(1));
+			e.movImm32(X::RAX, 0);
+			e.jcc(X::CC_P, done); // NaN
+			e.movImm32(X::RAX, 0b01000);
+			e.jcc(X::CC_E, done); // Zero
+			e.jcc(X::CC_B, negative);
+			e.sse(X::PREFIX_NONE, X::SSE_UCOMIS, 0, one);
+			e.movImm32(X::RAX, 0b00010);
+			e.jcc(X::CC_B, done); // Normalized Positive
+			e.movImm32(X::RAX, 0b10000);
+			e.jcc(X::CC_E, done); // Positive Saturation
+			e.movImm32(X::RAX, 0);
+			e.jmp(done);
+			e.bind(negative);
+			e.sse(X::PREFIX_NONE, X::SSE_UCOMIS, 0, minusOne);
+			e.movImm32(X::RAX, 0b00110);
+			e.jcc(X::CC_A, done); // Normalized Negative
+			e.movImm32(X::RAX, 0b10100);
+			e.jcc(X::CC_E, done); // Negative Saturation
+			e.movImm32(X::RAX, 0);
+			e.bind(done);
+			e.sse(X::PREFIX_SS, X::SSE_CVTSI2S, 1, X::xmm(X::RAX));
+			store(0, 1);
+		};
+
+		// Prolog
+		e.push(X::RBP);
+		e.push(X::RBX);
+		e.push(X::R12);
+		e.push(X::R13);
+		e.push(X::R14);
+		e.push(X::R15);
+		e.subImm64(X::RSP, STACK_RESERVE);
+#ifdef _WIN32
+		for (int k = 0; k < 10; k++)
+			e.sse(X::PREFIX_NONE, X::SSE_MOVS_STORE, 6 + k, X::mem(X::RSP, 32 + 16 * k)); // movups
+#endif
+		e.movRegReg64(X::RBX, ARG0);
+		e.movsxd(X::R13, ARG1);
+		e.shlImm64(X::R13, 2);
+		e.xorReg32(X::R12, X::R12);
+		e.xorReg32(X::R14, X::R14);
+		e.movRegMem64(X::R15, X::RBX, offsetof(JITContext, registerFile));
+		e.movRegMem64(X::RBP, X::RBX, offsetof(JITContext, accumulator));
+		for (int index : candidates)
+			reload(index);
+
+		const int sampleLoop = e.newLabel();
+		const int exitLabel = e.newLabel();
+		std::vector<int> labels(numInstructions);
+		for (int i = 0; i < numInstructions; i++)
+			labels[i] = e.newLabel();
+
+		e.testRegReg64(X::R13, X::R13);
+		e.jcc(X::CC_LE, exitLabel);
+		e.bind(sampleLoop);
+
+		// Eingaenge einmal je Samplezyklus
+		for (const auto &io : inputRegisters)
+		{
+			e.movRegMem64(X::RAX, X::RBX, offsetof(JITContext, inputs));
+			e.movRegMem64(X::RAX, X::RAX, 8 * io.IOIndex);
+			e.addRegReg64(X::RAX, X::R12);
+			e.sse(X::PREFIX_SS, X::SSE_MOVS_LOAD, 0, X::mem(X::RAX, 0));
+			store(io.registerIndex, 0);
+		}
+
+		for (int i = 0; i < numInstructions; i++)
+		{
+			const Instruction &instruction = instructions[i];
+			const int R = instruction.operand1;
+			const int A = instruction.operand2;
+			const int Xo = instruction.operand3;
+			const int Y = instruction.operand4;
+			instructionWritesCCR = instruction.writesCCR;
+			instructionSaturates = instruction.saturates;
+
+			if (isTarget[i])
+			{
+				// Ab hier koennen mehrere Pfade zusammenlaufen
+				flushCount();
+				writeBack(false);
+			}
+			e.bind(labels[i]);
+			pendingCount++;
+
+			if (usesHelper[i])
+			{
+				// Handler des dekodierten Interpreters: handler(dsp, &decodedInstructions[i])
+				writeBack(false);
+				// Delaylines adressieren relativ zum aktuellen Frame
+				if (instruction.opcode == IDELAY || instruction.opcode == XDELAY)
+					e.movMemReg64(X::RBX, offsetof(JITContext, frameOffset), X::R12);
+				e.movRegMem64(ARG0, X::RBX, offsetof(JITContext, dsp));
+				e.movImm64(ARG1, reinterpret_cast<uint64_t>(&decodedInstructions[i]));
+				e.movImm64(X::RAX, reinterpret_cast<uint64_t>(decodedInstructions[i].handler));
+				e.callReg(X::RAX);
+				if (CALL_CLOBBERS_PINNED)
+				{
+					for (int index : candidates)
+						reload(index);
+				}
+				else
+				{
+					// Handler schreiben nur R, A (Delay lesen), NOISE und CCR
+					reload(R);
+					reload(A);
+					reload(0);
+					for (int index : candidates)
+						if (registers[index].registerName == "noise")
+							reload(index);
+				}
+				continue;
+			}
+
+			switch (instruction.opcode)
+			{
+			case MACS:
+			case MACINTS:
+				// R = A + X * Y
+				load(0, Xo);
+				e.sse(X::PREFIX_SS, X::SSE_MUL, 0, operand(Y));
+				e.sse(X::PREFIX_SS, X::SSE_ADD, 0, operand(A));
+				storeAccumulator();
+				saturate();
+				store(R, 0);
+				setCCR();
+				break;
+			case MOVS:
+				// R = A
+				load(0, A);
+				storeAccumulator();
+				saturate();
+				store(R, 0);
+				setCCR();
+				break;
+			case ADDS:
+				// R = A + X
+				load(0, A);
+				e.sse(X::PREFIX_SS, X::SSE_ADD, 0, operand(Xo));
+				storeAccumulator();
+				saturate();
+				store(R, 0);
+				setCCR();
+				break;
+			case MULS:
+				// R = X * Y
+				load(0, Xo);
+				e.sse(X::PREFIX_SS, X::SSE_MUL, 0, operand(Y));
+				storeAccumulator();
+				saturate();
+				store(R, 0);
+				setCCR();
+				break;
+			case MACSN:
+				// R = A - X * Y
+				load(1, Xo);
+				e.sse(X::PREFIX_SS, X::SSE_MUL, 1, operand(Y));
+				load(0, A);
+				e.sse(X::PREFIX_SS, X::SSE_SUB, 0, X::xmm(1));
+				storeAccumulator();
+				saturate();
+				store(R, 0);
+				setCCR();
+				break;
+			case ACC3:
+				// R = A + X + Y
+				load(0, A);
+				e.sse(X::PREFIX_SS, X::SSE_ADD, 0, operand(Xo));
+				e.sse(X::PREFIX_SS, X::SSE_ADD, 0, operand(Y));
+				storeAccumulator();
+				saturate();
+				store(R, 0);
+				setCCR();
+				break;
+			case MACW:
+				// R = A + wrapAround(X * Y)
+				load(0, Xo);
+				e.sse(X::PREFIX_SS, X::SSE_MUL, 0, operand(Y));
+				wrapAround(0);
+				e.sse(X::PREFIX_SS, X::SSE_ADD, 0, operand(A));
+				storeAccumulator();
+				store(R, 0);
+				setCCR();
+				break;
+			case MACWN:
+				// R = A - wrapAround(X * Y)
+				load(1, Xo);
+				e.sse(X::PREFIX_SS, X::SSE_MUL, 1, operand(Y));
+				wrapAround(1);
+				load(0, A);
+				e.sse(X::PREFIX_SS, X::SSE_SUB, 0, X::xmm(1));
+				storeAccumulator();
+				store(R, 0);
+				setCCR();
+				break;
+			case MACINTW:
+				// R = wrapAround(A + X * Y)
+				load(0, Xo);
+				e.sse(X::PREFIX_SS, X::SSE_MUL, 0, operand(Y));
+				e.sse(X::PREFIX_SS, X::SSE_ADD, 0, operand(A));
+				wrapAround(0);
+				storeAccumulator();
+				store(R, 0);
+				setCCR();
+				break;
+			case MACMV:
+				// accumulator += X * Y, R = A
+				load(1, Xo);
+				e.sse(X::PREFIX_SS, X::SSE_MUL, 1, operand(Y));
+				e.sse(X::PREFIX_SS, X::SSE_CVT, 1, X::xmm(1));
+				e.sse(X::PREFIX_SD, X::SSE_MOVS_LOAD, 2, X::mem(X::RBP, 0));
+				e.sse(X::PREFIX_SD, X::SSE_ADD, 2, X::xmm(1));
+				e.sseStore(X::PREFIX_SD, X::mem(X::RBP, 0), 2);
+				load(0, A);
+				store(R, 0);
+				setCCR();
+				break;
+			case LIMIT:
+			case LIMITN:
+			{
+				// LIMIT: R = A >= Y ? X : Y, LIMITN: R = A < Y ? X : Y
+				const int takeX = e.newLabel();
+				const int done = e.newLabel();
+				if (instruction.opcode == LIMIT)
+				{
+					load(0, A);
+					e.sse(X::PREFIX_NONE, X::SSE_UCOMIS, 0, operand(Y));
+					e.jcc(X::CC_AE, takeX);
+				}
+				else
+				{
+					load(0, Y);
+					e.sse(X::PREFIX_NONE, X::SSE_UCOMIS, 0, operand(A));
+					e.jcc(X::CC_A, takeX);
+				}
+				load(0, Y);
+				e.jmp(done);
+				e.bind(takeX);
+				load(0, Xo);
+				e.bind(done);
+				storeAccumulator();
+				store(R, 0);
+				setCCR();
+				break;
+			}
+			case INTERP:
+				// R = (1.0 - X) * A + (X * Y), in double wie im Interpreter
+				e.sse(X::PREFIX_SS, X::SSE_CVT, 1, operand(Xo));
+				e.sse(X::PREFIX_SD, X::SSE_MOVS_LOAD, 2, oneDouble);
+				e.sse(X::PREFIX_SD, X::SSE_SUB, 2, X::xmm(1));
+				e.sse(X::PREFIX_SS, X::SSE_CVT, 3, operand(A));
+				e.sse(X::PREFIX_SD, X::SSE_MUL, 2, X::xmm(3));
+				load(1, Xo);
+				e.sse(X::PREFIX_SS, X::SSE_MUL, 1, operand(Y));
+				e.sse(X::PREFIX_SS, X::SSE_CVT, 1, X::xmm(1));
+				e.sse(X::PREFIX_SD, X::SSE_ADD, 2, X::xmm(1));
+				e.sse(X::PREFIX_SD, X::SSE_CVT, 0, X::xmm(2));
+				storeAccumulator();
+				saturate();
+				store(R, 0);
+				setCCR();
+				break;
+			case SKIP:
+			{
+				// Wenn (int)X == CCR, dann springe ueber Y Instruktionen
+				flushCount();
+				if (skipTarget[i] < 0)
+					break;
+				writeBack(false);
+				const int notTaken = e.newLabel();
+				e.sse(X::PREFIX_SS, X::SSE_CVTTS2SI, X::RAX, operand(Xo));
+				e.sse(X::PREFIX_SS, X::SSE_CVTSI2S, 1, X::xmm(X::RAX));
+				e.sse(X::PREFIX_NONE, X::SSE_UCOMIS, 1, operand(0));
+				e.jcc(X::CC_P, notTaken);
+				e.jcc(X::CC_E, labels[skipTarget[i]]);
+				e.bind(notTaken);
+				break;
+			}
+			default:
+				// END am Programmende beendet den Samplezyklus (folgt direkt), sonst wirkungslos
+				break;
+			}
+		}
+		flushCount();
+
+		// Ausgaenge: je Kanal das zuletzt deklarierte OUTPUT Register, sonst der alte Outputbuffer-Wert
+		for (int channel = 0; channel < numChannels; channel++)
+		{
+			int source = -1;
+			for (const auto &io : outputRegisters)
+			{
+				if (io.IOIndex == channel)
+					source = io.registerIndex;
+			}
+			if (source >= 0)
+				load(0, source);
+			else
+			{
+				e.movImm64(X::RCX, reinterpret_cast<uint64_t>(&outputBuffer[channel]));
+				e.sse(X::PREFIX_SS, X::SSE_MOVS_LOAD, 0, X::mem(X::RCX, 0));
+			}
+			e.movRegMem64(X::RAX, X::RBX, offsetof(JITContext, outputs));
+			e.movRegMem64(X::RAX, X::RAX, 8 * channel);
+			e.addRegReg64(X::RAX, X::R12);
+			e.sseStore(X::PREFIX_SS, X::mem(X::RAX, 0), 0);
+		}
+
+		// Der Schleifenanfang ist ebenfalls ein Sammelpunkt: der Code dort geht von einem sauberen
+		// Speicher aus, ein Helper im naechsten Samplezyklus laedt die Register sonst veraltet nach
+		if (std::find(usesHelper.begin(), usesHelper.end(), true) != usesHelper.end())
+			writeBack(false);
+		e.addImm64(X::R12, 4);
+		e.cmpRegReg64(X::R12, X::R13);
+		e.jcc(X::CC_L, sampleLoop);
+
+		// Epilog
+		e.bind(exitLabel);
+		writeBack(true);
+		e.movMemReg64(X::RBX, offsetof(JITContext, instructionCount), X::R14);
+#ifdef _WIN32
+		for (int k = 0; k < 10; k++)
+			e.sse(X::PREFIX_NONE, X::SSE_MOVS_LOAD, 6 + k, X::mem(X::RSP, 32 + 16 * k)); // movups
+#endif
+		e.addImm64(X::RSP, STACK_RESERVE);
+		e.pop(X::R15);
+		e.pop(X::R14);
+		e.pop(X::R13);
+		e.pop(X::R12);
+		e.pop(X::RBX);
+		e.pop(X::RBP);
+		e.ret();
+
+		std::vector<uint8_t> machineCode;
+		if (!e.finalize(machineCode) || !jitMemory.assign(machineCode))
+			return false;
+
+		jitFunction = reinterpret_cast<JITFunction>(jitMemory.data());
+
+		// Kontext fuer die Aufrufe
+		jitContext.dsp = this;
+		jitContext.registerFile = registerValues.data();
+		jitContext.accumulator = &accumulator;
+
+		if (DEBUG)
+			cout << "JIT: " << machineCode.size() << " Bytes Maschinencode, " << candidates.size() << " GPR in XMM Registern" << endl;
+		return true;
+#endif
+	}
+
+} // namespace Klangraum
@@ -0,0 +1,488 @@
+// Copyright 2023 Klangraum
+
+#include "../include/FX8010Lanes.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Klangraum
+{
+	namespace
+	{
+		// wie FX8010::saturate(x, 1.0)
+		inline float saturateLane(const float x)
+		{
+			return (x >= 1.0f) ? 1.0f : ((x <= -1.0f) ? -1.0f : x);
+		}
+
+		// wie FX8010::setCCR(), die Faelle schliessen sich aus -> Selects statt Verzweigungen
+		inline float ccrOf(const float result)
+		{
+			float ccr = 0b00000;
+			ccr = (result == 0) ? 0b01000 : ccr;
+			ccr = (result < 0 && result > -1.0f) ? 0b00110 : ccr;
+			ccr = (result > 0 && result < 1.0f) ? 0b00010 : ccr;
+			ccr = (result == 1.0f) ? 0b10000 : ccr;
+			ccr = (result == -1.0f) ? 0b10100 : ccr;
+			return ccr;
+		}
+
+		// wie FX8010::wrapAround() (das Borrow Flag ueberschreibt setCCR() ohnehin)
+		inline float wrapLane(const float a)
+		{
+			return (a >= 1.0f) ? a - 2.0f : ((a < -1.0f) ? a + 2.0f : a);
+		}
+	}
+
+	FX8010Lanes::FX8010Lanes(FX8010 &program_, int numInstances_)
+		: program(program_), numInstances(std::max(1, numInstances_)), numChannels(program_.numChannels)
+	{
+		// Gruppenbreite: so schmal wie moeglich bei wenigen, 16 bei vielen Instanzen
+		laneWidth = (numInstances <= 4) ? 4 : ((numInstances <= 8) ? 8 : MAX_LANE_WIDTH);
+		const int W = laneWidth;
+
+		numValues = static_cast<int>(program.registerValues.size());
+		// Zweierpotenz-Ringpuffer wie im Programm
+		smallDelayMask = program.smallDelayMask;
+		largeDelayMask = program.largeDelayMask;
+
+		// Instruktionen auf Werteindizes abbilden
+		for (const auto &instruction : program.instructions)
+		{
+			LaneInstruction li;
+			li.opcode = instruction.opcode;
+			li.R = program.registers[instruction.operand1].valueIndex;
+			li.A = program.registers[instruction.operand2].valueIndex;
+			li.X = program.registers[instruction.operand3].valueIndex;
+			li.Y = program.registers[instruction.operand4].valueIndex;
+			li.writesCCR = instruction.writesCCR;
+			if (instruction.hasNoise)
+			{
+				// Wie im Referenz-Interpreter wird nur der erste NOISE Operand erneuert
+				if (program.registers[instruction.operand2].registerName == "noise")
+					li.noise = li.A;
+				else if (program.registers[instruction.operand3].registerName == "noise")
+					li.noise = li.X;
+				else
+					li.noise = li.Y;
+			}
+			if (instruction.opcode == FX8010::IDELAY || instruction.opcode == FX8010::XDELAY)
+			{
+				const int type = program.registers[instruction.operand1].registerType;
+				li.delayMode = (type == FX8010::READ) ? 1 : (type == FX8010::WRITE) ? 2 : 0;
+			}
+			laneInstructions.push_back(li);
+
+			// Akkumulator gelesen?
+			if (instruction.opcode == FX8010::MACMV)
+				accumulatorUsed = true;
+		}
+
+		// CCR als Operand bzw. von SKIP gelesen?
+		ccrUsed = program.programReadsCCR();
+
+		for (const auto &reg : program.registers)
+		{
+			if (reg.registerType == FX8010::INPUT)
+				inputRegisters.push_back({reg.valueIndex, reg.IOIndex});
+			else if (reg.registerType == FX8010::OUTPUT)
+				outputRegisters.push_back({reg.valueIndex, reg.IOIndex});
+			if (!reg.isLiteral)
+				valueIndexByName[reg.registerName] = reg.valueIndex;
+		}
+
+		// Gruppen zu je LANE_WIDTH Instanzen, Startzustand = aktuelle Registerwerte des Programms
+		groups.resize((numInstances + W - 1) / W);
+		for (size_t g = 0; g < groups.size(); g++)
+		{
+			LaneGroup &group = groups[g];
+			group.values.resize(static_cast<size_t>(numValues) * W);
+			for (int v = 0; v < numValues; v++)
+				for (int l = 0; l < W; l++)
+					group.values[v * W + l] = program.registerValues[v];
+			group.smallDelay.assign(static_cast<size_t>(smallDelayMask + 1) * W, 0.0f);
+			group.largeDelay.assign(static_cast<size_t>(largeDelayMask + 1) * W, 0.0f);
+			group.smallDelayPos = 0;
+			group.largeDelayPos = 0;
+			for (int l = 0; l < W; l++)
+			{
+				group.accumulator[l] = 0;
+				group.skip[l] = 0;
+				// Instanz 0 rauscht wie FX8010, alle anderen mit eigenem Seed (unkorreliert)
+				const int32_t instance = static_cast<int32_t>(g * W + l);
+				group.noiseX1[l] = program.g_x1 ^ static_cast<int32_t>(instance * 0x9e3779b9u);
+				group.noiseX2[l] = program.g_x2;
+			}
+		}
+	}
+
+	FX8010Lanes::~FX8010Lanes(){};
+
+	// CHECKED
+	int FX8010Lanes::setRegisterValue(int instance, const std::string &key, float value)
+	{
+		// Konstantensegment und CONST sind read-only, wie bei FX8010::setRegisterValue()
+		const int handle = program.getRegisterHandle(key);
+		if (handle < 0 || instance < 0 || instance >= numInstances)
+			return 1;
+		groups[instance / laneWidth].values[handle * laneWidth + instance % laneWidth] = value;
+		return 0;
+	}
+
+	// CHECKED
+	float FX8010Lanes::getRegisterValue(int instance, const std::string &key)
+	{
+		auto it = valueIndexByName.find(key);
+		if (it == valueIndexByName.end() || instance < 0 || instance >= numInstances)
+			return 1; // wie FX8010::getRegisterValue()
+		return groups[instance / laneWidth].values[it->second * laneWidth + instance % laneWidth];
+	}
+
+	void FX8010Lanes::processBlock(const float *const *inputs, float *const *outputs, int numFrames)
+	{
+		for (size_t g = 0; g < groups.size(); g++)
+		{
+			const int firstInstance = static_cast<int>(g) * laneWidth;
+			if (laneWidth == 4)
+				processGroup<4>(groups[g], firstInstance, inputs, outputs, numFrames);
+			else if (laneWidth == 8)
+				processGroup<8>(groups[g], firstInstance, inputs, outputs, numFrames);
+			else
+				processGroup<16>(groups[g], firstInstance, inputs, outputs, numFrames);
+		}
+	}
+
+	template <int W>
+	void FX8010Lanes::processGroup(LaneGroup &group, int firstInstance, const float *const *inputs, float *const *outputs, int numFrames)
+	{
+		// Letzte Gruppe: ueberzaehlige Lanes rechnen mit Stille und werden nicht ausgegeben
+		const int numActiveLanes = std::min(W, numInstances - firstInstance);
+		float *values = group.values.data();
+
+		for (int i = 0; i < numFrames; i++)
+		{
+			for (const auto &io : inputRegisters)
+			{
+				float *value = values + io.valueIndex * W;
+				for (int l = 0; l < numActiveLanes; l++)
+					value[l] = inputs[(firstInstance + l) * numChannels + io.IOIndex][i];
+			}
+
+			processSample<W>(group, numActiveLanes);
+			// TRAM Position einmal je Samplezyklus (fuer alle Lanes gleich)
+			group.smallDelayPos = (group.smallDelayPos + 1) & smallDelayMask;
+			group.largeDelayPos = (group.largeDelayPos + 1) & largeDelayMask;
+
+			// Ausgaenge ohne Output-Register bleiben unveraendert (wie outputBuffer in FX8010)
+			for (const auto &io : outputRegisters)
+			{
+				const float *value = values + io.valueIndex * W;
+				for (int l = 0; l < numActiveLanes; l++)
+					outputs[(firstInstance + l) * numChannels + io.IOIndex][i] = value[l];
+			}
+		}
+	}
+
+	// 1 Samplezyklus, alle Lanes fuehren dieselbe Instruktion aus.
+	// SKIP: jede Lane hat ihren eigenen Skip-Zaehler. Instruktionen werden dann fuer alle Lanes
+	// berechnet, aber nur fuer die aktiven Lanes (mask) zurueckgeschrieben.
+	// END: wie im Referenz-Interpreter wird der Durchlauf zu Ende gefuehrt. Lanes ohne END
+	// (SKIP ueber END) laufen in einem weiteren Durchlauf weiter, die anderen sind dann inaktiv.
+	template <int W>
+	void FX8010Lanes::processSample(LaneGroup &group, int numActiveLanes)
+	{
+		float *values = group.values.data();
+		float *ccr = values; // CCR hat Werteindex 0
+		double *accumulator = group.accumulator;
+		const int numInstructions = static_cast<int>(laneInstructions.size());
+
+		alignas(64) int32_t mask[W];
+		alignas(64) float result[W];
+		alignas(64) float ccrNew[W];
+		alignas(64) double accumulatorNew[W];
+		bool endSeen[W];
+		bool done[W];
+		for (int l = 0; l < W; l++)
+		{
+			group.skip[l] = 0;
+			endSeen[l] = false;
+			done[l] = false;
+		}
+
+		// Solange keine Lane ueberspringt, sind alle Lanes aktiv (schneller Pfad ohne Maske)
+		bool maskDirty = false;
+		bool fullMask = true;
+		int lanesDone = 0;
+
+		do
+		{
+			for (int n = 0; n < numInstructions; n++)
+			{
+				const LaneInstruction &instruction = laneInstructions[n];
+
+				// Lanemaske fuer diese Instruktion
+				if (maskDirty)
+				{
+					bool anyPending = false;
+					fullMask = true;
+					for (int l = 0; l < W; l++)
+					{
+						const bool active = !done[l] && group.skip[l] == 0;
+						mask[l] = active ? -1 : 0;
+						fullMask &= active;
+						// Dekrementiere Skip-Counter (negativ: genau 1 Instruktion)
+						if (!done[l] && group.skip[l] != 0)
+							group.skip[l] = (group.skip[l] > 0) ? group.skip[l] - 1 : 0;
+						anyPending |= done[l] || group.skip[l] != 0;
+					}
+					// Nach einer Teilmaske muss die naechste Instruktion die Maske neu bestimmen
+					maskDirty = anyPending || !fullMask;
+				}
+
+				// Zaehle Instruktionen der echten Instanzen
+				if (fullMask)
+					instructionCounter += numActiveLanes;
+				else
+					for (int l = 0; l < numActiveLanes; l++)
+						instructionCounter += mask[l] & 1;
+
+				float *R = values + instruction.R * W;
+				float *A = values + instruction.A * W;
+				float *X = values + instruction.X * W;
+				float *Y = values + instruction.Y * W;
+
+				if (instruction.noise >= 0)
+				{
+					float *noise = values + instruction.noise * W;
+					for (int l = 0; l < W; l++)
+					{
+						if (!fullMask && !mask[l])
+							continue;
+						// wie FX8010::whitenoise()
+						group.noiseX1[l] ^= group.noiseX2[l];
+						noise[l] = group.noiseX2[l] * program.g_fScale;
+						group.noiseX2[l] += group.noiseX1[l];
+					}
+				}
+
+				// Ergebnis: R wird immer, der Akkumulator nur bei writesAccumulator geschrieben
+				bool writesR = true;
+				bool writesAccumulator = true;
+
+				switch (instruction.opcode)
+				{
+				case FX8010::MACS:
+				case FX8010::MACINTS:
+					for (int l = 0; l < W; l++)
+					{
+						const float r = A[l] + X[l] * Y[l];
+						accumulatorNew[l] = r;
+						result[l] = saturateLane(r);
+					}
+					break;
+				case FX8010::MOVS:
+					for (int l = 0; l < W; l++)
+					{
+						const float r = A[l];
+						accumulatorNew[l] = r;
+						result[l] = saturateLane(r);
+					}
+					break;
+				case FX8010::ADDS:
+					for (int l = 0; l < W; l++)
+					{
+						const float r = A[l] + X[l];
+						accumulatorNew[l] = r;
+						result[l] = saturateLane(r);
+					}
+					break;
+				case FX8010::MULS:
+					for (int l = 0; l < W; l++)
+					{
+						const float r = X[l] * Y[l];
+						accumulatorNew[l] = r;
+						result[l] = saturateLane(r);
+					}
+					break;
+				case FX8010::MACSN:
+					for (int l = 0; l < W; l++)
+					{
+						const float r = A[l] - X[l] * Y[l];
+						accumulatorNew[l] = r;
+						result[l] = saturateLane(r);
+					}
+					break;
+				case FX8010::ACC3:
+					for (int l = 0; l < W; l++)
+					{
+						const float r = A[l] + X[l] + Y[l];
+						accumulatorNew[l] = r;
+						result[l] = saturateLane(r);
+					}
+					break;
+				case FX8010::MACW:
+					for (int l = 0; l < W; l++)
+					{
+						result[l] = A[l] + wrapLane(X[l] * Y[l]);
+						accumulatorNew[l] = result[l];
+					}
+					break;
+				case FX8010::MACWN:
+					for (int l = 0; l < W; l++)
+					{
+						result[l] = A[l] - wrapLane(X[l] * Y[l]);
+						accumulatorNew[l] = result[l];
+					}
+					break;
+				case FX8010::MACINTW:
+					for (int l = 0; l < W; l++)
+					{
+						result[l] = wrapLane(A[l] + X[l] * Y[l]);
+						accumulatorNew[l] = result[l];
+					}
+					break;
+				case FX8010::MACMV:
+					for (int l = 0; l < W; l++)
+					{
+						accumulatorNew[l] = accumulator[l] + (X[l] * Y[l]);
+						result[l] = A[l];
+					}
+					break;
+				case FX8010::LIMIT:
+					for (int l = 0; l < W; l++)
+					{
+						result[l] = A[l] >= Y[l] ? X[l] : Y[l];
+						accumulatorNew[l] = result[l];
+					}
+					break;
+				case FX8010::LIMITN:
+					for (int l = 0; l < W; l++)
+					{
+						result[l] = A[l] < Y[l] ? X[l] : Y[l];
+						accumulatorNew[l] = result[l];
+					}
+					break;
+				case FX8010::INTERP:
+					for (int l = 0; l < W; l++)
+					{
+						const float r = (1.0 - X[l]) * A[l] + (X[l] * Y[l]);
+						accumulatorNew[l] = r;
+						result[l] = saturateLane(r);
+					}
+					break;
+				case FX8010::TSTNEG:
+					for (int l = 0; l < W; l++)
+					{
+						result[l] = A[l] >= Y[l] ? X[l] : program.intToFloat(~program.floatToInt(X[l]));
+						accumulatorNew[l] = result[l];
+					}
+					break;
+				case FX8010::ANDXOR:
+					writesAccumulator = false;
+					for (int l = 0; l < W; l++)
+						result[l] = program.logicOps(A[l], X[l], Y[l]);
+					break;
+				case FX8010::LOG:
+					for (int l = 0; l < W; l++)
+					{
+						result[l] = logLinear(A[l], static_cast<int32_t>(X[l]), static_cast<int32_t>(Y[l]));
+						accumulatorNew[l] = result[l];
+					}
+					break;
+				case FX8010::EXP:
+					for (int l = 0; l < W; l++)
+					{
+						result[l] = expLinear(A[l], static_cast<int32_t>(X[l]), static_cast<int32_t>(Y[l]));
+						accumulatorNew[l] = result[l];
+					}
+					break;
+				case FX8010::SKIP:
+					writesR = false;
+					for (int l = 0; l < W; l++)
+					{
+						// Wenn X = CCR, dann ueberspringe Y Instructions.
+						if ((fullMask || mask[l]) && static_cast<int32_t>(X[l]) == ccr[l])
+						{
+							group.skip[l] = static_cast<int>(Y[l]);
+							maskDirty |= group.skip[l] != 0;
+						}
+					}
+					break;
+				case FX8010::IDELAY:
+				case FX8010::XDELAY:
+				{
+					writesR = false;
+					const bool isSmall = instruction.opcode == FX8010::IDELAY;
+					if (instruction.delayMode == 0)
+						break;
+					float *buffer = isSmall ? group.smallDelay.data() : group.largeDelay.data();
+					const int ringMask = isSmall ? smallDelayMask : largeDelayMask;
+					const int position = isSmall ? group.smallDelayPos : group.largeDelayPos;
+					for (int l = 0; l < W; l++)
+					{
+						if (!fullMask && !mask[l])
+							continue;
+						const int index = (position - static_cast<int>(Y[l])) & ringMask;
+						if (instruction.delayMode == 1)
+							A[l] = buffer[index * W + l]; // READ, A, AT, Y
+						else
+							buffer[index * W + l] = A[l]; // WRITE, A, AT, Y
+					}
+					break;
+				}
+				case FX8010::END:
+					writesR = false;
+					for (int l = 0; l < W; l++)
+						endSeen[l] |= fullMask || mask[l];
+					break;
+				default:
+					writesR = false;
+					break;
+				}
+
+				// Ergebnis zurueckschreiben, CCR nach R (R kann selbst CCR sein)
+				if (writesR)
+				{
+					const bool writesCCR = ccrUsed && instruction.writesCCR;
+					if (writesCCR)
+						for (int l = 0; l < W; l++)
+							ccrNew[l] = ccrOf(result[l]);
+
+					if (fullMask)
+					{
+						for (int l = 0; l < W; l++)
+							R[l] = result[l];
+						if (writesCCR)
+							for (int l = 0; l < W; l++)
+								ccr[l] = ccrNew[l];
+						if (writesAccumulator && accumulatorUsed)
+							for (int l = 0; l < W; l++)
+								accumulator[l] = accumulatorNew[l];
+					}
+					else
+					{
+						for (int l = 0; l < W; l++)
+							R[l] = mask[l] ? result[l] : R[l];
+						if (writesCCR)
+							for (int l = 0; l < W; l++)
+								ccr[l] = mask[l] ? ccrNew[l] : ccr[l];
+						if (writesAccumulator && accumulatorUsed)
+							for (int l = 0; l < W; l++)
+								accumulator[l] = mask[l] ? accumulatorNew[l] : accumulator[l];
+					}
+				}
+			}
+
+			// Lanes mit END sind fertig, der Rest laeuft einen weiteren Durchlauf
+			lanesDone = 0;
+			for (int l = 0; l < W; l++)
+			{
+				done[l] = done[l] || endSeen[l];
+				lanesDone += done[l];
+			}
+			if (lanesDone < W)
+				maskDirty = true;
+		} while (lanesDone < W);
+	}
+
+} // namespace Klangraum
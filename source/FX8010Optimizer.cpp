@@ -0,0 +1,1003 @@
+// Copyright 2023 Klangraum
+// Optimierer fuer den geparsten Befehlsstrom
+// Laeuft in loadFile() nach dem Syntaxcheck, vor layoutRegisters() und decode(), und arbeitet
+// nur auf FX8010::instructions. Alle Engines (switch, decoded, JIT, Lanes) fuehren danach das
+// optimierte Programm aus. Passes (wiederholt, bis sich nichts mehr aendert):
+//   1. Konstantenfaltung:  A/X/Y konstant -> MOVS R, Ergebnis
+//   2. Strength Reduction: MACS/MACSN mit 0.0 bzw. 1.0 Operand -> MOVS/ADDS/MULS
+//   3. Copy Propagation:   nach MOVS R, A lesen folgende Instruktionen direkt A
+//   4. Tote Schreibzugriffe auf TEMP/STATIC (Register, CCR und Akkumulator ungelesen) entfernen
+// SKIP Sprungweiten werden nach dem Entfernen neu berechnet.
+// Danach werden die Instruktionen annotiert: writesCCR (CCR Ergebnis kann gelesen werden, Liveness)
+// und saturates (Wertebereich kann [-1.0, 1.0] verlassen). decode() und der JIT waehlen danach
+// die Variante ohne setCCR() bzw. saturate().
+
+#include "../include/FX8010.h"
+#include "../include/helpers.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace Klangraum
+{
+	namespace
+	{
+		// Wertebereich [lo, hi] fuer die Saturations-Analyse
+		// Die Grenzen werden mit denselben Rundungen wie im Interpreter gerechnet. Da die Rundung
+		// monoton ist, liegt das gerundete Ergebnis immer innerhalb der gerundeten Grenzen.
+		struct Range
+		{
+			float lo;
+			float hi;
+		};
+
+		const float INF = std::numeric_limits<float>::infinity();
+		const Range UNKNOWN = {-INF, INF};
+
+		inline bool isValid(const Range &r) { return r.lo == r.lo && r.hi == r.hi; }
+
+		inline Range hull(const Range &a, const Range &b) { return {std::min(a.lo, b.lo), std::max(a.hi, b.hi)}; }
+
+		inline bool contains(const Range &outer, const Range &inner) { return inner.lo >= outer.lo && inner.hi <= outer.hi; }
+
+		inline Range add(const Range &a, const Range &b)
+		{
+			const Range r = {a.lo + b.lo, a.hi + b.hi};
+			return isValid(r) ? r : UNKNOWN;
+		}
+
+		inline Range negate(const Range &a) { return {-a.hi, -a.lo}; }
+
+		inline Range multiply(const Range &a, const Range &b)
+		{
+			const float p[4] = {a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi};
+			Range r = {p[0], p[0]};
+			for (float v : p)
+			{
+				if (v != v)
+					return UNKNOWN; // 0 * inf
+				r.lo = std::min(r.lo, v);
+				r.hi = std::max(r.hi, v);
+			}
+			return r;
+		}
+
+		inline Range saturated(const Range &a)
+		{
+			auto clamp = [](float v)
+			{ return std::max(-1.0f, std::min(1.0f, v)); };
+			return {clamp(a.lo), clamp(a.hi)};
+		}
+
+		// wie wrapAround(): [-1, 1) bleibt, [-3, 3) landet in [-1, 1]
+		inline Range wrapped(const Range &a)
+		{
+			if (a.lo >= -1.0f && a.hi < 1.0f)
+				return a;
+			if (a.lo >= -3.0f && a.hi < 3.0f)
+				return {-1.0f, 1.0f};
+			return UNKNOWN;
+		}
+
+		// INTERP rechnet (1.0 - X) * A in double, X * Y in float
+		inline Range interpolated(const Range &A, const Range &X, const Range &Y)
+		{
+			const double w[2] = {1.0 - X.hi, 1.0 - X.lo};
+			double lo = INFINITY, hi = -INFINITY;
+			for (double wv : w)
+			{
+				for (double av : {static_cast<double>(A.lo), static_cast<double>(A.hi)})
+				{
+					const double v = wv * av;
+					if (v != v)
+						return UNKNOWN;
+					lo = std::min(lo, v);
+					hi = std::max(hi, v);
+				}
+			}
+			const Range xy = multiply(X, Y);
+			const Range r = {static_cast<float>(lo + xy.lo), static_cast<float>(hi + xy.hi)};
+			return isValid(r) ? r : UNKNOWN;
+		}
+
+		// Je Instruktion eine Bitmenge ueber die Liveness-Slots, alle Mengen in einem Block
+		struct SlotSets
+		{
+			int numWords = 0;
+			std::vector<uint64_t> bits;
+
+			void assign(int numSets, int numSlots)
+			{
+				numWords = (numSlots + 63) / 64;
+				bits.assign(static_cast<size_t>(numSets) * numWords, 0);
+			}
+			inline uint64_t *operator[](int set) { return bits.data() + static_cast<size_t>(set) * numWords; }
+			inline const uint64_t *operator[](int set) const { return bits.data() + static_cast<size_t>(set) * numWords; }
+			inline bool test(int set, int slot) const { return ((*this)[set][slot >> 6] >> (slot & 63)) & 1; }
+		};
+	}
+
+	struct FX8010::Optimizer
+	{
+		FX8010 &dsp;
+		std::vector<Instruction> &code;
+		std::vector<GPR> &registers;
+		OptimizerReport &report;
+
+		int numRegisters = 0;
+		int zero = -1;		   // Literal 0.0 fuer unbenutzte Operanden der internen Opcodes
+		int noiseRegister = -1; // Register "noise" (falls deklariert)
+
+		std::vector<bool> isWritten; // Ziel mindestens einer Instruktion
+		std::vector<bool> isBounded; // Wert liegt immer in [-1.0, 1.0] (Saturation aendert nichts)
+		// Wert vom Beginn des Samplezyklus wird gelesen. Den kann der Host gesetzt haben
+		// (setRegisterValue(), Events, HotSwap), der Startwert sagt dann nichts ueber den Wertebereich.
+		std::vector<bool> isEntryLive;
+		bool knownControlFlow = false; // nach check(), erst dann gibt es Liveness
+
+		Optimizer(FX8010 &dsp_)
+			: dsp(dsp_), code(dsp_.instructions), registers(dsp_.registers), report(dsp_.optimizerReport)
+		{
+			numRegisters = static_cast<int>(registers.size());
+			noiseRegister = dsp.findRegisterIndexByName(registers, "noise");
+		}
+
+		// Akkumulator als zusaetzlicher Slot hinter den Registern (Liveness)
+		inline int accumulatorSlot() { return numRegisters; }
+
+		static bool isArithmetic(int opcode)
+		{
+			return (opcode >= MACS && opcode <= INTERP && opcode != SKIP) || opcode == MOVS || opcode == ADDS || opcode == MULS;
+		}
+
+		static bool isSaturating(int opcode)
+		{
+			switch (opcode)
+			{
+			case MACS:
+			case MACSN:
+			case MACINTS:
+			case ACC3:
+			case INTERP:
+			case MOVS:
+			case ADDS:
+			case MULS:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		// Liest die Instruktion Operand k (2 = A, 3 = X, 4 = Y)?
+		bool usesOperand(const Instruction &instruction, int k)
+		{
+			switch (instruction.opcode)
+			{
+			case MOVS:
+				return k == 2;
+			case ADDS:
+				return k == 2 || k == 3;
+			case MULS:
+				return k == 3 || k == 4;
+			case SKIP:
+				return k == 3 || k == 4;
+			case IDELAY:
+			case XDELAY:
+			{
+				const int type = registers[instruction.operand1].registerType;
+				if (type == READ)
+					return k == 4;
+				if (type == WRITE)
+					return k == 2 || k == 4;
+				return false;
+			}
+			case END:
+				return false;
+			default:
+				return true;
+			}
+		}
+
+		static int &operandRef(Instruction &instruction, int k)
+		{
+			return (k == 2) ? instruction.operand2 : ((k == 3) ? instruction.operand3 : instruction.operand4);
+		}
+
+		static int operandOf(const Instruction &instruction, int k)
+		{
+			return (k == 2) ? instruction.operand2 : ((k == 3) ? instruction.operand3 : instruction.operand4);
+		}
+
+		// Geschriebene Register bzw. Slots (CCR = Register 0, Akkumulator = accumulatorSlot())
+		void defsOf(const Instruction &instruction, std::vector<int> &defs)
+		{
+			defs.clear();
+			if (isArithmetic(instruction.opcode))
+			{
+				defs.push_back(instruction.operand1);
+				defs.push_back(0);
+				if (instruction.opcode != ANDXOR)
+					defs.push_back(accumulatorSlot());
+			}
+			else if ((instruction.opcode == IDELAY || instruction.opcode == XDELAY) && registers[instruction.operand1].registerType == READ)
+				defs.push_back(instruction.operand2);
+			if (instruction.hasNoise && noiseRegister >= 0)
+				defs.push_back(noiseRegister);
+		}
+
+		void usesOf(const Instruction &instruction, std::vector<int> &uses)
+		{
+			uses.clear();
+			for (int k = 2; k <= 4; k++)
+				if (usesOperand(instruction, k))
+					uses.push_back(operandOf(instruction, k));
+			if (instruction.opcode == SKIP)
+				uses.push_back(0);
+			if (instruction.opcode == MACMV)
+				uses.push_back(accumulatorSlot());
+		}
+
+		inline bool isConstant(int index)
+		{
+			return !isWritten[index] && (registers[index].isLiteral || registers[index].registerType == CONST);
+		}
+
+		inline float valueOf(int index) { return registers[index].initValue; }
+
+		inline bool isConstantValue(int index, float value)
+		{
+			return isConstant(index) && valueOf(index) == value;
+		}
+
+		// Literal mit dem Wert anlegen bzw. vorhandenes wiederverwenden
+		int constantRegister(float value)
+		{
+			for (int i = 0; i < numRegisters; i++)
+			{
+				if (registers[i].isLiteral && !isWritten[i] && memcmp(&registers[i].initValue, &value, sizeof(float)) == 0)
+					return i;
+			}
+			std::ostringstream name;
+			name << std::setprecision(9) << value;
+			GPR reg;
+			reg.registerType = STATIC;
+			reg.registerName = name.str();
+			reg.initValue = value;
+			reg.isLiteral = true;
+			registers.push_back(reg);
+			isWritten.push_back(false);
+			isBounded.push_back(value >= -1.0f && value <= 1.0f);
+			isEntryLive.push_back(false);
+			numRegisters++;
+			return numRegisters - 1;
+		}
+
+		// isWritten, isEntryLive und isBounded fuer den aktuellen Befehlsstrom
+		void analyzeRegisters()
+		{
+			isWritten.assign(numRegisters, false);
+			std::vector<bool> unboundedWrite(numRegisters, false);
+			std::vector<int> defs;
+			for (const auto &instruction : code)
+			{
+				defsOf(instruction, defs);
+				for (int d : defs)
+				{
+					if (d >= numRegisters)
+						continue;
+					isWritten[d] = true;
+					// Saturierende Opcodes liefern immer [-1.0, 1.0]
+					if (!(isArithmetic(instruction.opcode) && d == instruction.operand1 && isSaturating(instruction.opcode)))
+						unboundedWrite[d] = true;
+				}
+			}
+
+			isEntryLive.assign(numRegisters, true);
+			if (knownControlFlow)
+			{
+				SlotSets liveIn, liveOut;
+				liveness(liveIn, liveOut);
+				for (int i = 0; i < numRegisters; i++)
+					isEntryLive[i] = liveIn.test(0, i);
+			}
+
+			// Beschreibbare Register sind nur beschraenkt, wenn jeder gelesene Wert aus diesem
+			// Samplezyklus stammt (wie bei CONTROL kann der Host sonst beliebige Werte schreiben)
+			isBounded.assign(numRegisters, false);
+			for (int i = 0; i < numRegisters; i++)
+			{
+				const GPR &reg = registers[i];
+				if (i == 0 || i == noiseRegister)
+					continue;
+				if (isConstant(i))
+					isBounded[i] = reg.initValue >= -1.0f && reg.initValue <= 1.0f;
+				else if (!reg.isLiteral && (reg.registerType == TEMP || reg.registerType == STATIC || reg.registerType == OUTPUT))
+					isBounded[i] = !unboundedWrite[i] && !isEntryLive[i];
+			}
+		}
+
+		// Quelltext einer Instruktion fuer den Report
+		std::string text(const Instruction &instruction)
+		{
+			std::string name;
+			switch (instruction.opcode)
+			{
+			case MOVS:
+				name = "movs";
+				break;
+			case ADDS:
+				name = "adds";
+				break;
+			case MULS:
+				name = "muls";
+				break;
+			default:
+				for (const auto &entry : dsp.opcodeMap)
+					if (entry.second == instruction.opcode)
+						name = entry.first;
+				break;
+			}
+			if (instruction.opcode == END)
+				return name;
+			return name + " " + registers[instruction.operand1].registerName + ", " + registers[instruction.operand2].registerName + ", " +
+				   registers[instruction.operand3].registerName + ", " + registers[instruction.operand4].registerName;
+		}
+
+		void log(const char *action, const Instruction &before, const std::string &after)
+		{
+			OptimizerEntry entry;
+			entry.row = before.row;
+			entry.action = action;
+			entry.before = text(before);
+			entry.after = after;
+			report.entries.push_back(entry);
+		}
+
+		// I/O Flags nach dem Umschreiben der Operanden
+		void updateFlags(Instruction &instruction)
+		{
+			instruction.hasInput = false;
+			for (int k = 2; k <= 4; k++)
+				if (registers[operandRef(instruction, k)].registerType == INPUT)
+					instruction.hasInput = true;
+			instruction.hasOutput = registers[instruction.operand1].registerType == OUTPUT;
+		}
+
+		void rewrite(Instruction &instruction, int opcode, int A, int X, int Y)
+		{
+			instruction.opcode = opcode;
+			instruction.operand2 = A;
+			instruction.operand3 = X;
+			instruction.operand4 = Y;
+			updateFlags(instruction);
+		}
+
+		// Sprungziel eines SKIP (-1: kein Sprung)
+		int skipTarget(int i)
+		{
+			const int numInstructions = static_cast<int>(code.size());
+			int numSkip = static_cast<int>(valueOf(code[i].operand4));
+			if (numSkip == 0)
+				return -1;
+			// wie im Interpreter: negativer Zaehler ueberspringt genau 1 Instruktion, Wraparound ueber END
+			if (numSkip < 0)
+				numSkip = 1;
+			return static_cast<int>((static_cast<int64_t>(i) + 1 + numSkip) % numInstructions);
+		}
+
+		// Nachfolger im Kontrollfluss (END -> naechster Samplezyklus wird getrennt behandelt)
+		void successors(int i, std::vector<int> &next)
+		{
+			next.clear();
+			const int numInstructions = static_cast<int>(code.size());
+			if (i + 1 < numInstructions)
+				next.push_back(i + 1);
+			if (code[i].opcode == SKIP)
+			{
+				const int target = skipTarget(i);
+				if (target >= 0 && target != i + 1)
+					next.push_back(target);
+			}
+		}
+
+		// Kann der Optimierer das Programm bearbeiten?
+		bool check()
+		{
+			if (code.empty() || code.back().opcode != END)
+			{
+				report.skippedReason = "Programm endet nicht mit END";
+				return false;
+			}
+			analyzeRegisters();
+			for (const auto &instruction : code)
+			{
+				if (instruction.opcode == SKIP && !isConstant(instruction.operand4))
+				{
+					report.skippedReason = "SKIP mit variabler Sprungweite (Zeile " + std::to_string(instruction.row) + ")";
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// 1. + 2. Konstantenfaltung und Strength Reduction
+		//----------------------------------------------------------------
+		bool fold(Instruction &instruction)
+		{
+			if (instruction.hasNoise || instruction.opcode == MOVS)
+				return false;
+			if (!isArithmetic(instruction.opcode))
+				return false;
+			for (int k = 2; k <= 4; k++)
+				if (usesOperand(instruction, k) && !isConstant(operandOf(instruction, k)))
+					return false;
+
+			const float A = valueOf(instruction.operand2);
+			const float X = valueOf(instruction.operand3);
+			const float Y = valueOf(instruction.operand4);
+			auto wrap = [](const float a)
+			{
+				return (a >= 1.0f) ? a - 2.0f : ((a < -1.0f) ? a + 2.0f : a);
+			};
+
+			// Gleiche Ausdruecke wie im Interpreter, damit das Ergebnis bitgleich ist
+			float r;
+			switch (instruction.opcode)
+			{
+			case MACS:
+			case MACINTS:
+				r = A + X * Y;
+				break;
+			case MACSN:
+				r = A - X * Y;
+				break;
+			case ACC3:
+				r = A + X + Y;
+				break;
+			case INTERP:
+				r = (1.0 - X) * A + (X * Y);
+				break;
+			case ADDS:
+				r = A + X;
+				break;
+			case MULS:
+				r = X * Y;
+				break;
+			case MACW:
+				r = A + wrap(X * Y);
+				break;
+			case MACWN:
+				r = A - wrap(X * Y);
+				break;
+			case MACINTW:
+				r = wrap(A + X * Y);
+				break;
+			case LIMIT:
+				r = A >= Y ? X : Y;
+				break;
+			case LIMITN:
+				r = A < Y ? X : Y;
+				break;
+			case LOG:
+				r = logLinear(A, static_cast<int32_t>(X), static_cast<int32_t>(Y));
+				break;
+			case EXP:
+				r = expLinear(A, static_cast<int32_t>(X), static_cast<int32_t>(Y));
+				break;
+			default:
+				// TSTNEG/ANDXOR (Bitmuster), MACMV (Akkumulator)
+				return false;
+			}
+			// MOVS saturiert: nicht saturierende Opcodes nur falten, wenn das Ergebnis in [-1.0, 1.0] liegt
+			if (!isSaturating(instruction.opcode) && !(r >= -1.0f && r <= 1.0f))
+				return false;
+			if (r != r)
+				return false;
+
+			const Instruction before = instruction;
+			rewrite(instruction, MOVS, constantRegister(r), zero, zero);
+			log("fold", before, text(instruction));
+			report.foldedConstants++;
+			return true;
+		}
+
+		bool reduce(Instruction &instruction)
+		{
+			if (instruction.hasNoise)
+				return false;
+			const int opcode = instruction.opcode;
+			if (opcode != MACS && opcode != MACINTS && opcode != MACSN)
+				return false;
+
+			const int A = instruction.operand2;
+			const int X = instruction.operand3;
+			const int Y = instruction.operand4;
+			const Instruction before = instruction;
+
+			// Werte bis auf das Vorzeichen von Null gleich (A + X * 0.0 = A)
+			if (isConstantValue(X, 0.0f) || isConstantValue(Y, 0.0f))
+				rewrite(instruction, MOVS, A, zero, zero);
+			else if (opcode == MACSN)
+				return false;
+			else if (isConstantValue(A, 0.0f))
+				rewrite(instruction, MULS, zero, X, Y);
+			else if (isConstantValue(X, 1.0f))
+				rewrite(instruction, ADDS, A, Y, zero);
+			else if (isConstantValue(Y, 1.0f))
+				rewrite(instruction, ADDS, A, X, zero);
+			else
+				return false;
+
+			log("reduce", before, text(instruction));
+			report.reducedInstructions++;
+			return true;
+		}
+
+		// 3. Copy Propagation
+		//----------------------------------------------------------------
+		// Verfuegbare Kopien (must): copyOf[r] = s heisst "r hat hier auf allen Pfaden den Wert von s".
+		// MOVS R, A ist nur eine Kopie, wenn A nie ausserhalb [-1.0, 1.0] liegt (sonst saturiert MOVS).
+		bool isCopy(const Instruction &instruction)
+		{
+			if (instruction.opcode != MOVS || instruction.hasNoise)
+				return false;
+			const int R = instruction.operand1;
+			const int A = instruction.operand2;
+			return R != A && R != 0 && A != 0 && R != noiseRegister && A != noiseRegister && isBounded[A];
+		}
+
+		void transfer(const Instruction &instruction, std::vector<int> &copyOf, std::vector<int> &defs)
+		{
+			int source = -1;
+			if (isCopy(instruction))
+				source = (copyOf[instruction.operand2] >= 0) ? copyOf[instruction.operand2] : instruction.operand2;
+
+			defsOf(instruction, defs);
+			for (int d : defs)
+			{
+				if (d >= numRegisters)
+					continue;
+				copyOf[d] = -1;
+				for (int r = 0; r < numRegisters; r++)
+					if (copyOf[r] == d)
+						copyOf[r] = -1;
+			}
+			if (source >= 0 && source != instruction.operand1)
+				copyOf[instruction.operand1] = source;
+		}
+
+		bool propagateCopies()
+		{
+			const int numInstructions = static_cast<int>(code.size());
+			std::vector<std::vector<int>> in(numInstructions);
+			std::vector<bool> reached(numInstructions, false);
+			std::vector<int> defs, next, state;
+
+			// Samplezyklus beginnt ohne Kopien (Host kann zwischen den Zyklen Register setzen)
+			in[0].assign(numRegisters, -1);
+			reached[0] = true;
+
+			bool changed = true;
+			while (changed)
+			{
+				changed = false;
+				for (int i = 0; i < numInstructions; i++)
+				{
+					if (!reached[i])
+						continue;
+					state = in[i];
+					transfer(code[i], state, defs);
+					successors(i, next);
+					for (int s : next)
+					{
+						if (s == 0)
+							continue;
+						if (!reached[s])
+						{
+							in[s] = state;
+							reached[s] = true;
+							changed = true;
+							continue;
+						}
+						for (int r = 0; r < numRegisters; r++)
+						{
+							if (in[s][r] >= 0 && in[s][r] != state[r])
+							{
+								in[s][r] = -1;
+								changed = true;
+							}
+						}
+					}
+				}
+			}
+
+			bool modified = false;
+			for (int i = 0; i < numInstructions; i++)
+			{
+				if (!reached[i])
+					continue;
+				Instruction &instruction = code[i];
+				const Instruction before = instruction;
+				int replaced = 0;
+				for (int k = 2; k <= 4; k++)
+				{
+					if (!usesOperand(instruction, k))
+						continue;
+					int &operand = operandRef(instruction, k);
+					if (in[i][operand] >= 0)
+					{
+						operand = in[i][operand];
+						replaced++;
+					}
+				}
+				if (replaced > 0)
+				{
+					updateFlags(instruction);
+					log("copy", before, text(instruction));
+					report.propagatedCopies += replaced;
+					modified = true;
+				}
+			}
+			return modified;
+		}
+
+		// 4. Tote Schreibzugriffe
+		//----------------------------------------------------------------
+		// Liveness (rueckwaerts ueber den Kontrollfluss), Slots: Register, CCR = 0, Akkumulator
+		// Bitmengen je Instruktion und Worklist: nur Vorgaenger einer geaenderten Instruktion
+		// werden neu berechnet (Programme mit einigen tausend Zeilen beim Laden und im HotSwap)
+		void liveness(SlotSets &liveIn, SlotSets &liveOut)
+		{
+			const int numInstructions = static_cast<int>(code.size());
+			const int numSlots = numRegisters + 1;
+			liveIn.assign(numInstructions, numSlots);
+			liveOut.assign(numInstructions, numSlots);
+			const int numWords = liveOut.numWords;
+
+			// Nach dem Samplezyklus liest der Host die OUTPUT Register
+			std::vector<uint64_t> observable(numWords, 0);
+			for (int r = 0; r < numRegisters; r++)
+				if (registers[r].registerType == OUTPUT)
+					observable[r >> 6] |= uint64_t(1) << (r & 63);
+
+			// Definierte/gelesene Slots je Instruktion und Vorgaenger
+			// END: weiter im naechsten Samplezyklus (STATIC, CCR, Akkumulator bleiben erhalten)
+			SlotSets defSets, useSets;
+			defSets.assign(numInstructions, numSlots);
+			useSets.assign(numInstructions, numSlots);
+			std::vector<std::vector<int>> predecessors(numInstructions);
+			std::vector<int> defs, uses, next;
+			for (int i = 0; i < numInstructions; i++)
+			{
+				defsOf(code[i], defs);
+				usesOf(code[i], uses);
+				for (int d : defs)
+					defSets[i][d >> 6] |= uint64_t(1) << (d & 63);
+				for (int u : uses)
+					useSets[i][u >> 6] |= uint64_t(1) << (u & 63);
+				if (i == numInstructions - 1)
+					predecessors[0].push_back(i);
+				else
+				{
+					successors(i, next);
+					for (int n : next)
+						predecessors[n].push_back(i);
+				}
+			}
+
+			// Rueckwaerts abarbeiten, dann konvergiert es meist in einem Durchlauf
+			std::vector<int> worklist;
+			std::vector<bool> queued(numInstructions, true);
+			worklist.reserve(numInstructions);
+			for (int i = 0; i < numInstructions; i++)
+				worklist.push_back(i);
+
+			while (!worklist.empty())
+			{
+				const int i = worklist.back();
+				worklist.pop_back();
+				queued[i] = false;
+
+				uint64_t *out = liveOut[i];
+				if (i == numInstructions - 1)
+				{
+					const uint64_t *first = liveIn[0];
+					for (int w = 0; w < numWords; w++)
+						out[w] = observable[w] | first[w];
+				}
+				else
+				{
+					successors(i, next);
+					std::fill(out, out + numWords, 0);
+					for (int n : next)
+					{
+						const uint64_t *in = liveIn[n];
+						for (int w = 0; w < numWords; w++)
+							out[w] |= in[w];
+					}
+				}
+
+				uint64_t *in = liveIn[i];
+				const uint64_t *def = defSets[i];
+				const uint64_t *use = useSets[i];
+				bool changed = false;
+				for (int w = 0; w < numWords; w++)
+				{
+					const uint64_t live = (out[w] & ~def[w]) | use[w];
+					changed = changed || live != in[w];
+					in[w] = live;
+				}
+				if (!changed)
+					continue;
+				for (int p : predecessors[i])
+				{
+					if (!queued[p])
+					{
+						queued[p] = true;
+						worklist.push_back(p);
+					}
+				}
+			}
+		}
+
+		bool removeDeadWrites()
+		{
+			const int numInstructions = static_cast<int>(code.size());
+			SlotSets liveIn, liveOut;
+			std::vector<int> defs;
+			liveness(liveIn, liveOut);
+
+			std::vector<bool> removed(numInstructions, false);
+			bool modified = false;
+			for (int i = 0; i < numInstructions; i++)
+			{
+				const Instruction &instruction = code[i];
+				if (!isArithmetic(instruction.opcode) || instruction.hasNoise)
+					continue;
+				const GPR &R = registers[instruction.operand1];
+				if (R.isLiteral || (R.registerType != TEMP && R.registerType != STATIC) || instruction.operand1 == noiseRegister)
+					continue;
+				defsOf(instruction, defs);
+				bool dead = true;
+				for (int d : defs)
+					dead = dead && !liveOut.test(i, d);
+				if (!dead)
+					continue;
+				removed[i] = true;
+				log("dead", instruction, "");
+				report.removedDeadWrites++;
+				modified = true;
+			}
+			if (modified)
+				compact(removed);
+			return modified;
+		}
+
+		// Entfernt Instruktionen und passt die SKIP Sprungweiten an
+		void compact(const std::vector<bool> &removed)
+		{
+			const int numInstructions = static_cast<int>(code.size());
+			// Neue Position je alter Position, entfernte Instruktionen -> naechste verbleibende
+			std::vector<int> newIndex(numInstructions);
+			int count = 0;
+			for (int i = 0; i < numInstructions; i++)
+			{
+				newIndex[i] = count;
+				if (!removed[i])
+					count++;
+			}
+
+			std::vector<int> targets(numInstructions, -1);
+			for (int i = 0; i < numInstructions; i++)
+				if (!removed[i] && code[i].opcode == SKIP)
+					targets[i] = skipTarget(i);
+
+			std::vector<Instruction> compacted;
+			compacted.reserve(count);
+			for (int i = 0; i < numInstructions; i++)
+			{
+				if (removed[i])
+					continue;
+				Instruction instruction = code[i];
+				if (targets[i] >= 0)
+				{
+					const int numSkip = ((newIndex[targets[i]] - newIndex[i] - 1) % count + count) % count;
+					if (static_cast<float>(numSkip) != valueOf(instruction.operand4) && !(numSkip == 1 && valueOf(instruction.operand4) < 0))
+						instruction.operand4 = constantRegister(static_cast<float>(numSkip));
+				}
+				compacted.push_back(instruction);
+			}
+			code.swap(compacted);
+		}
+
+		// 5. Wertebereiche (flussunabhaengig: je Register die Huelle aller geschriebenen Werte)
+		//----------------------------------------------------------------
+		// Ergebnis vor der Saturation
+		Range rawRange(const Instruction &instruction, const std::vector<Range> &ranges)
+		{
+			const Range &A = ranges[instruction.operand2];
+			const Range &X = ranges[instruction.operand3];
+			const Range &Y = ranges[instruction.operand4];
+			switch (instruction.opcode)
+			{
+			case MACS:
+			case MACINTS:
+				return add(A, multiply(X, Y));
+			case MACSN:
+				return add(A, negate(multiply(X, Y)));
+			case ACC3:
+				return add(add(A, X), Y);
+			case INTERP:
+				return interpolated(A, X, Y);
+			case MOVS:
+				return A;
+			case ADDS:
+				return add(A, X);
+			case MULS:
+				return multiply(X, Y);
+			case MACW:
+				return add(A, wrapped(multiply(X, Y)));
+			case MACWN:
+				return add(A, negate(wrapped(multiply(X, Y))));
+			case MACINTW:
+				return wrapped(add(A, multiply(X, Y)));
+			case MACMV:
+				return A;
+			case LIMIT:
+			case LIMITN:
+				return hull(X, Y);
+			case LOG:
+			case EXP:
+				return {-1.0f, 1.0f};
+			default:
+				// TSTNEG/ANDXOR (Bitmuster)
+				return UNKNOWN;
+			}
+		}
+
+		void computeRanges(std::vector<Range> &ranges)
+		{
+			ranges.assign(numRegisters, UNKNOWN);
+			for (int i = 0; i < numRegisters; i++)
+			{
+				const GPR &reg = registers[i];
+				if (i == 0)
+					ranges[i] = {0.0f, 20.0f}; // CCR Bitmuster
+				else if (isConstant(i))
+					ranges[i] = {reg.initValue, reg.initValue};
+				else if (i != noiseRegister && !isEntryLive[i] && (reg.registerType == TEMP || reg.registerType == STATIC || reg.registerType == OUTPUT))
+					ranges[i] = {reg.initValue, reg.initValue}; // Startwert wird nie gelesen
+				// INPUT, CONTROL, vom Host beschreibbare Register mit gelesenem Startwert und NOISE bleiben unbekannt
+			}
+
+			// Fixpunkt, Register die nach einigen Runden noch wachsen werden unbekannt (Widening)
+			const int maxRounds = 8;
+			bool changed = true;
+			for (int round = 0; changed; round++)
+			{
+				changed = false;
+				for (const auto &instruction : code)
+				{
+					int target = -1;
+					Range value = UNKNOWN;
+					if (instruction.opcode == IDELAY || instruction.opcode == XDELAY)
+					{
+						// TRAM ist unbekannt: FX8010HotSwap uebernimmt beim Wechsel den Inhalt des alten Programms
+						if (registers[instruction.operand1].registerType == READ)
+							target = instruction.operand2;
+					}
+					else if (isArithmetic(instruction.opcode))
+					{
+						target = instruction.operand1;
+						value = rawRange(instruction, ranges);
+						if (isSaturating(instruction.opcode))
+							value = saturated(value);
+					}
+					if (target <= 0 || target == noiseRegister || contains(ranges[target], value))
+						continue;
+					ranges[target] = (round < maxRounds) ? hull(ranges[target], value) : UNKNOWN;
+					changed = true;
+				}
+			}
+		}
+
+		// writesCCR/saturates je Instruktion fuer die Engines
+		void annotate()
+		{
+			SlotSets liveIn, liveOut;
+			if (knownControlFlow)
+				liveness(liveIn, liveOut);
+			std::vector<Range> ranges;
+			computeRanges(ranges);
+			const Range unit = {-1.0f, 1.0f};
+
+			for (size_t i = 0; i < code.size(); i++)
+			{
+				Instruction &instruction = code[i];
+				instruction.writesCCR = true;
+				instruction.saturates = true;
+				if (!isArithmetic(instruction.opcode))
+					continue;
+				// R = CCR: setCCR() ueberschreibt das Ergebnis, muss also bleiben
+				if (knownControlFlow && !liveOut.test(i, 0) && instruction.operand1 != 0)
+				{
+					instruction.writesCCR = false;
+					report.elidedCCR++;
+				}
+				if (isSaturating(instruction.opcode) && contains(unit, rawRange(instruction, ranges)))
+				{
+					instruction.saturates = false;
+					report.elidedSaturation++;
+				}
+			}
+		}
+
+		void run()
+		{
+			report.instructionsBefore = static_cast<int>(code.size());
+			report.instructionsAfter = report.instructionsBefore;
+			if (!check())
+			{
+				// Ohne bekannten Kontrollfluss bleibt nur die Saturations-Analyse
+				analyzeRegisters();
+				annotate();
+				return;
+			}
+			knownControlFlow = true;
+			zero = constantRegister(0.0f);
+
+			// Jede Runde kann neue Gelegenheiten fuer die anderen Passes schaffen
+			const int maxRounds = 32;
+			for (int round = 0; round < maxRounds; round++)
+			{
+				bool changed = false;
+				analyzeRegisters();
+				for (auto &instruction : code)
+					changed |= fold(instruction) || reduce(instruction);
+				analyzeRegisters();
+				changed |= propagateCopies();
+				analyzeRegisters();
+				changed |= removeDeadWrites();
+				if (!changed)
+					break;
+			}
+			report.instructionsAfter = static_cast<int>(code.size());
+			analyzeRegisters();
+			annotate();
+		}
+	};
+
+	// CHECKED
+	void FX8010::optimize()
+	{
+		optimizerReport = OptimizerReport();
+		optimizerReport.enabled = optimizerEnabled;
+		optimizerReport.instructionsBefore = static_cast<int>(instructions.size());
+		optimizerReport.instructionsAfter = optimizerReport.instructionsBefore;
+		if (!optimizerEnabled)
+		{
+			for (auto &instruction : instructions)
+			{
+				instruction.writesCCR = true;
+				instruction.saturates = true;
+			}
+			return;
+		}
+
+		Optimizer optimizer(*this);
+		optimizer.run();
+
+		if (DEBUG)
+		{
+			cout << "Optimierer: " << optimizerReport.instructionsBefore << " -> " << optimizerReport.instructionsAfter << " Instruktionen";
+			cout << ", " << optimizerReport.elidedCCR << " ohne CCR, " << optimizerReport.elidedSaturation << " ohne Saturation";
+			if (!optimizerReport.skippedReason.empty())
+				cout << " (nicht optimiert: " << optimizerReport.skippedReason << ")";
+			cout << endl;
+			for (const auto &entry : optimizerReport.entries)
+				cout << "  Zeile " << entry.row << " " << entry.action << ": " << entry.before << " -> " << (entry.after.empty() ? "entfernt" : entry.after) << endl;
+		}
+	}
+
+} // namespace Klangraum
@@ -0,0 +1,36 @@
+// Copyright 2023 Klangraum
+
+#include "../include/FX8010Rack.h"
+
+namespace Klangraum
+{
+	// CHECKED
+	int FX8010Rack::addInstance(const std::string &path, int numChannels)
+	{
+		std::unique_ptr<Slot> slot(new Slot(numChannels));
+		if (!slot->program.loadFile(path))
+		{
+			if (DEBUG)
+				cout << "Rack: " << path << " konnte nicht geladen werden" << endl;
+			return -1;
+		}
+		slots.push_back(std::move(slot));
+		return static_cast<int>(slots.size()) - 1;
+	}
+
+	void FX8010Rack::processInstance(void *context, int index)
+	{
+		FX8010Rack &rack = *static_cast<FX8010Rack *>(context);
+		rack.slots[index]->program.processBlock(rack.blockInputs[index], rack.blockOutputs[index], rack.blockFrames);
+	}
+
+	// CHECKED
+	void FX8010Rack::processBlock(const float *const *const *inputs, float *const *const *outputs, int numFrames)
+	{
+		blockInputs = inputs;
+		blockOutputs = outputs;
+		blockFrames = numFrames;
+		pool.run(getNumInstances(), &FX8010Rack::processInstance, this);
+	}
+
+} // namespace Klangraum
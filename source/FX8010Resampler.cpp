@@ -0,0 +1,257 @@
+// Copyright 2023 Klangraum
+
+#include "../include/FX8010.h"
+#include "../include/FX8010Resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace Klangraum
+{
+	// std::min() bindet per Referenz, ohne Definition fehlt das Symbol bei -O0 und mit Sanitizern
+	const int FX8010::RESAMPLER_CHUNK;
+	const int PolyphaseResampler::SIMD_WIDTH;
+
+	namespace
+	{
+		const double RESAMPLER_PI = 3.14159265358979323846;
+		// Sperrdaempfung 80 dB (Kaiser: beta = 0.1102 * (A - 8.7), Uebergang = (A - 8) / (2.285 * 2 pi) / N)
+		const double RESAMPLER_ATTENUATION = 80.0;
+
+		// modifizierte Besselfunktion 0. Ordnung (Reihe) fuer das Kaiser-Fenster
+		double besselI0(const double x)
+		{
+			double sum = 1.0;
+			double term = 1.0;
+			const double q = x * x * 0.25;
+			for (int k = 1; k < 64; k++)
+			{
+				term *= q / (static_cast<double>(k) * k);
+				sum += term;
+				if (term < sum * 1e-16)
+					break;
+			}
+			return sum;
+		}
+	}
+
+	void PolyphaseResampler::setup(int numChannels_, int inputRate_, int outputRate, int maxPushFrames, int tapsPerPhase)
+	{
+		numChannels = std::max(numChannels_, 1);
+		inputRate = std::max(inputRate_, 1);
+		outputRate = std::max(outputRate, 1);
+		const int divisor = std::gcd(inputRate, outputRate);
+		upFactor = outputRate / divisor;
+		downFactor = inputRate / divisor;
+		taps = (std::max(tapsPerPhase, SIMD_WIDTH) + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+
+		design();
+
+		// Verlauf + ein push() + Vorlauf, compact() schafft vor jedem push() Platz
+		capacity = taps + 2 * std::max(maxPushFrames, 1) + maxOutputFrames(std::max(maxPushFrames, 1)) + 64;
+		history.assign(numChannels, std::vector<float, AlignedAllocator<float, 64>>(capacity, 0.0f));
+		reset();
+	}
+
+	void PolyphaseResampler::design()
+	{
+		// Prototyp mit L * taps Koeffizienten auf der Zwischenrate L * inputRate
+		const int length = upFactor * taps;
+		const double upRate = static_cast<double>(upFactor) * inputRate;
+		const double nyquist = 0.5 * std::min(static_cast<double>(inputRate), upRate / downFactor);
+		// Uebergangsbereich endet bei Nyquist der kleineren Rate
+		const double transition = (RESAMPLER_ATTENUATION - 8.0) / (2.285 * 2.0 * RESAMPLER_PI) * upRate / length;
+		const double cutoff = std::max(nyquist - 0.5 * transition, 0.25 * nyquist) / upRate; // normiert auf upRate
+		const double beta = 0.1102 * (RESAMPLER_ATTENUATION - 8.7);
+		const double center = 0.5 * (length - 1);
+		const double windowScale = 1.0 / besselI0(beta);
+
+		std::vector<double> prototype(length);
+		for (int n = 0; n < length; n++)
+		{
+			const double t = n - center;
+			const double sinc = (t == 0.0) ? 2.0 * cutoff : std::sin(2.0 * RESAMPLER_PI * cutoff * t) / (RESAMPLER_PI * t);
+			const double ratio = t / (center + 1.0);
+			const double window = besselI0(beta * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) * windowScale;
+			// Verstaerkung L (Nullen der Interpolation)
+			prototype[n] = sinc * window * upFactor;
+		}
+
+		// Phase p, Tap k (0 = juengstes Sample) = prototype[p + k * L], zeitlich umgekehrt abgelegt
+		coefficients.assign(static_cast<size_t>(upFactor) * taps, 0.0f);
+		for (int p = 0; p < upFactor; p++)
+			for (int k = 0; k < taps; k++)
+				coefficients[static_cast<size_t>(p) * taps + (taps - 1 - k)] = static_cast<float>(prototype[p + k * upFactor]);
+	}
+
+	void PolyphaseResampler::reset(int primingFrames)
+	{
+		primingFrames = std::max(0, std::min(primingFrames, capacity - taps));
+		for (auto &channel : history)
+			std::fill(channel.begin(), channel.end(), 0.0f);
+		// Verlauf aus Nullen, das erste Eingangssample liegt hinter dem Vorlauf
+		fill = taps - 1 + primingFrames;
+		readIndex = taps - 1;
+		phase = 0;
+	}
+
+	void PolyphaseResampler::compact()
+	{
+		const int first = readIndex - (taps - 1);
+		if (first <= 0)
+			return;
+		const int remaining = std::max(fill - first, 0);
+		for (auto &channel : history)
+			std::memmove(channel.data(), channel.data() + first, remaining * sizeof(float));
+		fill -= first;
+		readIndex -= first;
+	}
+
+	void PolyphaseResampler::push(const float *const *inputs, int numFrames)
+	{
+		compact();
+		// mehr als die Kapazitaet: die aeltesten Frames verwerfen (darf bei korrektem maxPushFrames nicht passieren)
+		numFrames = std::min(numFrames, capacity - fill);
+		if (numFrames <= 0)
+			return;
+		for (int c = 0; c < numChannels; c++)
+			std::memcpy(history[c].data() + fill, inputs[c], numFrames * sizeof(float));
+		fill += numFrames;
+	}
+
+	int PolyphaseResampler::available() const
+	{
+		// Ausgangssample m nutzt readIndex + floor((phase + m * M) / L) <= fill - 1
+		const int64_t spare = static_cast<int64_t>(fill) - 1 - readIndex;
+		if (spare < 0)
+			return 0;
+		return static_cast<int>((spare * upFactor + upFactor - 1 - phase) / downFactor + 1);
+	}
+
+	int PolyphaseResampler::maxOutputFrames(int numInputFrames) const
+	{
+		return static_cast<int>((static_cast<int64_t>(numInputFrames) * upFactor + downFactor - 1) / downFactor) + 1;
+	}
+
+	void PolyphaseResampler::pull(float *const *outputs, int numFrames)
+	{
+		for (int i = 0; i < numFrames; i++)
+		{
+			// Unterlauf: fehlende Eingangssamples als 0 anhaengen
+			if (readIndex >= fill)
+			{
+				compact();
+				const int missing = std::min(readIndex - fill + 1, capacity - fill);
+				for (auto &channel : history)
+					std::fill(channel.begin() + fill, channel.begin() + fill + missing, 0.0f);
+				fill += missing;
+			}
+
+			const float *h = coefficients.data() + static_cast<size_t>(phase) * taps;
+			const int first = readIndex - (taps - 1);
+			for (int c = 0; c < numChannels; c++)
+			{
+				const float *x = history[c].data() + first;
+				// unabhaengige Teilsummen -> vektorisierbar ohne Umordnung der Additionen
+				float sum[SIMD_WIDTH] = {};
+				for (int k = 0; k < taps; k += SIMD_WIDTH)
+					for (int l = 0; l < SIMD_WIDTH; l++)
+						sum[l] += h[k + l] * x[k + l];
+				float y = 0.0f;
+				for (int l = 0; l < SIMD_WIDTH; l++)
+					y += sum[l];
+				outputs[c][i] = y;
+			}
+
+			phase += downFactor;
+			readIndex += phase / upFactor;
+			phase %= upFactor;
+		}
+	}
+
+	double PolyphaseResampler::getLatencySeconds() const
+	{
+		// symmetrischer Prototyp: (N - 1) / 2 Samples auf der Zwischenrate
+		return 0.5 * (static_cast<double>(upFactor) * taps - 1.0) / (static_cast<double>(upFactor) * inputRate);
+	}
+
+	size_t PolyphaseResampler::getMemoryFootprint() const
+	{
+		size_t bytes = coefficients.capacity() * sizeof(float) + history.capacity() * sizeof(history[0]);
+		for (const auto &channel : history)
+			bytes += channel.capacity() * sizeof(float);
+		return bytes;
+	}
+
+	// FX8010: Resampler vor und hinter dem Programm
+	//----------------------------------------------------------------
+
+	// CHECKED
+	bool FX8010::setHostSampleRate(int sampleRate)
+	{
+		if (sampleRate <= 0)
+			return false;
+		hostSampleRate = sampleRate;
+		setupResampler();
+		return true;
+	}
+
+	void FX8010::setupResampler()
+	{
+		resamplerLatency = 0;
+		if (hostSampleRate == SAMPLERATE || numChannels <= 0)
+			return;
+
+		inputResampler.setup(numChannels, hostSampleRate, SAMPLERATE, RESAMPLER_CHUNK);
+		resamplerCoreFrames = inputResampler.maxOutputFrames(RESAMPLER_CHUNK);
+		outputResampler.setup(numChannels, SAMPLERATE, hostSampleRate, resamplerCoreFrames + RESAMPLER_PRIMING);
+		inputResampler.reset();
+		outputResampler.reset(RESAMPLER_PRIMING);
+
+		// Laufzeit beider Filter + Vorlauf, in Host-Samples
+		const double latency = inputResampler.getLatencySeconds() + outputResampler.getLatencySeconds() + static_cast<double>(RESAMPLER_PRIMING) / SAMPLERATE;
+		resamplerLatency = static_cast<int>(std::lround(latency * hostSampleRate));
+
+		// 48 kHz Puffer fuer Ein- und Ausgang des Programms, planar
+		resamplerBuffer.assign(static_cast<size_t>(2 * numChannels) * resamplerCoreFrames, 0.0f);
+		resamplerCoreInputs.resize(numChannels);
+		resamplerCoreOutputs.resize(numChannels);
+		resamplerHostInputs.resize(numChannels);
+		resamplerHostOutputs.resize(numChannels);
+		for (int c = 0; c < numChannels; c++)
+		{
+			resamplerCoreInputs[c] = resamplerBuffer.data() + static_cast<size_t>(c) * resamplerCoreFrames;
+			resamplerCoreOutputs[c] = resamplerBuffer.data() + static_cast<size_t>(numChannels + c) * resamplerCoreFrames;
+		}
+
+		if (DEBUG)
+			cout << "Resampler: " << hostSampleRate << " Hz <-> " << SAMPLERATE << " Hz, L/M = " << inputResampler.getUpFactor() << "/" << inputResampler.getDownFactor() << ", Latenz " << resamplerLatency << " Samples" << endl;
+	}
+
+	// Host-Block in Abschnitten von RESAMPLER_CHUNK Frames: Host -> 48 kHz -> Programm -> Host
+	void FX8010::processBlockResampled(const float *const *inputs, float *const *outputs, int numFrames)
+	{
+		for (int offset = 0; offset < numFrames; offset += RESAMPLER_CHUNK)
+		{
+			const int chunk = std::min(RESAMPLER_CHUNK, numFrames - offset);
+			for (int c = 0; c < numChannels; c++)
+			{
+				resamplerHostInputs[c] = inputs[c] + offset;
+				resamplerHostOutputs[c] = outputs[c] + offset;
+			}
+
+			inputResampler.push(resamplerHostInputs.data(), chunk);
+			const int coreFrames = std::min(inputResampler.available(), resamplerCoreFrames);
+			inputResampler.pull(resamplerCoreInputs.data(), coreFrames);
+
+			// Programm mit 48 kHz
+			processBlockCore(resamplerCoreInputs.data(), resamplerCoreOutputs.data(), coreFrames);
+
+			outputResampler.push(resamplerCoreOutputs.data(), coreFrames);
+			outputResampler.pull(resamplerHostOutputs.data(), chunk);
+		}
+	}
+
+} // namespace Klangraum
@@ -0,0 +1,145 @@
+// Copyright 2023 Klangraum
+
+#include "../include/FX8010.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Klangraum
+{
+	namespace
+	{
+		// Tiefpass: darunter gilt das Ziel als erreicht
+		const float SMOOTHING_EPSILON = 1e-6f;
+	}
+
+	void FX8010::setupSmoothing()
+	{
+		smootherOf.clear();
+		smootherHandle.clear();
+		smootherType.clear();
+		smootherTime.clear();
+		numActiveSmoothers = 0;
+		smoothingCountdown = 0;
+
+		for (const auto &reg : registers)
+		{
+			if (reg.registerType != CONTROL || reg.smoothingType == SMOOTHING_NONE || reg.smoothingTime <= 0 || reg.valueIndex < 0 || reg.valueIndex >= constantSegmentStart)
+				continue;
+			smootherHandle.push_back(reg.valueIndex);
+			smootherType.push_back(reg.smoothingType);
+			smootherTime.push_back(reg.smoothingTime);
+		}
+
+		const size_t numSmoothers = smootherHandle.size();
+		smootherRemaining.assign(numSmoothers, 0);
+		smootherCurrent.resize(numSmoothers);
+		smootherTarget.resize(numSmoothers);
+		smootherIncrement.assign(numSmoothers, 0.0f);
+		smootherCoefficient.assign(numSmoothers, 0.0f);
+		smootherLinear.resize(numSmoothers);
+		if (numSmoothers == 0)
+			return;
+
+		smootherOf.assign(registerValues.size(), -1);
+		for (size_t k = 0; k < numSmoothers; k++)
+		{
+			smootherOf[smootherHandle[k]] = static_cast<int>(k);
+			smootherCurrent[k] = smootherTarget[k] = registerValues[smootherHandle[k]];
+			smootherLinear[k] = (smootherType[k] == SMOOTHING_LINEAR) ? 1.0f : 0.0f;
+		}
+
+		if (DEBUG)
+			cout << "Glaettung: " << numSmoothers << " Controls" << endl;
+	}
+
+	// CHECKED
+	bool FX8010::setRegisterSmoothing(int handle, SmoothingType type, float milliseconds)
+	{
+		for (auto &reg : registers)
+		{
+			if (reg.valueIndex != handle || reg.registerType != CONTROL || reg.isLiteral)
+				continue;
+			reg.smoothingType = type;
+			reg.smoothingTime = milliseconds;
+			setupSmoothing();
+			return true;
+		}
+		return false;
+	}
+
+	void FX8010::swapSmoothers(int a, int b)
+	{
+		if (a == b)
+			return;
+		std::swap(smootherHandle[a], smootherHandle[b]);
+		std::swap(smootherType[a], smootherType[b]);
+		std::swap(smootherTime[a], smootherTime[b]);
+		std::swap(smootherRemaining[a], smootherRemaining[b]);
+		std::swap(smootherCurrent[a], smootherCurrent[b]);
+		std::swap(smootherTarget[a], smootherTarget[b]);
+		std::swap(smootherIncrement[a], smootherIncrement[b]);
+		std::swap(smootherCoefficient[a], smootherCoefficient[b]);
+		std::swap(smootherLinear[a], smootherLinear[b]);
+		smootherOf[smootherHandle[a]] = a;
+		smootherOf[smootherHandle[b]] = b;
+	}
+
+	void FX8010::setSmoothingTarget(int k, float value)
+	{
+		smootherTarget[k] = value;
+		// Zeit in Schritten zu SMOOTHING_STEP Host-Samples
+		const float steps = smootherTime[k] * 0.001f * hostSampleRate / SMOOTHING_STEP;
+		if (smootherType[k] == SMOOTHING_LINEAR)
+		{
+			smootherRemaining[k] = std::max(1, static_cast<int>(std::lround(steps)));
+			smootherIncrement[k] = (value - smootherCurrent[k]) / smootherRemaining[k];
+		}
+		else
+			smootherCoefficient[k] = 1.0f - std::exp(-1.0f / std::max(steps, 1e-3f));
+
+		// Laufende Smoother liegen vorne
+		if (k >= numActiveSmoothers)
+		{
+			if (numActiveSmoothers == 0)
+				smoothingCountdown = 0;
+			swapSmoothers(k, numActiveSmoothers);
+			numActiveSmoothers++;
+		}
+	}
+
+	// CHECKED
+	void FX8010::advanceSmoothing()
+	{
+		const int n = numActiveSmoothers;
+		float *current = smootherCurrent.data();
+		const float *target = smootherTarget.data();
+		const float *increment = smootherIncrement.data();
+		const float *coefficient = smootherCoefficient.data();
+		const float *linear = smootherLinear.data();
+
+		// Beide Formen rechnen und waehlen, ohne Verzweigung (vektorisierbar)
+		for (int k = 0; k < n; k++)
+		{
+			const float ramp = current[k] + increment[k];
+			const float lag = current[k] + coefficient[k] * (target[k] - current[k]);
+			current[k] = (linear[k] != 0.0f) ? ramp : lag;
+		}
+
+		// Register schreiben, fertige Smoother ans Ende der laufenden tauschen (von hinten, damit
+		// jeder Smoother genau einmal drankommt)
+		for (int k = n - 1; k >= 0; k--)
+		{
+			const bool finished = (smootherType[k] == SMOOTHING_LINEAR) ? (--smootherRemaining[k] <= 0) : (std::fabs(target[k] - current[k]) <= SMOOTHING_EPSILON);
+			if (finished)
+				current[k] = target[k];
+			storeRegisterValue(smootherHandle[k], current[k]);
+			if (finished)
+			{
+				numActiveSmoothers--;
+				swapSmoothers(k, numActiveSmoothers);
+			}
+		}
+	}
+
+} // namespace Klangraum
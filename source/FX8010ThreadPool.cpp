@@ -0,0 +1,158 @@
+// Copyright 2023 Klangraum
+
+#include "../include/FX8010ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace Klangraum
+{
+	namespace
+	{
+		const int RANGE_BITS = 22;
+		const uint64_t RANGE_MASK = (1ull << RANGE_BITS) - 1;
+		const uint32_t EPOCH_MASK = (1u << 20) - 1;
+		// Hoechstens so viele Aufgaben je run()
+		const int MAX_TASKS = static_cast<int>(RANGE_MASK);
+
+		inline uint64_t makeRange(const uint32_t epoch, const int top, const int bottom)
+		{
+			return (static_cast<uint64_t>(epoch & EPOCH_MASK) << (2 * RANGE_BITS)) | (static_cast<uint64_t>(top) << RANGE_BITS) | static_cast<uint64_t>(bottom);
+		}
+		inline uint32_t rangeEpoch(const uint64_t range) { return static_cast<uint32_t>(range >> (2 * RANGE_BITS)); }
+		inline int rangeTop(const uint64_t range) { return static_cast<int>((range >> RANGE_BITS) & RANGE_MASK); }
+		inline int rangeBottom(const uint64_t range) { return static_cast<int>(range & RANGE_MASK); }
+	}
+
+	FX8010ThreadPool::FX8010ThreadPool(int numThreads)
+	{
+		if (numThreads < 0)
+			numThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0);
+		numQueues = numThreads + 1;
+		queues.reset(new Queue[numQueues]);
+		for (int i = 1; i < numQueues; i++)
+			threads.emplace_back(&FX8010ThreadPool::workerLoop, this, i);
+	}
+
+	FX8010ThreadPool::~FX8010ThreadPool()
+	{
+		stopThreads.store(true);
+		for (auto &thread : threads)
+			thread.join();
+	}
+
+	// CHECKED
+	void FX8010ThreadPool::run(int numTasks, Task task, void *context)
+	{
+		if (numTasks <= 0)
+			return;
+		// Ohne Worker oder mit einer Aufgabe lohnt die Verteilung nicht
+		if (threads.empty() || numTasks == 1 || numTasks > MAX_TASKS)
+		{
+			for (int i = 0; i < numTasks; i++)
+				task(context, i);
+			return;
+		}
+
+		// Alle Worker haben den vorigen Auftrag abgeschlossen (remaining == 0), Queues neu fuellen
+		const uint32_t e = (epoch.load(std::memory_order_relaxed) + 1) & EPOCH_MASK;
+		for (int q = 0; q < numQueues; q++)
+		{
+			const int top = static_cast<int>(static_cast<int64_t>(numTasks) * q / numQueues);
+			const int bottom = static_cast<int>(static_cast<int64_t>(numTasks) * (q + 1) / numQueues);
+			queues[q].range.store(makeRange(e, top, bottom), std::memory_order_relaxed);
+		}
+		currentTask.store(task, std::memory_order_relaxed);
+		currentContext.store(context, std::memory_order_relaxed);
+		remaining.store(numTasks, std::memory_order_relaxed);
+		epoch.store(e, std::memory_order_release);
+
+		const int done = execute(0, e, task, context);
+		if (remaining.fetch_sub(done, std::memory_order_acq_rel) == done)
+			return;
+		while (remaining.load(std::memory_order_acquire) > 0)
+			std::this_thread::yield();
+	}
+
+	bool FX8010ThreadPool::pop(int queue, uint32_t e, int &index)
+	{
+		std::atomic<uint64_t> &range = queues[queue].range;
+		uint64_t observed = range.load(std::memory_order_acquire);
+		for (;;)
+		{
+			const int top = rangeTop(observed);
+			const int bottom = rangeBottom(observed);
+			if (rangeEpoch(observed) != e || top >= bottom)
+				return false;
+			if (range.compare_exchange_weak(observed, makeRange(e, top, bottom - 1), std::memory_order_acq_rel, std::memory_order_acquire))
+			{
+				index = bottom - 1;
+				return true;
+			}
+		}
+	}
+
+	bool FX8010ThreadPool::steal(int queue, uint32_t e)
+	{
+		for (int k = 1; k < numQueues; k++)
+		{
+			std::atomic<uint64_t> &victim = queues[(queue + k) % numQueues].range;
+			uint64_t observed = victim.load(std::memory_order_acquire);
+			for (;;)
+			{
+				const int top = rangeTop(observed);
+				const int bottom = rangeBottom(observed);
+				if (rangeEpoch(observed) != e || top >= bottom)
+					break;
+				// vordere Haelfte (mindestens eine Aufgabe), der Besitzer arbeitet von hinten
+				const int take = (bottom - top + 1) / 2;
+				if (victim.compare_exchange_weak(observed, makeRange(e, top + take, bottom), std::memory_order_acq_rel, std::memory_order_acquire))
+				{
+					// Eigene Queue ist leer, andere Diebe lassen sie deshalb in Ruhe
+					queues[queue].range.store(makeRange(e, top, top + take), std::memory_order_release);
+					stealCount.fetch_add(1, std::memory_order_relaxed);
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	int FX8010ThreadPool::execute(int queue, uint32_t e, Task task, void *context)
+	{
+		int done = 0;
+		int index;
+		do
+		{
+			while (pop(queue, e, index))
+			{
+				task(context, index);
+				done++;
+			}
+		} while (steal(queue, e));
+		return done;
+	}
+
+	void FX8010ThreadPool::workerLoop(int queue)
+	{
+		uint32_t lastEpoch = epoch.load(std::memory_order_acquire);
+		int idle = 0;
+		while (!stopThreads.load(std::memory_order_relaxed))
+		{
+			const uint32_t e = epoch.load(std::memory_order_acquire);
+			if (e != lastEpoch)
+			{
+				lastEpoch = e;
+				const int done = execute(queue, e, currentTask.load(std::memory_order_relaxed), currentContext.load(std::memory_order_relaxed));
+				if (done > 0)
+					remaining.fetch_sub(done, std::memory_order_acq_rel);
+				idle = 0;
+			}
+			else if (++idle < 4096)
+				std::this_thread::yield();
+			else
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+		}
+	}
+
+} // namespace Klangraum
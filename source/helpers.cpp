@@ -20,10 +20,21 @@ namespace Klangraum
 
     bool isNumber(const std::string &input)
     {
-        // Regulärer Ausdruck für eine Zahl mit optionaler Dezimalstelle
-        std::regex numberRegex("^-?\\d+(\\.\\d+)?$");
-
-        return std::regex_match(input, numberRegex);
+        // Zahl mit optionaler Dezimalstelle: -?\d+(\.\d+)?
+        size_t i = (!input.empty() && input[0] == '-') ? 1 : 0;
+        const size_t digits = i;
+        while (i < input.size() && std::isdigit(static_cast<unsigned char>(input[i])))
+            i++;
+        if (i == digits)
+            return false;
+        if (i == input.size())
+            return true;
+        if (input[i] != '.')
+            return false;
+        const size_t fraction = ++i;
+        while (i < input.size() && std::isdigit(static_cast<unsigned char>(input[i])))
+            i++;
+        return i > fraction && i == input.size();
     }
 
     // https://stackoverflow.com/questions/66206815/how-to-change-the-ouput-color-in-the-terminal-of-visual-code
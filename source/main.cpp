@@ -1,11 +1,33 @@
 // Copyright 2023 Klangraum
 
 #include "../include/FX8010.h"
+#include "../include/FX8010CompileCache.h"
+#include "../include/FX8010HotSwap.h"
+#include "../include/FX8010Lanes.h"
 #include "../include/helpers.h"
 
+#include <filesystem>
+
 using namespace Klangraum;
 
 #define SLIDER_TEST 1
+#define ENGINE_AB_TEST 1 // MIPS-Vergleich der Interpreter
+#define AB_TEST_BLOCKS 10000
+#define LANES_TEST 1 // Durchsatz: Instanzen einzeln (decoded) vs. FX8010Lanes
+#define LANES_TEST_INSTANCES 16
+#define RESAMPLER_TEST 1 // Kosten der Samplerate-Wandlung vs. Programm direkt mit Hostrate
+#define RESAMPLER_HOST_RATE 44100
+#define LOAD_TEST 1 // Ladezeit eines grossen generierten Programms (Parser)
+#define LOAD_TEST_LINES 4096
+#define PARSER_TEST 1 // Regression: generierte Programme gegen die Referenz des Regex-Parsers (../corpus/parser.txt)
+#define PARSER_TEST_PROGRAMS 800
+#define PARSER_TEST_WRITE 0 // 1 = Referenz neu schreiben statt vergleichen
+#define HOTSWAP_TEST 1 // Live-Editing: Programmwechsel im Hintergrund, laengster Audioblock
+#define HOTSWAP_EDITS 8
+#define BYTECODE_TEST 1 // Start vieler Instanzen: Sourcecode vs. Bytecode (mmap)
+#define BYTECODE_INSTANCES 256
+#define COMPILE_CACHE_TEST 1 // Presetwechsel: loadFile() vs. Nachschlagen im Compile-Cache
+#define COMPILE_CACHE_SWITCHES 256
 
 int main()
 {
@@ -69,12 +91,12 @@ int main()
         diracImpulse.push_back(0.0f);
     }
 
-    // Lege I/O Buffer an
-    // Diese enthalten einzelne Samples fuer mehrere Kanäle! process() wird 1x je Sample aufgerufen.
-    std::vector<float> inputBuffer;
-    inputBuffer.resize(numChannels, 0.0);
-    std::vector<float> outputBuffer;
-    outputBuffer.resize(numChannels, 0.0);
+    // Lege planare I/O Buffer an (je Kanal ein Block mit AUDIOBLOCKSIZE Samples)
+    // processBlock() verarbeitet einen ganzen (Teil-)Block ohne Heap-Allokation.
+    std::vector<std::vector<float>> inputBlock(numChannels, std::vector<float>(AUDIOBLOCKSIZE, 0.0f));
+    std::vector<std::vector<float>> outputBlock(numChannels, std::vector<float>(AUDIOBLOCKSIZE, 0.0f));
+    std::vector<const float *> inputPointers(numChannels);
+    std::vector<float *> outputPointers(numChannels);
 
     // 4 virtuelle Sliderwerte
     std::vector<float> sliderValues = {0.1, 0.25, 0.5, 1.0};
@@ -83,7 +105,7 @@ int main()
     double tolerance = 1e-4;
     // DC-Testvalue zum Testen des virtuellen Sliderinputs
     //----------------------------------------------------------------
-    // Simply put a static value into inputBuffer[j] = 1.0
+    // Simply put a static value into inputBlock[j][i] = 1.0
 
     // Sourcecode Laden und Parsen
     if (fx8010->loadFile("testcode.da"))
@@ -95,45 +117,54 @@ int main()
             cout << endl;
         }
 
+        for (int j = 0; j < numChannels; j++)
+        {
+            for (int i = 0; i < AUDIOBLOCKSIZE; i++)
+            {
+                inputBlock[j][i] = bipolarRamp[i];
+            }
+        }
+
         // Startzeitpunkt speichern
         auto startTime = std::chrono::high_resolution_clock::now();
 
-        // Call the process() method to execute the instructions
-        // Here we do Stereo processing.
-        for (int i = 0; i < AUDIOBLOCKSIZE; i++)
+        // Simuliere Sliderinput alle 8 Samples
+        //----------------------------------------------------------------
+        if (SLIDER_TEST)
         {
-            // Simuliere Sliderinput alle 8 Samples
-            //----------------------------------------------------------------
-            if (SLIDER_TEST)
-            {
-                if (i % 8 == 0)
-                {
-                    // Hier wird das Label zum DSP Control-Typ bzw. Slider genutzt, um Register im DSP zu aendern
-                    fx8010->setRegisterValue("volume", sliderValues[i / 8]);
-                }
-            }
+            // Hier wird das Label zum DSP Control-Typ bzw. Slider genutzt, um Register im DSP zu aendern.
+            // Die Events gelten sample-genau, processBlock() teilt den Block selbst.
+            const int volume = fx8010->getRegisterHandle("volume");
+            const int64_t blockStart = fx8010->getSampleTime();
+            for (int i = 0; i < AUDIOBLOCKSIZE; i += 8)
+                fx8010->pushParameterEvent(volume, sliderValues[i / 8], blockStart + i);
+        }
 
-            for (int j = 0; j < numChannels; j++)
-            {
-                inputBuffer[j] = bipolarRamp[i];
-            }
+        for (int j = 0; j < numChannels; j++)
+        {
+            inputPointers[j] = inputBlock[j].data();
+            outputPointers[j] = outputBlock[j].data();
+        }
+
+        // Hier erfolgt die Berechnung
+        fx8010->processBlock(inputPointers.data(), outputPointers.data(), AUDIOBLOCKSIZE);
 
-            // Hier erfolgt die Berechnung
-            outputBuffer = fx8010->process(inputBuffer);
+        // Endzeitpunkt speichern
+        auto endTime = std::chrono::high_resolution_clock::now();
 
-            // DSP Output anzeigen
-            // NOTE: Anzeige beeinflusst Zeitmessung stark! Fuer aussagekraeftige Zeitmessung DEBUG und PRINT_REGISTERS auf 0 setzen!
-            if (DEBUG)
+        // DSP Output anzeigen
+        // NOTE: Anzeige erfolgt nach dem Block, beeinflusst die Zeitmessung daher nicht mehr.
+        if (DEBUG)
+        {
+            for (int i = 0; i < AUDIOBLOCKSIZE; i++)
             {
                 // CSV Output, kann direkt in https://www.desmos.com/ genutzt werden
                 // NOTE: Desmos zeigt sehr kleine Werte falsch an!
                 // Deshalb runden wir auf 0, wenn tolerance = 1e-4 unterschritten wird!
 
-                cout << ((std::abs(bipolarRamp[i]) < tolerance) ? 0.0 : bipolarRamp[i]) << "," << ((std::abs(outputBuffer[0]) < tolerance) ? 0.0 : outputBuffer[0]) << endl;
-
-                // cout << ((std::abs(inputBuffer[0]) < tolerance) ? 0.0 : inputBuffer[0]) << "," << ((std::abs(outputBuffer[0]) < tolerance) ? 0.0 : outputBuffer[0]) << endl;
+                cout << ((std::abs(bipolarRamp[i]) < tolerance) ? 0.0 : bipolarRamp[i]) << "," << ((std::abs(outputBlock[0][i]) < tolerance) ? 0.0 : outputBlock[0][i]) << endl;
 
-                // std::cout << "(" << ((std::abs(bipolarRamp[i]) < tolerance) ? 0.0 : bipolarRamp[i]) << " , " << ((std::abs(outputBuffer[0]) < tolerance) ? 0.0 : outputBuffer[0]) << ")" << std::endl; // CVS Daten in Console (als punktfolge für https://www.desmos.com/)
+                // std::cout << "(" << ((std::abs(bipolarRamp[i]) < tolerance) ? 0.0 : bipolarRamp[i]) << " , " << ((std::abs(outputBlock[0][i]) < tolerance) ? 0.0 : outputBlock[0][i]) << ")" << std::endl; // CVS Daten in Console (als punktfolge für https://www.desmos.com/)
 
                 // data.push_back({ std::to_string(testSample[i]) , std::to_string(R) }); // CVS Daten in Vector zum speichern
             }
@@ -143,9 +174,6 @@ int main()
 
         // if (!(DEBUG || PRINT_REGISTERS))
         //{
-        // Endzeitpunkt speichern
-        auto endTime = std::chrono::high_resolution_clock::now();
-
         // Berechnen der Differenz zwischen Start- und Endzeitpunkt
         auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
 
@@ -159,6 +187,463 @@ int main()
 
         std::cout << endl;
 
+        // A/B Vergleich der Interpreter (MIPS)
+        //----------------------------------------------------------------
+        if (ENGINE_AB_TEST)
+        {
+            const Klangraum::FX8010::EngineType engines[] = {Klangraum::FX8010::ENGINE_SWITCH, Klangraum::FX8010::ENGINE_DECODED, Klangraum::FX8010::ENGINE_DECODED, Klangraum::FX8010::ENGINE_DECODED, Klangraum::FX8010::ENGINE_JIT, Klangraum::FX8010::ENGINE_FIXED};
+            const Klangraum::FX8010::Precision precisions[] = {Klangraum::FX8010::PRECISION_REFERENCE, Klangraum::FX8010::PRECISION_REFERENCE, Klangraum::FX8010::PRECISION_FAST, Klangraum::FX8010::PRECISION_ACCURATE, Klangraum::FX8010::PRECISION_REFERENCE, Klangraum::FX8010::PRECISION_REFERENCE};
+            const char *engineNames[] = {"switch", "decoded", "decoded fast", "decoded accurate", "jit", "fixed (Q31)"};
+            const Klangraum::FX8010::EngineType previousEngine = fx8010->getEngineType();
+
+            for (int j = 0; j < numChannels; j++)
+            {
+                inputPointers[j] = inputBlock[j].data();
+                outputPointers[j] = outputBlock[j].data();
+            }
+
+            for (int e = 0; e < 6; e++)
+            {
+                fx8010->setPrecision(precisions[e]);
+                if (!fx8010->setEngineType(engines[e]))
+                {
+                    cout << "Interpreter '" << engineNames[e] << "' nicht verfuegbar" << endl;
+                    continue;
+                }
+                const int instructionsBefore = fx8010->getInstructionCounter();
+                auto abStart = std::chrono::high_resolution_clock::now();
+                for (int b = 0; b < AB_TEST_BLOCKS; b++)
+                {
+                    fx8010->processBlock(inputPointers.data(), outputPointers.data(), AUDIOBLOCKSIZE);
+                }
+                auto abEnd = std::chrono::high_resolution_clock::now();
+                const double us = std::chrono::duration<double, std::micro>(abEnd - abStart).count();
+                const double executed = static_cast<double>(fx8010->getInstructionCounter() - instructionsBefore);
+                cout << "Interpreter '" << engineNames[e] << "': " << us / AB_TEST_BLOCKS << " Mikrosekunden je Audioblock, "
+                     << executed / us << " MIPS" << endl;
+            }
+            fx8010->setPrecision(Klangraum::FX8010::PRECISION_REFERENCE);
+            fx8010->setEngineType(previousEngine);
+
+            std::cout << endl;
+        }
+
+        // Mehrere Busse mit demselben Programm: einzeln vs. lane-parallel
+        //----------------------------------------------------------------
+        if (LANES_TEST)
+        {
+            const int numInstances = LANES_TEST_INSTANCES;
+            Klangraum::FX8010Lanes lanes(*fx8010, numInstances);
+
+            // Alle Instanzen lesen/schreiben denselben Testblock
+            std::vector<const float *> laneInputs(numInstances * numChannels);
+            std::vector<float *> laneOutputs(numInstances * numChannels);
+            for (int k = 0; k < numInstances; k++)
+                for (int j = 0; j < numChannels; j++)
+                {
+                    laneInputs[k * numChannels + j] = inputBlock[j].data();
+                    laneOutputs[k * numChannels + j] = outputBlock[j].data();
+                }
+
+            const Klangraum::FX8010::EngineType previousEngine = fx8010->getEngineType();
+            fx8010->setEngineType(Klangraum::FX8010::ENGINE_DECODED);
+            auto scalarStart = std::chrono::high_resolution_clock::now();
+            for (int b = 0; b < AB_TEST_BLOCKS; b++)
+                for (int k = 0; k < numInstances; k++)
+                    fx8010->processBlock(inputPointers.data(), outputPointers.data(), AUDIOBLOCKSIZE);
+            auto scalarEnd = std::chrono::high_resolution_clock::now();
+            fx8010->setEngineType(previousEngine);
+
+            auto lanesStart = std::chrono::high_resolution_clock::now();
+            for (int b = 0; b < AB_TEST_BLOCKS; b++)
+                lanes.processBlock(laneInputs.data(), laneOutputs.data(), AUDIOBLOCKSIZE);
+            auto lanesEnd = std::chrono::high_resolution_clock::now();
+
+            const double scalarUs = std::chrono::duration<double, std::micro>(scalarEnd - scalarStart).count();
+            const double lanesUs = std::chrono::duration<double, std::micro>(lanesEnd - lanesStart).count();
+            cout << numInstances << " Instanzen einzeln (decoded): " << scalarUs / AB_TEST_BLOCKS << " Mikrosekunden je Audioblock" << endl;
+            cout << numInstances << " Instanzen lane-parallel (" << lanes.getLaneWidth() << " Lanes): "
+                 << lanesUs / AB_TEST_BLOCKS << " Mikrosekunden je Audioblock, "
+                 << static_cast<double>(lanes.getInstructionCounter()) / lanesUs << " MIPS" << endl;
+
+            std::cout << endl;
+        }
+
+        // Samplerate-Wandlung: Programm direkt mit Hostrate vs. Host -> 48 kHz -> Host
+        //----------------------------------------------------------------
+        if (RESAMPLER_TEST)
+        {
+            const int rates[] = {SAMPLERATE, RESAMPLER_HOST_RATE};
+            double rateUs[2] = {0.0, 0.0};
+            for (int r = 0; r < 2; r++)
+            {
+                fx8010->setHostSampleRate(rates[r]);
+                auto resamplerStart = std::chrono::high_resolution_clock::now();
+                for (int b = 0; b < AB_TEST_BLOCKS; b++)
+                    fx8010->processBlock(inputPointers.data(), outputPointers.data(), AUDIOBLOCKSIZE);
+                auto resamplerEnd = std::chrono::high_resolution_clock::now();
+                rateUs[r] = std::chrono::duration<double, std::micro>(resamplerEnd - resamplerStart).count() / AB_TEST_BLOCKS;
+            }
+            cout << "Ohne Resampler (Hostrate): " << rateUs[0] << " Mikrosekunden je Audioblock" << endl;
+            cout << "Mit Resampler (" << RESAMPLER_HOST_RATE << " Hz <-> " << SAMPLERATE << " Hz): " << rateUs[1]
+                 << " Mikrosekunden je Audioblock, +" << rateUs[1] - rateUs[0] << " Mikrosekunden, Latenz "
+                 << fx8010->getLatency() << " Samples" << endl;
+            fx8010->setHostSampleRate(SAMPLERATE);
+
+            std::cout << endl;
+        }
+
+        if (LOAD_TEST)
+        {
+            // Deklarationen, Instruktionen mit Literalen und Kommentaren, wie ein grosses Preset
+            std::ostringstream program;
+            program << "name \"load test\"\ninput in_l 0\noutput out_l 0\n";
+            for (int i = 0; i < LOAD_TEST_LINES / 2; i++)
+                program << "static s" << i << " = 0." << i % 10 << " ; Kommentar\n";
+            for (int i = 0; i < LOAD_TEST_LINES / 2; i++)
+                program << "macs s" << i << ", s" << (i + 1) % (LOAD_TEST_LINES / 2) << ", in_l, 0." << i % 7 << "\n";
+            program << "macs out_l, s0, s1, 0.5\nend\n";
+            const std::string source = program.str();
+
+            // Ohne Optimierer misst nur Parser und Layout, mit Optimierer die ganze Ladezeit
+            for (int optimized = 0; optimized < 2; optimized++)
+            {
+                Klangraum::FX8010 loadTest(numChannels);
+                loadTest.setOptimizerEnabled(optimized != 0);
+                auto loadStart = std::chrono::high_resolution_clock::now();
+                const bool loaded = loadTest.loadFromString(source);
+                auto loadEnd = std::chrono::high_resolution_clock::now();
+                const double loadMs = std::chrono::duration<double, std::milli>(loadEnd - loadStart).count();
+                cout << "Laden " << (optimized ? "mit" : "ohne") << " Optimierer (" << LOAD_TEST_LINES + 5 << " Zeilen, " << (loaded ? "OK" : "Fehler") << "): "
+                     << loadMs << " ms, " << (LOAD_TEST_LINES + 5) / loadMs << " Zeilen je ms" << endl;
+            }
+
+            std::cout << endl;
+        }
+
+        if (PARSER_TEST)
+        {
+            // Regressionstest fuer den Parser: generierte Programme aus gueltigen und kaputten Zeilen
+            // (Deklarationen, TRAM-Groessen, Instruktionen, Metadaten, Kommentare, Muell). Je Programm
+            // wird ein Fingerabdruck aus Ladeergebnis, Fehlerliste, Registern und Metadaten mit
+            // ../corpus/parser.txt verglichen. Die Referenz stammt vom alten Regex-Parser.
+            // Festes LCG statt <random>, damit die Programme auf jeder Plattform gleich sind.
+            uint64_t seed = 0;
+            auto next = [&seed](int range)
+            {
+                seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+                return static_cast<int>((seed >> 33) % static_cast<uint64_t>(range));
+            };
+            auto pick = [&next](const std::vector<std::string> &list) { return list[next(static_cast<int>(list.size()))]; };
+
+            // Gueltige Bausteine ...
+            const std::vector<std::string> names = {"a", "b", "gain", "x1", "s_2", "in_l", "out_l", "fb", "lfo", "k"};
+            const std::vector<std::string> types = {"static", "temp", "control", "const", "Static", "CONTROL"};
+            const std::vector<std::string> values = {"", "", " = 0.5", "=1", " 0.25", ", 3", "  =  0.75"};
+            const std::vector<std::string> suffixes = {"", "", ", ramp 20", " lag 5", ", lag 1.5"};
+            const std::vector<std::string> opcodes = {"macs", "macsn", "macw", "macwn", "macints", "macintw", "acc3", "macmv", "andxor",
+                                                      "tstneg", "limit", "limitn", "log", "exp", "interp", "MACS"};
+            const std::vector<std::string> literals = {"0.5", "-1", "0", "1.0", "0.125", "ccr"};
+            const std::vector<std::string> separators = {", ", ",", " , ", " ,"};
+            const std::vector<std::string> metadata = {"name \"test\"", "guid \"1234-abcd\"", "copyright \"Klangraum\"", "engine \"kX\"", "created \"2023\""};
+            // ... und Grenzfaelle, die meisten davon sind Fehler
+            const std::vector<std::string> corners = {
+                "static a1.5", "static a1.5 ramp 2", "control k = 0.5 ramp", "control k ramp 0", "static s_2, ramp 20", "control k, smooth 3",
+                "static b = -0.75", "static b = 1e-3", "static b = .5", "static b =", "static b = abc", "temp b 0x10", "const b = 2.5.1",
+                "input in_l 3", "output out_l", "stat a", "static", "static a b",
+                "itramsize 100", "xtramsize  ", "xtramsize 2000 ", "itramsize 50 ; Kommentar", "ITRAMSIZE 8 ", "xtramsize -5 ",
+                "itramsize 1.5 ", "itramsize 99999999999 ",
+                "macs a, b, 0.5", "macs a b c d", "macs a,, b, c, d", "macx a, b, c, d", "macs in_l, a, a, a", "macs undeclared, a, a, a",
+                "macs a, 0.1.2, a, a", "macs a, read, write, at", "skip ccr, ccr, 0x7fffffff, 1", "idelay read, a, at, 10",
+                "name test", "comment \"\"", "name \"a \"b\" c\"", "guid \"x\" y",
+                "foo bar", "end end", "END ; Ende", "= 0.5", "\t", "123", ";;;", "; ; ;", "   ; eingerueckt", "end"};
+
+            auto makeProgram = [&](int index)
+            {
+                seed = 0x9E3779B97F4A7C15ULL ^ static_cast<uint64_t>(index);
+                std::vector<std::string> lines;
+                for (int i = next(3); i > 0; i--)
+                    lines.push_back(pick(metadata));
+                const bool tram = next(3) == 0;
+                if (tram)
+                    lines.push_back("itramsize " + std::to_string(16 + next(200)) + " ");
+
+                // Deklarationen, jeder Name hoechstens einmal
+                std::vector<std::string> declared, writable;
+                for (const auto &name : names)
+                {
+                    if (next(3) == 0)
+                        continue;
+                    declared.push_back(name);
+                    if (name == "in_l")
+                        lines.push_back(next(2) ? "input in_l 0" : "input in_l");
+                    else if (name == "out_l")
+                        lines.push_back(next(2) ? "output out_l 1" : "OUTPUT out_l, 0");
+                    else
+                    {
+                        const std::string type = pick(types);
+                        const std::string value = pick(values);
+                        const bool control = type == "control" || type == "CONTROL";
+                        lines.push_back(type + " " + name + value + (control ? pick(suffixes) : ""));
+                    }
+                    if (name != "in_l")
+                        writable.push_back(name);
+                }
+
+                // Instruktionen auf deklarierte Register und Literale
+                auto operand = [&]() { return (declared.empty() || next(4) == 0) ? pick(literals) : pick(declared); };
+                for (int i = writable.empty() ? 0 : 1 + next(12); i > 0; i--)
+                {
+                    // << legt die Reihenfolge der Zufallszahlen fest, + nicht
+                    std::ostringstream instruction;
+                    if (tram && next(5) == 0)
+                        instruction << "idelay " << (next(2) ? "write" : "read") << pick(separators) << pick(writable) << pick(separators) << "at"
+                                    << pick(separators) << next(16);
+                    else
+                        instruction << pick(opcodes) << " " << pick(writable) << pick(separators) << operand() << pick(separators) << operand()
+                                    << pick(separators) << operand();
+                    lines.push_back(instruction.str());
+                }
+
+                // Kommentare, Leerzeilen und Kommentare am Zeilenende
+                for (auto &line : lines)
+                    if (next(6) == 0)
+                        line += " ; " + pick(names);
+                auto insertLine = [&](const std::string &line)
+                {
+                    const int position = next(static_cast<int>(lines.size()) + 1);
+                    lines.insert(lines.begin() + position, line);
+                };
+                for (int i = next(4); i > 0; i--)
+                    insertLine(next(2) ? "; Kommentar" : (next(2) ? "" : "  \t"));
+
+                // Jedes zweite Programm bekommt Grenzfaelle
+                const bool broken = next(2) == 0;
+                if (broken)
+                    for (int i = 1 + next(3); i > 0; i--)
+                        insertLine(pick(corners));
+                if (!broken || next(4) != 0)
+                    lines.push_back("end");
+
+                std::string program;
+                for (const auto &line : lines)
+                    program += line + "\n";
+                return program;
+            };
+
+            // Fingerabdruck: alles, was der Parser nach aussen sichtbar macht (FNV-1a)
+            auto summarize = [&](const std::string &source)
+            {
+                {
+                    std::ofstream file("parsertest.da", std::ios::binary);
+                    file << source;
+                }
+                Klangraum::FX8010 parserTest(2); // Stereo, unabhaengig von numChannels
+                parserTest.setOptimizerEnabled(false);
+                const bool loaded = parserTest.loadFile("parsertest.da");
+                std::ostringstream summary;
+                summary << (loaded ? "ok" : "error") << "\n";
+                for (const auto &error : parserTest.getErrorList())
+                    summary << "E " << error.errorRow << " " << error.errorDescription << "\n";
+                if (loaded)
+                {
+                    for (const auto &control : parserTest.getControlRegisters())
+                        summary << "C " << control << " " << parserTest.getRegisterValue(control) << "\n";
+                    for (const auto &name : names)
+                        summary << "R " << name << " " << parserTest.getRegisterValue(name) << " " << parserTest.getIOIndex(name) << "\n";
+                    std::map<std::string, std::string> sorted;
+                    for (const auto &pair : parserTest.getMetaData())
+                        sorted.insert(pair);
+                    for (const auto &pair : sorted)
+                        summary << "M " << pair.first << " " << pair.second << "\n";
+                }
+                return summary.str();
+            };
+            auto digest = [](const std::string &text)
+            {
+                uint64_t hash = 14695981039346656037ULL;
+                for (unsigned char c : text)
+                    hash = (hash ^ c) * 1099511628211ULL;
+                std::ostringstream hex;
+                hex << std::hex << std::setw(16) << std::setfill('0') << hash;
+                return hex.str();
+            };
+
+            if (PARSER_TEST_WRITE)
+            {
+                // Referenz neu schreiben, nur nach einer gewollten Aenderung am Parser
+                std::ofstream golden("../corpus/parser.txt");
+                for (int i = 0; i < PARSER_TEST_PROGRAMS; i++)
+                    golden << i << " " << digest(summarize(makeProgram(i))) << "\n";
+                cout << "Parser-Referenz geschrieben: " << PARSER_TEST_PROGRAMS << " Programme" << endl;
+            }
+            else
+            {
+                std::ifstream golden("../corpus/parser.txt");
+                int index = 0, compared = 0, deviations = 0;
+                std::string expected;
+                while (golden >> index >> expected && index < PARSER_TEST_PROGRAMS)
+                {
+                    const std::string source = makeProgram(index);
+                    const std::string summary = summarize(source);
+                    compared++;
+                    if (digest(summary) != expected)
+                    {
+                        if (deviations++ < 3)
+                            cout << "Parser weicht ab, Programm " << index << ":\n" << source << "--\n" << summary << endl;
+                    }
+                }
+                cout << "Parser: " << compared << " Programme verglichen, " << deviations << " Abweichungen"
+                     << (compared == 0 ? " (../corpus/parser.txt fehlt)" : "") << endl;
+            }
+            std::remove("parsertest.da");
+
+            std::cout << endl;
+        }
+
+        if (HOTSWAP_TEST)
+        {
+            // Echo mit Feedback, jede "Bearbeitung" aendert den Mix. Delayline und Controls laufen weiter.
+            auto echoProgram = [](int edit)
+            {
+                std::ostringstream program;
+                program << "itramsize 4096 \ninput in_l 0\noutput out_l 0\ncontrol feedback = 0.5, ramp 10\nstatic rd\nstatic a\n"
+                        << "macs a, in_l, rd, feedback\nidelay write, a, at, 0\nidelay read, rd, at, 4000\n"
+                        << "macs out_l, in_l, rd, 0." << 3 + edit % 4 << "\nend\n";
+                return program.str();
+            };
+
+            Klangraum::FX8010HotSwap hotSwap(numChannels);
+            hotSwap.waitForCompile(hotSwap.compile(echoProgram(0)));
+            if (!hotSwap.getLastResult().success)
+                cout << "HotSwap: Testprogramm fehlerhaft" << endl;
+            hotSwap.setRegisterValue("feedback", 0.7f);
+            // Erstes Programm uebernehmen
+            hotSwap.processBlock(inputPointers.data(), outputPointers.data(), AUDIOBLOCKSIZE);
+
+            double normalUs = 0.0;
+            double swapUs = 0.0;
+            int normalBlocks = 0;
+            double compileMs = 0.0;
+            for (int edit = 1; edit <= HOTSWAP_EDITS; edit++)
+            {
+                const int request = hotSwap.compile(echoProgram(edit));
+                // Weiterrechnen, bis das neue Programm uebernommen ist
+                bool swapped = false;
+                while (!swapped)
+                {
+                    const int swaps = hotSwap.getSwapCount();
+                    auto blockStart = std::chrono::high_resolution_clock::now();
+                    hotSwap.processBlock(inputPointers.data(), outputPointers.data(), AUDIOBLOCKSIZE);
+                    auto blockEnd = std::chrono::high_resolution_clock::now();
+                    const double us = std::chrono::duration<double, std::micro>(blockEnd - blockStart).count();
+                    swapped = hotSwap.getSwapCount() != swaps;
+                    if (swapped)
+                        swapUs = std::max(swapUs, us);
+                    else
+                    {
+                        normalUs += us;
+                        normalBlocks++;
+                    }
+                    if (!swapped && hotSwap.waitForCompile(request, 0) && !hotSwap.getLastResult().success)
+                        break;
+                }
+                compileMs += hotSwap.getLastResult().milliseconds;
+                // Ueberblendung zu Ende rechnen
+                while (hotSwap.isCrossfading())
+                    hotSwap.processBlock(inputPointers.data(), outputPointers.data(), AUDIOBLOCKSIZE);
+            }
+            cout << "HotSwap: " << hotSwap.getSwapCount() - 1 << " Wechsel, Uebersetzen im Hintergrund " << compileMs / HOTSWAP_EDITS
+                 << " ms, Audioblock " << normalUs / std::max(normalBlocks, 1) << " Mikrosekunden (Wechsel: hoechstens " << swapUs
+                 << ")";
+            if (hotSwap.getActiveProgram() != nullptr)
+                cout << ", feedback nach dem letzten Wechsel " << hotSwap.getActiveProgram()->getRegisterValue("feedback");
+            cout << endl;
+
+            std::cout << endl;
+        }
+
+        if (BYTECODE_TEST)
+        {
+            // Bytecode einmal schreiben (wie tools/da-compile.cpp), dann einblenden und viele Instanzen starten
+            // Ins temporaere Verzeichnis, der Test soll keine Dateien im Quellbaum hinterlassen
+            const std::string bytecodePath = (std::filesystem::temp_directory_path() / "testcode.dab").string();
+            {
+                const bool saved = fx8010->saveBytecode(bytecodePath);
+                Klangraum::BytecodeFile bytecode(bytecodePath);
+                double startUs[2] = {0.0, 0.0};
+                bool identical = saved && bytecode.isOpen();
+                for (int mode = 0; mode < 2 && identical; mode++)
+                {
+                    std::vector<std::unique_ptr<Klangraum::FX8010>> instances;
+                    instances.reserve(BYTECODE_INSTANCES);
+                    auto start = std::chrono::high_resolution_clock::now();
+                    for (int i = 0; i < BYTECODE_INSTANCES; i++)
+                    {
+                        instances.emplace_back(new Klangraum::FX8010(numChannels));
+                        const bool loaded = (mode == 0) ? instances.back()->loadFile("testcode.da") : instances.back()->loadBytecodeFromMemory(bytecode.data(), bytecode.getSize());
+                        identical = identical && loaded;
+                    }
+                    auto end = std::chrono::high_resolution_clock::now();
+                    startUs[mode] = std::chrono::duration<double, std::micro>(end - start).count() / BYTECODE_INSTANCES;
+
+                    // Gleiches Ergebnis wie das Programm aus dem Sourcecode?
+                    std::vector<std::vector<float>> reference(numChannels, std::vector<float>(AUDIOBLOCKSIZE));
+                    std::vector<float *> referencePointers(numChannels);
+                    for (int j = 0; j < numChannels; j++)
+                        referencePointers[j] = reference[j].data();
+                    Klangraum::FX8010 text(numChannels);
+                    text.loadFile("testcode.da");
+                    text.processBlock(inputPointers.data(), referencePointers.data(), AUDIOBLOCKSIZE);
+                    instances.back()->processBlock(inputPointers.data(), outputPointers.data(), AUDIOBLOCKSIZE);
+                    for (int j = 0; j < numChannels; j++)
+                        identical = identical && reference[j] == outputBlock[j];
+                }
+                cout << "Start je Instanz (" << BYTECODE_INSTANCES << " Instanzen): Sourcecode " << startUs[0] << " Mikrosekunden, Bytecode "
+                     << startUs[1] << " Mikrosekunden (" << bytecode.getSize() << " Bytes, " << (identical ? "gleiches Ergebnis" : "FEHLER") << ")" << endl;
+
+            }
+            // Erst nach dem Schliessen der Abbildung loeschen (Windows)
+            std::remove(bytecodePath.c_str());
+
+            std::cout << endl;
+        }
+
+        if (COMPILE_CACHE_TEST)
+        {
+            // Nur im Speicher, das erste compileFile() uebersetzt, danach ist jeder Wechsel ein Nachschlagen
+            Klangraum::FX8010CompileCache cache("", numChannels);
+            auto first = cache.compileFile("testcode.da");
+            const std::string name = (first != nullptr) ? first->name : "";
+            double switchUs[2] = {0.0, 0.0};
+            bool found = first != nullptr;
+            for (int mode = 0; mode < 2 && found; mode++)
+            {
+                auto start = std::chrono::high_resolution_clock::now();
+                for (int i = 0; i < COMPILE_CACHE_SWITCHES; i++)
+                {
+                    std::unique_ptr<Klangraum::FX8010> instance;
+                    if (mode == 0)
+                    {
+                        instance.reset(new Klangraum::FX8010(numChannels));
+                        found = found && instance->loadFile("testcode.da");
+                    }
+                    else
+                    {
+                        auto program = cache.findByName(name);
+                        instance = (program != nullptr) ? cache.createInstance(*program, numChannels) : nullptr;
+                        found = found && instance != nullptr;
+                    }
+                }
+                auto end = std::chrono::high_resolution_clock::now();
+                switchUs[mode] = std::chrono::duration<double, std::micro>(end - start).count() / COMPILE_CACHE_SWITCHES;
+            }
+            cout << "Presetwechsel '" << name << "' (" << COMPILE_CACHE_SWITCHES << "x): loadFile() " << switchUs[0] << " Mikrosekunden, Compile-Cache "
+                 << switchUs[1] << " Mikrosekunden" << (found ? "" : " (FEHLER)") << endl;
+
+            std::cout << endl;
+        }
+
         // Beliebigen Registerwert anzeigen
         // NOTE: Hier wird (noch) Kleinschreibung verlangt, da Parser Sourcecode in Kleinbuchstaben umwandelt. (verbesserungswürdig)
         string testRegister = "filter_cutoff";
@@ -180,6 +665,27 @@ int main()
         {
             cout << element << endl;
         }
+
+        // Speicherbedarf der Instanz
+        const Klangraum::FX8010::MemoryFootprint footprint = fx8010->getMemoryFootprint();
+        cout << endl;
+        cout << "Speicher: " << footprint.total << " Bytes (Objekt " << footprint.object << ", Register " << footprint.registers
+             << ", Instruktionen " << footprint.instructions << ", Tabellen " << footprint.tables << ", TRAM " << footprint.tram
+             << ", Puffer " << footprint.buffers << ")" << endl;
+
+        // Optimierer-Report: was wurde gefaltet, ersetzt, entfernt?
+        const Klangraum::FX8010::OptimizerReport &report = fx8010->getOptimizerReport();
+        cout << endl;
+        cout << "Optimierer: " << report.instructionsBefore << " -> " << report.instructionsAfter << " Instruktionen ("
+             << report.foldedConstants << " gefaltet, " << report.propagatedCopies << " Kopien ersetzt, "
+             << report.reducedInstructions << " vereinfacht, " << report.removedDeadWrites << " entfernt, "
+             << report.elidedCCR << " ohne CCR, " << report.elidedSaturation << " ohne Saturation)" << endl;
+        if (!report.skippedReason.empty())
+            cout << "Nicht optimiert: " << report.skippedReason << endl;
+        for (const auto &entry : report.entries)
+        {
+            cout << "Zeile " << entry.row << " " << entry.action << ": " << entry.before << " -> " << (entry.after.empty() ? "entfernt" : entry.after) << endl;
+        }
     }
     else
     {
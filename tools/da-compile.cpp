@@ -0,0 +1,97 @@
+// Copyright 2023 Klangraum
+// da-compile: .da Sourcecode -> Bytecode (include/FX8010Bytecode.h) fuer FX8010::loadBytecode()
+//
+// Aufruf: da-compile [-O0] [-c Kanaele] eingabe.da ausgabe.dab
+//         da-compile [-O0] [-c Kanaele] -b verzeichnis eingabe.da ...
+//   -O0  ohne Optimierer (bitgenau zum Chip mit ENGINE_FIXED)
+//   -c   Anzahl Kanaele, gegen die die I/O Indizes geprueft werden (Standard 2)
+//   -b   ganze Bibliothek parallel in den Compile-Cache (include/FX8010CompileCache.h) uebersetzen,
+//        unveraenderte Programme werden nur nachgeschlagen
+// Build (aus dem Repository-Verzeichnis):
+//   g++ -std=c++17 -O2 tools/da-compile.cpp source/[!m]*.cpp -o da-compile -lpthread
+
+#include "../include/FX8010CompileCache.h"
+
+#include <chrono>
+
+#include <cstdlib>
+
+// Fehler wie loadFile() ausgeben, erster Eintrag ist "Kein Fehler"
+static void printErrors(const std::string &path, const std::vector<Klangraum::FX8010::MyError> &errors)
+{
+    std::cerr << path << ": Fehler" << std::endl;
+    for (size_t i = 1; i < errors.size(); i++)
+        std::cerr << path << ":" << errors[i].errorRow << ": " << errors[i].errorDescription << std::endl;
+}
+
+static int compileLibrary(const std::string &directory, const std::vector<std::string> &files, int numChannels, bool optimize)
+{
+    Klangraum::FX8010CompileCache cache(directory, numChannels, optimize);
+    auto start = std::chrono::high_resolution_clock::now();
+    const std::vector<Klangraum::FX8010CompileCache::LibraryEntry> results = cache.compileLibrary(files);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    int numFailed = 0;
+    for (const auto &result : results)
+    {
+        if (result.program != nullptr)
+            continue;
+        // Nicht lesbare Dateien haben nur einen Eintrag
+        if (result.errors.size() == 1)
+            std::cerr << result.errors[0].errorDescription << std::endl;
+        else
+            printErrors(result.path, result.errors);
+        numFailed++;
+    }
+    const Klangraum::FX8010CompileCache::Statistics statistics = cache.getStatistics();
+    std::cout << files.size() << " Programme -> " << directory << ": " << statistics.compiled << " uebersetzt, " << statistics.diskHits << " aus dem Cache, "
+              << statistics.memoryHits << " doppelt, " << numFailed << " fehlerhaft (" << std::chrono::duration<double, std::milli>(end - start).count() << " ms)" << std::endl;
+    return (numFailed > 0) ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    bool optimize = true;
+    int numChannels = 2;
+    std::string directory = "";
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string argument = argv[i];
+        if (argument == "-O0")
+            optimize = false;
+        else if (argument == "-c" && i + 1 < argc)
+            numChannels = std::atoi(argv[++i]);
+        else if (argument == "-b" && i + 1 < argc)
+            directory = argv[++i];
+        else
+            files.push_back(argument);
+    }
+    if ((directory.empty() ? files.size() != 2 : files.empty()) || numChannels < 1)
+    {
+        std::cerr << "Aufruf: da-compile [-O0] [-c Kanaele] eingabe.da ausgabe.dab" << std::endl;
+        std::cerr << "        da-compile [-O0] [-c Kanaele] -b verzeichnis eingabe.da ..." << std::endl;
+        return 2;
+    }
+    if (!directory.empty())
+        return compileLibrary(directory, files, numChannels, optimize);
+
+    Klangraum::FX8010 dsp(numChannels);
+    dsp.setOptimizerEnabled(optimize);
+    if (!dsp.loadFile(files[0]))
+    {
+        printErrors(files[0], dsp.getErrorList());
+        return 1;
+    }
+
+    const std::vector<uint8_t> bytecode = dsp.getBytecode();
+    if (!dsp.saveBytecode(files[1]))
+    {
+        std::cerr << files[1] << ": kann nicht geschrieben werden" << std::endl;
+        return 1;
+    }
+    const Klangraum::FX8010::OptimizerReport &report = dsp.getOptimizerReport();
+    std::cout << files[0] << " -> " << files[1] << ": " << bytecode.size() << " Bytes, " << report.instructionsAfter << " Instruktionen"
+              << (optimize ? "" : " (ohne Optimierer)") << std::endl;
+    return 0;
+}
@@ -0,0 +1,592 @@
+// Copyright 2023 Klangraum
+// fx8010-bench: Durchsatz je Opcode und Blockgroesse, JSON Ergebnis, Vergleich mit einer Baseline
+//
+// Aufruf: fx8010-bench [Optionen]
+//   -e   Engine: switch, decoded (Standard), jit, fixed oder all
+//   -b   Blockgroessen, mit Komma getrennt (Standard 1,32,256,4096)
+//   -r   Wiederholungen je Fall (Standard 21), davor -w Aufwaermlaeufe (Standard 3)
+//   -f   Frames je Wiederholung (Standard 16384)
+//   -p   nur Faelle, deren Name den Text enthaelt (z.B. -p log)
+//   -O   mit Optimierer (Standard ohne, er wuerde die kuenstlichen Programme zusammenfalten)
+//   -o   Ergebnis als JSON schreiben
+//   -c   mit Baseline (JSON von -o) vergleichen, Rueckgabe 1 bei Regression
+//   -t   Schwelle fuer -c in Prozent (Standard 10)
+//   -m   Makro-Benchmark ueber einen Korpus (z.B. -m corpus, siehe corpus/README.md) statt der Opcodes:
+//        prueft jede Ausgabe gegen die Referenz und misst Samples/s und Instruktionen/s je Programm
+//   -g   mit -m: Eingang und Referenzausgaben neu erzeugen (ENGINE_SWITCH und ENGINE_FIXED, ohne Optimierer)
+//
+// Jeder Fall ist ein generiertes Programm aus UNROLL gleichen Instruktionen (plus END), die Register
+// rotieren ueber NUM_STATICS Werte, damit nicht alles an einer Abhaengigkeitskette haengt.
+// Gemessen wird je Wiederholung die Zeit fuer processBlock() ueber die Frames und die ausgefuehrten
+// Instruktionen (getInstructionCounter()). Ausgabe: Nanosekunden je Instruktion (Median, p99) und MIPS.
+//
+// Build (aus dem Repository-Verzeichnis):
+//   g++ -std=c++17 -O3 tools/fx8010-bench.cpp source/[!m]*.cpp -o fx8010-bench -lpthread
+
+#include "../include/FX8010.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <sys/stat.h>
+
+using Klangraum::FX8010;
+
+namespace
+{
+    const int UNROLL = 64;
+    const int NUM_STATICS = 8;
+
+    struct BenchCase
+    {
+        std::string name;
+        std::string program;
+    };
+
+    // s<i> rotiert, i ist die Position im Programm
+    std::string reg(int i) { return "s" + std::to_string((i % NUM_STATICS + NUM_STATICS) % NUM_STATICS); }
+
+    // Programmrahmen: Deklarationen, body je Position i, END
+    template <typename Body>
+    std::string makeProgram(Body body, const std::string &declarations = "")
+    {
+        std::ostringstream program;
+        program << declarations;
+        for (int s = 0; s < NUM_STATICS; s++)
+            program << "static s" << s << " = 0." << s + 1 << "\n";
+        program << "input in_l 0\noutput out_l 0\n";
+        for (int i = 0; i < UNROLL; i++)
+            program << body(i) << "\n";
+        program << "macs out_l, " << reg(0) << ", 0, 0\nend\n";
+        return program.str();
+    }
+
+    std::vector<BenchCase> makeCases()
+    {
+        std::vector<BenchCase> cases;
+        // Arithmetik: R = f(A, X, Y)
+        for (const std::string opcode : {"macs", "macsn", "macw", "macwn", "macmv", "interp", "tstneg", "limit", "limitn"})
+            cases.push_back({opcode, makeProgram([&](int i)
+                                                 { return opcode + " " + reg(i) + ", " + reg(i + 3) + ", in_l, 0.5"; })});
+        for (const std::string opcode : {"macints", "macintw"})
+            cases.push_back({opcode, makeProgram([&](int i)
+                                                 { return opcode + " " + reg(i) + ", " + reg(i + 3) + ", in_l, 2"; })});
+        for (const std::string opcode : {"acc3", "andxor"})
+            cases.push_back({opcode, makeProgram([&](int i)
+                                                 { return opcode + " " + reg(i) + ", " + reg(i + 3) + ", in_l, " + reg(i + 5); })});
+        // LOG/EXP: Aufwand haengt vom Exponenten (X) ab
+        for (const std::string opcode : {"log", "exp"})
+            for (int exponent : {1, 7, 15, 31})
+                cases.push_back({opcode + "_" + std::to_string(exponent), makeProgram([&](int i)
+                                                                                      { return opcode + " " + reg(i) + ", " + reg(i + 3) + ", " + std::to_string(exponent) + ", 0"; })});
+        // SKIP: Ergebnis 0 setzt CCR auf 0b01000, verglichen wird mit 8 (springt) oder 16 (springt nicht)
+        for (const std::string condition : {"8", "16"})
+            cases.push_back({(condition == "8") ? "skip_taken" : "skip_not_taken", makeProgram([&](int i)
+                                                                                               { return (i % 2 == 0) ? "macs " + reg(i) + ", 0, 0, 0" : "skip ccr, ccr, " + condition + ", 1\nmacs " + reg(i) + ", " + reg(i + 3) + ", in_l, 0.5"; })});
+        // Delaylines: Lesen und Schreiben an verteilten Adressen
+        for (const std::string line : {"idelay", "xdelay"})
+        {
+            const std::string declarations = (line == "idelay") ? "itramsize 4096 \n" : "xtramsize 32768 \n";
+            const int spacing = (line == "idelay") ? 61 : 509;
+            cases.push_back({line + "_read", makeProgram([&](int i)
+                                                         { return line + " read, " + reg(i) + ", at, " + std::to_string(1 + i * spacing); },
+                                                         declarations)});
+            cases.push_back({line + "_write", makeProgram([&](int i)
+                                                          { return line + " write, " + reg(i) + ", at, " + std::to_string(1 + i * spacing); },
+                                                          declarations)});
+        }
+        return cases;
+    }
+
+    struct Result
+    {
+        std::string name;
+        double median = 0.0; // ns je Instruktion
+        double p99 = 0.0;
+        double mips = 0.0; // aus dem Median
+        double instructionsPerSample = 0.0;
+        double samplesPerSecond = 0.0; // aus der mittleren (Median) Wiederholung
+    };
+
+    // Planar: Kanal -> Samples
+    typedef std::vector<std::vector<float>> Signal;
+
+    // Rang-Perzentil (naechster Rang) einer sortierten Liste
+    double percentile(const std::vector<double> &sorted, double p)
+    {
+        const size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+        return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+    }
+
+    // CHECKED
+    // Je Wiederholung processBlock() ueber framesPerRepetition Frames, der Eingang wird blockweise
+    // zyklisch gelesen (input muss mindestens blockFrames lang sein)
+    bool measure(FX8010 &dsp, const Signal &input, int blockFrames, int framesPerRepetition, int warmup, int repetitions, Result &result)
+    {
+        const int channels = static_cast<int>(input.size());
+        const int length = static_cast<int>(input[0].size());
+        Signal output(channels, std::vector<float>(blockFrames));
+        std::vector<const float *> inputs(channels);
+        std::vector<float *> outputs(channels);
+        for (int c = 0; c < channels; c++)
+            outputs[c] = output[c].data();
+        const int numBlocks = std::max(1, framesPerRepetition / blockFrames);
+
+        std::vector<double> nanoseconds;
+        std::vector<double> seconds;
+        uint64_t instructions = 0;
+        int position = 0;
+        for (int r = 0; r < warmup + repetitions; r++)
+        {
+            // Zaehler ist int, die Differenz je Wiederholung passt
+            const uint32_t before = static_cast<uint32_t>(dsp.getInstructionCounter());
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int b = 0; b < numBlocks; b++)
+            {
+                if (position + blockFrames > length)
+                    position = 0;
+                for (int c = 0; c < channels; c++)
+                    inputs[c] = input[c].data() + position;
+                dsp.processBlock(inputs.data(), outputs.data(), blockFrames);
+                position += blockFrames;
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            const uint32_t executed = static_cast<uint32_t>(dsp.getInstructionCounter()) - before;
+            if (r < warmup || executed == 0)
+                continue;
+            instructions = executed;
+            nanoseconds.push_back(std::chrono::duration<double, std::nano>(end - start).count() / executed);
+            seconds.push_back(std::chrono::duration<double>(end - start).count());
+        }
+        if (nanoseconds.empty())
+            return false;
+        std::sort(nanoseconds.begin(), nanoseconds.end());
+        std::sort(seconds.begin(), seconds.end());
+        const double frames = static_cast<double>(numBlocks) * blockFrames;
+        result.median = percentile(nanoseconds, 0.5);
+        result.p99 = percentile(nanoseconds, 0.99);
+        result.mips = 1e3 / result.median;
+        result.instructionsPerSample = static_cast<double>(instructions) / frames;
+        result.samplesPerSecond = frames / percentile(seconds, 0.5);
+        return true;
+    }
+
+    bool runCase(const BenchCase &benchCase, FX8010::EngineType engineType, int blockFrames, int framesPerRepetition, int warmup, int repetitions, bool optimize, Result &result)
+    {
+        FX8010 dsp(1);
+        dsp.setOptimizerEnabled(optimize);
+        dsp.setEngineType(engineType);
+        if (!dsp.loadFromString(benchCase.program))
+            return false;
+        Signal input(1, std::vector<float>(blockFrames));
+        for (int i = 0; i < blockFrames; i++)
+            input[0][i] = 0.5f * std::sin(0.01f * static_cast<float>(i));
+        return measure(dsp, input, blockFrames, framesPerRepetition, warmup, repetitions, result);
+    }
+
+    // Korpus (corpus/README.md): echte Programme, fester Eingang, Referenzausgaben
+    //--------------------------------------------------------------------------------
+
+    const int CORPUS_CHANNELS = 2;
+    const int CORPUS_FRAMES = 12000;
+    const int CORPUS_BLOCK = 256; // Blockgroesse fuer Referenz und Vergleich
+
+    // Fester Eingang (nur fuer -g, gespeichert wird input.f32): links Impuls und Sinus-Sweep
+    // 60 Hz - 8 kHz, rechts Rauschen (LCG) plus 440 Hz, beide mit Pegelstufen laut/leise/laut/Stille
+    Signal makeCorpusInput()
+    {
+        Signal input(CORPUS_CHANNELS, std::vector<float>(CORPUS_FRAMES));
+        const double pi = 3.14159265358979323846;
+        const float levels[4] = {0.8f, 0.05f, 0.8f, 0.0f};
+        uint32_t random = 8010;
+        double phase = 0.0;
+        for (int i = 0; i < CORPUS_FRAMES; i++)
+        {
+            const float level = levels[i * 4 / CORPUS_FRAMES];
+            const double frequency = 60.0 * std::pow(8000.0 / 60.0, static_cast<double>(i) / CORPUS_FRAMES);
+            phase += 2.0 * pi * frequency / SAMPLERATE;
+            random = random * 1664525u + 1013904223u;
+            const float noise = static_cast<float>(static_cast<int32_t>(random)) / 2147483648.0f;
+            input[0][i] = (i == 0) ? 1.0f : level * static_cast<float>(std::sin(phase));
+            input[1][i] = level * (0.5f * noise + 0.5f * static_cast<float>(std::sin(2.0 * pi * 440.0 * i / SAMPLERATE)));
+        }
+        return input;
+    }
+
+    // Rohdaten float32 interleaved (Little Endian wie die Rechner, auf denen das laeuft)
+    bool readSignal(const std::string &path, int channels, Signal &signal)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+        const std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        const size_t frames = bytes.size() / (sizeof(float) * channels);
+        if (frames == 0)
+            return false;
+        std::vector<float> interleaved(frames * channels);
+        memcpy(interleaved.data(), bytes.data(), interleaved.size() * sizeof(float));
+        signal.assign(channels, std::vector<float>(frames));
+        for (size_t i = 0; i < frames; i++)
+            for (int c = 0; c < channels; c++)
+                signal[c][i] = interleaved[i * channels + c];
+        return true;
+    }
+
+    bool writeSignal(const std::string &path, const Signal &signal)
+    {
+        const size_t channels = signal.size();
+        std::vector<float> interleaved(signal[0].size() * channels);
+        for (size_t i = 0; i < signal[0].size(); i++)
+            for (size_t c = 0; c < channels; c++)
+                interleaved[i * channels + c] = signal[c][i];
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(interleaved.data()), static_cast<std::streamsize>(interleaved.size() * sizeof(float)));
+        return static_cast<bool>(file);
+    }
+
+    // Ganzen Eingang einmal durch eine frische Instanz
+    Signal render(FX8010 &dsp, const Signal &input, int blockFrames)
+    {
+        const int channels = static_cast<int>(input.size());
+        const int length = static_cast<int>(input[0].size());
+        Signal output(channels, std::vector<float>(length));
+        std::vector<const float *> inputs(channels);
+        std::vector<float *> outputs(channels);
+        for (int position = 0; position < length; position += blockFrames)
+        {
+            for (int c = 0; c < channels; c++)
+            {
+                inputs[c] = input[c].data() + position;
+                outputs[c] = output[c].data() + position;
+            }
+            dsp.processBlock(inputs.data(), outputs.data(), std::min(blockFrames, length - position));
+        }
+        return output;
+    }
+
+    float maxDifference(const Signal &a, const Signal &b)
+    {
+        float difference = 0.0f;
+        for (size_t c = 0; c < a.size(); c++)
+            for (size_t i = 0; i < a[c].size(); i++)
+                difference = std::max(difference, std::abs(a[c][i] - b[c][i]));
+        return difference;
+    }
+
+    typedef std::vector<std::pair<std::string, FX8010::EngineType>> EngineList;
+
+    // Referenz je Engine-Familie: die float Engines gegen ENGINE_SWITCH, ENGINE_FIXED gegen sich selbst,
+    // weil ANDXOR/TSTNEG/Wraparound dort auf den Q31 Bits arbeiten (andere Ergebnisse, wie der Chip).
+    // Erzeugt ohne Optimierer mit CORPUS_BLOCK.
+    std::string getGoldenPath(const std::string &directory, const std::string &program, FX8010::EngineType engineType)
+    {
+        return directory + "/golden/" + program + (engineType == FX8010::ENGINE_FIXED ? ".q31.f32" : ".f32");
+    }
+
+    // Zulaessige Abweichung von der Referenz: die float Engines rechnen dieselben Operationen in anderer
+    // Reihenfolge (JIT, Optimierer), ENGINE_FIXED ist bis auf die Rundung im Optimierer bitgenau
+    float getTolerance(FX8010::EngineType engineType)
+    {
+        return (engineType == FX8010::ENGINE_FIXED) ? 1e-6f : 1e-4f;
+    }
+
+    // CHECKED
+    // Programme aus corpus.txt: Ausgabe mit golden/<Programm>.f32 vergleichen, dann messen.
+    // generate: input.f32 und die Referenzausgaben neu schreiben. Rueckgabe Anzahl Fehler.
+    int runCorpus(const std::string &directory, const EngineList &engines, const std::vector<int> &blockSizes, const std::string &pattern, bool generate,
+                  int framesPerRepetition, int warmup, int repetitions, bool optimize, std::vector<Result> &results)
+    {
+        std::ifstream list(directory + "/corpus.txt");
+        if (!list)
+        {
+            std::cerr << directory << "/corpus.txt: nicht lesbar" << std::endl;
+            return 1;
+        }
+        std::vector<std::string> programs;
+        std::string line;
+        while (std::getline(list, line))
+        {
+            line = line.substr(0, line.find(';'));
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (!line.empty())
+                programs.push_back(line);
+        }
+
+        Signal input;
+        if (generate)
+        {
+            input = makeCorpusInput();
+            mkdir((directory + "/golden").c_str(), 0755); // existiert evtl. schon
+            if (!writeSignal(directory + "/input.f32", input))
+            {
+                std::cerr << directory << "/input.f32: kann nicht geschrieben werden" << std::endl;
+                return 1;
+            }
+        }
+        else if (!readSignal(directory + "/input.f32", CORPUS_CHANNELS, input))
+        {
+            std::cerr << directory << "/input.f32: nicht lesbar" << std::endl;
+            return 1;
+        }
+
+        int numFailed = 0;
+        for (const std::string &program : programs)
+        {
+            const std::string path = directory + "/" + program + ".da";
+            // golden[0] float Engines, golden[1] ENGINE_FIXED
+            const FX8010::EngineType referenceEngines[2] = {FX8010::ENGINE_SWITCH, FX8010::ENGINE_FIXED};
+            Signal golden[2];
+            bool valid = true;
+            for (int k = 0; k < 2 && valid; k++)
+            {
+                const std::string goldenPath = getGoldenPath(directory, program, referenceEngines[k]);
+                if (generate)
+                {
+                    FX8010 reference(CORPUS_CHANNELS);
+                    reference.setOptimizerEnabled(false);
+                    reference.setEngineType(referenceEngines[k]);
+                    if (!reference.loadFile(path) || !writeSignal(goldenPath, golden[k] = render(reference, input, CORPUS_BLOCK)))
+                    {
+                        std::cerr << program << ": Referenz kann nicht erzeugt werden" << std::endl;
+                        valid = false;
+                    }
+                }
+                else if (!readSignal(goldenPath, CORPUS_CHANNELS, golden[k]) || golden[k][0].size() != input[0].size())
+                {
+                    std::cerr << goldenPath << ": nicht lesbar (mit -g erzeugen)" << std::endl;
+                    valid = false;
+                }
+            }
+            if (!valid)
+            {
+                numFailed++;
+                continue;
+            }
+
+            for (const auto &engine : engines)
+                for (int blockFrames : blockSizes)
+                {
+                    Result result;
+                    result.name = "corpus/" + engine.first + "/" + program + "/b" + std::to_string(blockFrames);
+                    if (!pattern.empty() && result.name.find(pattern) == std::string::npos)
+                        continue;
+                    FX8010 check(CORPUS_CHANNELS);
+                    check.setOptimizerEnabled(optimize);
+                    check.setEngineType(engine.second);
+                    if (!check.loadFile(path))
+                    {
+                        std::cerr << result.name << ": Programm kann nicht geladen werden" << std::endl;
+                        numFailed++;
+                        continue;
+                    }
+                    const float difference = maxDifference(render(check, input, blockFrames), golden[engine.second == FX8010::ENGINE_FIXED]);
+                    const bool matches = difference <= getTolerance(engine.second);
+
+                    // Messen mit einer frischen Instanz (Zustand wie beim Vergleich)
+                    FX8010 dsp(CORPUS_CHANNELS);
+                    dsp.setOptimizerEnabled(optimize);
+                    dsp.setEngineType(engine.second);
+                    if (!dsp.loadFile(path) || !measure(dsp, input, std::min(blockFrames, static_cast<int>(input[0].size())), framesPerRepetition, warmup, repetitions, result))
+                    {
+                        numFailed++;
+                        continue;
+                    }
+                    printf("%-36s %12.0f Samples/s %9.1f MIPS %6.1f Instr./Sample  Referenz %s (%.2g)\n", result.name.c_str(), result.samplesPerSecond, result.mips,
+                           result.instructionsPerSample, matches ? "ok" : "ABWEICHUNG", difference);
+                    if (!matches)
+                        numFailed++;
+                    results.push_back(result);
+                }
+        }
+        return numFailed;
+    }
+
+    // Ein Ergebnis je Zeile, readBaseline() liest genau dieses Format
+    bool writeJSON(const std::string &path, const std::vector<Result> &results, int repetitions, int framesPerRepetition, bool optimize)
+    {
+        std::ofstream file(path);
+        if (!file)
+            return false;
+        file << "{\n  \"repetitions\": " << repetitions << ",\n  \"framesPerRepetition\": " << framesPerRepetition << ",\n  \"optimizer\": " << (optimize ? "true" : "false")
+             << ",\n  \"unit\": \"ns/instruction\",\n  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const Result &result = results[i];
+            file << "    {\"name\": \"" << result.name << "\", \"median\": " << result.median << ", \"p99\": " << result.p99 << ", \"mips\": " << result.mips
+                 << ", \"instructionsPerSample\": " << result.instructionsPerSample << ", \"samplesPerSecond\": " << result.samplesPerSecond << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        file << "  ]\n}\n";
+        return static_cast<bool>(file);
+    }
+
+    // Name -> Median aus einer Datei von writeJSON()
+    bool readBaseline(const std::string &path, std::map<std::string, double> &baseline)
+    {
+        std::ifstream file(path);
+        if (!file)
+            return false;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            const size_t name = line.find("\"name\": \"");
+            const size_t median = line.find("\"median\": ");
+            if (name == std::string::npos || median == std::string::npos)
+                continue;
+            const size_t nameStart = name + 9;
+            const size_t nameEnd = line.find('"', nameStart);
+            if (nameEnd == std::string::npos)
+                continue;
+            baseline[line.substr(nameStart, nameEnd - nameStart)] = std::atof(line.c_str() + median + 10);
+        }
+        return true;
+    }
+
+    std::vector<int> parseList(const std::string &text)
+    {
+        std::vector<int> values;
+        std::istringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ','))
+            values.push_back(std::atoi(item.c_str()));
+        return values;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const EngineList allEngines = {
+        {"switch", FX8010::ENGINE_SWITCH}, {"decoded", FX8010::ENGINE_DECODED}, {"jit", FX8010::ENGINE_JIT}, {"fixed", FX8010::ENGINE_FIXED}};
+    EngineList engines = {allEngines[1]};
+    std::vector<int> blockSizes = {1, 32, 256, 4096};
+    int repetitions = 21;
+    int warmup = 3;
+    int framesPerRepetition = 16384;
+    bool optimize = false;
+    std::string pattern = "";
+    std::string outputPath = "";
+    std::string baselinePath = "";
+    double threshold = 10.0;
+    std::string corpusPath = "";
+    bool generate = false;
+
+    bool valid = true;
+    for (int i = 1; i < argc && valid; i++)
+    {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (argument == "-O")
+            optimize = true;
+        else if (argument == "-e" && hasValue)
+        {
+            const std::string engine = argv[++i];
+            engines.clear();
+            for (const auto &candidate : allEngines)
+                if (engine == "all" || engine == candidate.first)
+                    engines.push_back(candidate);
+            valid = !engines.empty();
+        }
+        else if (argument == "-b" && hasValue)
+        {
+            blockSizes = parseList(argv[++i]);
+            valid = !blockSizes.empty() && *std::min_element(blockSizes.begin(), blockSizes.end()) > 0;
+        }
+        else if (argument == "-r" && hasValue)
+            valid = (repetitions = std::atoi(argv[++i])) > 0;
+        else if (argument == "-w" && hasValue)
+            valid = (warmup = std::atoi(argv[++i])) >= 0;
+        else if (argument == "-f" && hasValue)
+            valid = (framesPerRepetition = std::atoi(argv[++i])) > 0;
+        else if (argument == "-p" && hasValue)
+            pattern = argv[++i];
+        else if (argument == "-o" && hasValue)
+            outputPath = argv[++i];
+        else if (argument == "-c" && hasValue)
+            baselinePath = argv[++i];
+        else if (argument == "-t" && hasValue)
+            valid = (threshold = std::atof(argv[++i])) >= 0.0;
+        else if (argument == "-m" && hasValue)
+            corpusPath = argv[++i];
+        else if (argument == "-g")
+            generate = true;
+        else
+            valid = false;
+    }
+    if (!valid)
+    {
+        std::cerr << "Aufruf: fx8010-bench [-e switch|decoded|jit|fixed|all] [-b 1,32,256,4096] [-r wiederholungen] [-w aufwaermen]" << std::endl;
+        std::cerr << "                     [-f frames] [-p muster] [-O] [-o ergebnis.json] [-c baseline.json] [-t prozent] [-m korpus [-g]]" << std::endl;
+        return 2;
+    }
+
+    std::vector<Result> results;
+    int numFailed = 0;
+    if (!corpusPath.empty())
+        numFailed = runCorpus(corpusPath, engines, blockSizes, pattern, generate, framesPerRepetition, warmup, repetitions, optimize, results);
+    else
+    {
+        // Name: engine/opcode/b<Blockgroesse>
+        const std::vector<BenchCase> cases = makeCases();
+        for (const auto &engine : engines)
+            for (int blockFrames : blockSizes)
+                for (const BenchCase &benchCase : cases)
+                {
+                    Result result;
+                    result.name = engine.first + "/" + benchCase.name + "/b" + std::to_string(blockFrames);
+                    if (!pattern.empty() && result.name.find(pattern) == std::string::npos)
+                        continue;
+                    if (!runCase(benchCase, engine.second, blockFrames, framesPerRepetition, warmup, repetitions, optimize, result))
+                    {
+                        std::cerr << result.name << ": Programm kann nicht geladen werden" << std::endl;
+                        numFailed++;
+                        continue;
+                    }
+                    printf("%-32s %8.3f ns median %8.3f ns p99 %9.1f MIPS\n", result.name.c_str(), result.median, result.p99, result.mips);
+                    results.push_back(result);
+                }
+    }
+
+    if (!outputPath.empty() && !writeJSON(outputPath, results, repetitions, framesPerRepetition, optimize))
+    {
+        std::cerr << outputPath << ": kann nicht geschrieben werden" << std::endl;
+        return 1;
+    }
+
+    if (!baselinePath.empty())
+    {
+        std::map<std::string, double> baseline;
+        if (!readBaseline(baselinePath, baseline))
+        {
+            std::cerr << baselinePath << ": nicht lesbar" << std::endl;
+            return 1;
+        }
+        // Langsamer als Baseline + threshold Prozent ist eine Regression, fehlende Faelle werden nur gemeldet
+        int numRegressions = 0;
+        int numCompared = 0;
+        for (const Result &result : results)
+        {
+            auto it = baseline.find(result.name);
+            if (it == baseline.end() || it->second <= 0.0)
+            {
+                std::cout << result.name << ": nicht in der Baseline" << std::endl;
+                continue;
+            }
+            numCompared++;
+            const double change = (result.median / it->second - 1.0) * 100.0;
+            if (change > threshold)
+            {
+                printf("REGRESSION %-32s %8.3f ns -> %8.3f ns (%+.1f %%)\n", result.name.c_str(), it->second, result.median, change);
+                numRegressions++;
+            }
+        }
+        std::cout << numCompared << " Faelle verglichen, " << numRegressions << " Regressionen (Schwelle " << threshold << " %)" << std::endl;
+        if (numRegressions > 0)
+            return 1;
+    }
+    return (numFailed > 0) ? 1 : 0;
+}
@@ -0,0 +1,404 @@
+// Copyright 2023 Klangraum
+// fx8010-hotswap-stress: FX8010HotSwap unter Last, damit das RCU/Retire-Protokoll nachpruefbar bleibt
+//
+// Aufruf: fx8010-hotswap-stress [Optionen]
+//   -m   Korpus-Verzeichnis (Standard corpus), Programme aus corpus.txt, Eingang input.f32
+//   -e   Engine fuer den Wechseltest: switch, decoded, jit, fixed oder all (Standard all)
+//   -n   Bearbeitungen im Stresslauf (Standard 400)
+//   -s   Startwert des Zufallsgenerators (Standard 1)
+//
+// 1. Wechseltest: jedes Korpus-Programm wird mitten im Lauf ohne Ueberblendung durch sich selbst
+//    ersetzt, waehrend ein Control (mit Rampe) laeuft. Register, Glaettung, TRAM und Samplezeit wandern
+//    mit, der Ausgang muss bitgleich zu einer Instanz sein, die nie gewechselt hat.
+// 2. Stresslauf: UI-Thread (compile() mit wechselnder Engine, Optimierer, Ueberblendung, auch kaputte
+//    Programme und Auftraege schneller als uebersetzt), Parameter-Thread (setRegisterValue()) und
+//    Audio-Thread (processBlock() mit wechselnden Blockgroessen) laufen gleichzeitig mit dem
+//    Compile-Thread. Geprueft: Ergebnis jedes abgewarteten Auftrags, endlicher Ausgang, am Ende laeuft
+//    das zuletzt uebersetzte Programm.
+// 3. Lebensdauer: Instanzen werden mit wartenden Auftraegen, waehrend der Ueberblendung und mit
+//    belegtem Retired-Slot zerstoert.
+//
+// Rueckgabe 1 bei einem Fehler. Datenrennen und Use-after-free findet nur ein Sanitizer-Build:
+//   g++ -std=c++17 -O3 tools/fx8010-hotswap-stress.cpp source/[!m]*.cpp -o fx8010-hotswap-stress -lpthread
+//   g++ -std=c++17 -O1 -g -fsanitize=thread tools/fx8010-hotswap-stress.cpp source/[!m]*.cpp -o fx8010-hotswap-stress -lpthread
+//   g++ -std=c++17 -O1 -g -fsanitize=address,undefined tools/fx8010-hotswap-stress.cpp source/[!m]*.cpp -o fx8010-hotswap-stress -lpthread
+
+#include "../include/FX8010HotSwap.h"
+
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <thread>
+
+using Klangraum::FX8010;
+using Klangraum::FX8010HotSwap;
+
+namespace
+{
+    const int CHANNELS = 2;
+    const int BLOCK = 256;
+    const int SWAP_BLOCK = 12;                     // Wechseltest: Wechsel vor diesem Block
+    const int MAX_STRESS_BLOCK = 1024;             // Audio-Thread: Blockgroessen 1..MAX_STRESS_BLOCK
+    // Stresslauf: nur das letzte Programm deklariert dieses Control (gleichnamige Werte wuerden uebernommen)
+    const char *MARKER = "hotswap_last";
+    const float MARKER_VALUE = 0.75f;
+    const std::chrono::seconds SETTLE_TIMEOUT(30); // Warten auf Uebersetzen und Uebernahme
+
+    typedef std::vector<std::vector<float>> Signal;
+
+    struct Program
+    {
+        std::string name;
+        std::string source;
+        std::vector<std::string> controls;
+    };
+
+    std::string readText(const std::string &path)
+    {
+        std::ifstream file(path);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+
+    // corpus.txt: ein Programm je Zeile, ';' Kommentar
+    bool readCorpus(const std::string &directory, std::vector<Program> &programs)
+    {
+        std::ifstream list(directory + "/corpus.txt");
+        std::string line;
+        while (std::getline(list, line))
+        {
+            line = line.substr(0, line.find(';'));
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (line.empty())
+                continue;
+            Program program;
+            program.name = line;
+            program.source = readText(directory + "/" + line + ".da");
+            if (program.source.empty())
+            {
+                std::cerr << directory << "/" << line << ".da: nicht lesbar" << std::endl;
+                return false;
+            }
+            FX8010 probe(CHANNELS);
+            if (!probe.loadFromString(program.source))
+            {
+                std::cerr << program.name << ": Programm kann nicht geladen werden" << std::endl;
+                return false;
+            }
+            program.controls = probe.getControlRegisters();
+            programs.push_back(program);
+        }
+        return !programs.empty();
+    }
+
+    // input.f32: float32, interleaved
+    bool readSignal(const std::string &path, Signal &signal)
+    {
+        std::ifstream file(path, std::ios::binary);
+        const std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        const size_t frames = bytes.size() / (sizeof(float) * CHANNELS);
+        if (frames < static_cast<size_t>(MAX_STRESS_BLOCK))
+            return false;
+        std::vector<float> interleaved(frames * CHANNELS);
+        memcpy(interleaved.data(), bytes.data(), interleaved.size() * sizeof(float));
+        signal.assign(CHANNELS, std::vector<float>(frames));
+        for (size_t i = 0; i < frames; i++)
+            for (int c = 0; c < CHANNELS; c++)
+                signal[c][i] = interleaved[i * CHANNELS + c];
+        return true;
+    }
+
+    // Erstes Control mit Rampe, damit beim Wechsel eine Glaettung laeuft
+    std::string withRamp(const std::string &source, const std::string &control)
+    {
+        std::istringstream lines(source);
+        std::ostringstream result;
+        std::string line;
+        bool done = false;
+        while (std::getline(lines, line))
+        {
+            const std::string code = line.substr(0, line.find(';'));
+            const size_t end = 8 + control.size();
+            if (!done && code.compare(0, end, "control " + control) == 0 && (code.size() == end || (!isalnum(code[end]) && code[end] != '_')))
+            {
+                line = code.substr(0, code.find_last_not_of(" \t") + 1) + ", ramp 5";
+                done = true;
+            }
+            result << line << "\n";
+        }
+        return result.str();
+    }
+
+    // CHECKED
+    // Wechsel auf dasselbe Programm ohne Ueberblendung: Ausgang bitgleich zu einer Instanz ohne Wechsel
+    int runSwapEquivalence(const std::vector<Program> &programs, const Signal &input, const std::vector<std::pair<std::string, FX8010::EngineType>> &engines)
+    {
+        int numFailed = 0;
+        const int numBlocks = static_cast<int>(input[0].size()) / BLOCK;
+        for (const auto &engine : engines)
+            for (const Program &program : programs)
+                for (int optimize = 0; optimize < 2; optimize++)
+                {
+                    const std::string control = program.controls.empty() ? "" : program.controls[0];
+                    const std::string source = control.empty() ? program.source : withRamp(program.source, control);
+
+                    FX8010 reference(CHANNELS);
+                    reference.setEngineType(engine.second);
+                    reference.setOptimizerEnabled(optimize != 0);
+                    FX8010HotSwap hotSwap(CHANNELS);
+                    hotSwap.setEngineType(engine.second);
+                    hotSwap.setOptimizerEnabled(optimize != 0);
+                    hotSwap.setCrossfadeSamples(0);
+                    const bool loaded = reference.loadFromString(source);
+                    if (!loaded || !hotSwap.waitForCompile(hotSwap.compile(source)) || !hotSwap.getLastResult().success)
+                    {
+                        std::cerr << program.name << ": Programm kann nicht geladen werden" << std::endl;
+                        numFailed++;
+                        continue;
+                    }
+
+                    float difference = 0.0f;
+                    std::vector<float> hotSwapBuffer(CHANNELS * BLOCK), referenceBuffer(CHANNELS * BLOCK);
+                    std::vector<const float *> inputs(CHANNELS);
+                    std::vector<float *> hotSwapOutputs(CHANNELS), referenceOutputs(CHANNELS);
+                    for (int block = 0; block < numBlocks; block++)
+                    {
+                        // Control kurz vor dem Wechsel aendern, die Rampe laeuft ueber den Wechsel hinweg
+                        if (block == SWAP_BLOCK - 2 && !control.empty())
+                        {
+                            hotSwap.setRegisterValue(control, 0.1f);
+                            reference.pushParameterEvent(reference.getRegisterHandle(control), 0.1f);
+                        }
+                        if (block == SWAP_BLOCK && !hotSwap.waitForCompile(hotSwap.compile(source)))
+                            break;
+                        for (int c = 0; c < CHANNELS; c++)
+                        {
+                            inputs[c] = input[c].data() + block * BLOCK;
+                            hotSwapOutputs[c] = hotSwapBuffer.data() + c * BLOCK;
+                            referenceOutputs[c] = referenceBuffer.data() + c * BLOCK;
+                        }
+                        hotSwap.processBlock(inputs.data(), hotSwapOutputs.data(), BLOCK);
+                        reference.processBlock(inputs.data(), referenceOutputs.data(), BLOCK);
+                        for (int i = 0; i < CHANNELS * BLOCK; i++)
+                            difference = std::max(difference, std::fabs(hotSwapBuffer[i] - referenceBuffer[i]));
+                    }
+                    const bool matches = difference == 0.0f && hotSwap.getSwapCount() == 2;
+                    printf("Wechsel %-8s %-11s %-13s %s (Abweichung %.3g, %d Wechsel)\n", engine.first.c_str(), program.name.c_str(), optimize ? "mit Optimierer" : "ohne Optimierer",
+                           matches ? "ok" : "FEHLER", difference, hotSwap.getSwapCount());
+                    if (!matches)
+                        numFailed++;
+                }
+        return numFailed;
+    }
+
+    // CHECKED
+    // UI-, Parameter- und Audio-Thread gleichzeitig gegen den Compile-Thread
+    int runStress(const std::vector<Program> &programs, const Signal &input, int numEdits, unsigned seed)
+    {
+        const FX8010::EngineType engineTypes[4] = {FX8010::ENGINE_SWITCH, FX8010::ENGINE_DECODED, FX8010::ENGINE_JIT, FX8010::ENGINE_FIXED};
+        const int crossfades[4] = {0, 64, 480, 3000};
+        std::vector<std::string> controls = {"gibt_es_nicht"};
+        for (const Program &program : programs)
+            controls.insert(controls.end(), program.controls.begin(), program.controls.end());
+
+        FX8010HotSwap hotSwap(CHANNELS);
+        std::atomic<bool> stop{false};
+        std::atomic<bool> lastPublished{false}; // UI -> Audio: letztes Programm ist uebersetzt
+        std::atomic<bool> settled{false};    // Audio -> UI: letztes Programm laeuft
+        std::atomic<int> numFailed{0};
+        std::atomic<long> numBlocks{0};
+        std::atomic<long> numEvents{0};
+
+        std::thread audio([&]()
+                          {
+            std::mt19937 random(seed + 1);
+            std::vector<float> buffer(CHANNELS * MAX_STRESS_BLOCK);
+            std::vector<const float *> inputs(CHANNELS);
+            std::vector<float *> outputs(CHANNELS);
+            const size_t frames = input[0].size();
+            size_t position = 0;
+            while (!stop.load(std::memory_order_acquire))
+            {
+                const int n = 1 + static_cast<int>(random() % MAX_STRESS_BLOCK);
+                if (position + n > frames)
+                    position = 0;
+                for (int c = 0; c < CHANNELS; c++)
+                {
+                    inputs[c] = input[c].data() + position;
+                    outputs[c] = buffer.data() + c * MAX_STRESS_BLOCK;
+                }
+                position += n;
+                hotSwap.processBlock(inputs.data(), outputs.data(), n);
+                numBlocks.fetch_add(1, std::memory_order_relaxed);
+                for (int c = 0; c < CHANNELS; c++)
+                    for (int i = 0; i < n; i++)
+                        if (!std::isfinite(outputs[c][i]))
+                        {
+                            numFailed.fetch_add(1);
+                            stop.store(true);
+                        }
+                FX8010 *active = hotSwap.getActiveProgram();
+                if (lastPublished.load(std::memory_order_acquire) && active != nullptr && !hotSwap.isCrossfading() && active->getRegisterValue(MARKER) == MARKER_VALUE)
+                    settled.store(true, std::memory_order_release);
+            } });
+
+        std::thread parameters([&]()
+                               {
+            std::mt19937 random(seed + 2);
+            while (!stop.load(std::memory_order_acquire))
+            {
+                const std::string &name = controls[random() % controls.size()];
+                const int64_t sampleTime = (random() % 2) ? -1 : static_cast<int64_t>(random() % 48000);
+                if (hotSwap.setRegisterValue(name, static_cast<float>(random() % 1000) / 1000.0f, sampleTime))
+                    numEvents.fetch_add(1, std::memory_order_relaxed);
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            } });
+
+        // UI-Thread
+        std::mt19937 random(seed);
+        int numWaited = 0;
+        for (int edit = 0; edit < numEdits && !stop.load(); edit++)
+        {
+            hotSwap.setEngineType(engineTypes[random() % 4]);
+            hotSwap.setOptimizerEnabled(random() % 2 != 0);
+            hotSwap.setCrossfadeSamples(crossfades[random() % 4]);
+            const Program &program = programs[random() % programs.size()];
+            // Jede zehnte Bearbeitung ist fehlerhaft, das laufende Programm bleibt
+            const bool broken = edit % 10 == 9;
+            const int request = hotSwap.compile(broken ? "macs nirgendwo, 0, 0, 0\n" + program.source : program.source);
+            switch (random() % 4)
+            {
+            case 0:
+                // Abwarten und Ergebnis pruefen (nur dieser Thread uebersetzt)
+                if (!hotSwap.waitForCompile(request, 30000) || hotSwap.getLastResult().request != request || hotSwap.getLastResult().success == broken)
+                {
+                    std::cerr << "Auftrag " << request << ": unerwartetes Ergebnis" << std::endl;
+                    numFailed.fetch_add(1);
+                }
+                numWaited++;
+                break;
+            case 1:
+                std::this_thread::sleep_for(std::chrono::microseconds(random() % 3000));
+                break;
+            default:
+                // Naechster Auftrag sofort, ersetzt einen noch nicht begonnenen
+                break;
+            }
+        }
+
+        // Letztes Programm muss uebernommen werden
+        std::ostringstream last;
+        last << "control " << MARKER << " = " << MARKER_VALUE << "\n" << programs[0].source;
+        if (!hotSwap.waitForCompile(hotSwap.compile(last.str()), 30000) || !hotSwap.getLastResult().success)
+            numFailed.fetch_add(1);
+        lastPublished.store(true, std::memory_order_release);
+        const auto deadline = std::chrono::steady_clock::now() + SETTLE_TIMEOUT;
+        while (!settled.load(std::memory_order_acquire) && !stop.load() && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (!settled.load())
+        {
+            std::cerr << "Letztes Programm wurde nicht uebernommen" << std::endl;
+            numFailed.fetch_add(1);
+        }
+        stop.store(true, std::memory_order_release);
+        audio.join();
+        parameters.join();
+
+        printf("Stress: %d Bearbeitungen (%d abgewartet), %d Wechsel, %ld Audioblocks, %ld Events %s\n", numEdits, numWaited, hotSwap.getSwapCount(), numBlocks.load(),
+               numEvents.load(), numFailed.load() == 0 ? "ok" : "FEHLER");
+        return numFailed.load();
+    }
+
+    // Zerstoeren in jedem Zustand: Auftrag wartet oder laeuft, Ueberblendung, Retired-Slot belegt
+    int runLifetime(const std::vector<Program> &programs, const Signal &input)
+    {
+        std::vector<float> buffer(CHANNELS * BLOCK);
+        std::vector<const float *> inputs(CHANNELS);
+        std::vector<float *> outputs(CHANNELS);
+        for (int c = 0; c < CHANNELS; c++)
+        {
+            inputs[c] = input[c].data();
+            outputs[c] = buffer.data() + c * BLOCK;
+        }
+        const int cases = 64;
+        for (int i = 0; i < cases; i++)
+        {
+            FX8010HotSwap hotSwap(CHANNELS);
+            hotSwap.setCrossfadeSamples((i % 2) ? 4 * BLOCK : 0);
+            const std::string &first = programs[i % programs.size()].source;
+            const std::string &second = programs[(i + 1) % programs.size()].source;
+            const int request = hotSwap.compile(first);
+            if (i % 4 == 0)
+                continue; // Auftrag noch in Arbeit
+            hotSwap.waitForCompile(request);
+            hotSwap.processBlock(inputs.data(), outputs.data(), BLOCK);
+            hotSwap.waitForCompile(hotSwap.compile(second));
+            if (i % 4 == 1)
+                continue; // Programm wartet auf Uebernahme
+            hotSwap.processBlock(inputs.data(), outputs.data(), BLOCK);
+            // i % 4 == 2: Ueberblendung laeuft bzw. Retired-Slot belegt, 3: noch ein Auftrag
+            if (i % 4 == 3)
+                hotSwap.compile(first);
+        }
+        printf("Lebensdauer: %d Instanzen ok\n", cases);
+        return 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const std::vector<std::pair<std::string, FX8010::EngineType>> allEngines = {
+        {"switch", FX8010::ENGINE_SWITCH}, {"decoded", FX8010::ENGINE_DECODED}, {"jit", FX8010::ENGINE_JIT}, {"fixed", FX8010::ENGINE_FIXED}};
+    std::vector<std::pair<std::string, FX8010::EngineType>> engines = allEngines;
+    std::string corpusPath = "corpus";
+    int numEdits = 400;
+    unsigned seed = 1;
+
+    bool valid = true;
+    for (int i = 1; i < argc && valid; i++)
+    {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (argument == "-e" && hasValue)
+        {
+            const std::string engine = argv[++i];
+            engines.clear();
+            for (const auto &candidate : allEngines)
+                if (engine == "all" || engine == candidate.first)
+                    engines.push_back(candidate);
+            valid = !engines.empty();
+        }
+        else if (argument == "-m" && hasValue)
+            corpusPath = argv[++i];
+        else if (argument == "-n" && hasValue)
+            valid = (numEdits = std::atoi(argv[++i])) > 0;
+        else if (argument == "-s" && hasValue)
+            seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        else
+            valid = false;
+    }
+    if (!valid)
+    {
+        std::cerr << "Aufruf: fx8010-hotswap-stress [-m korpus] [-e switch|decoded|jit|fixed|all] [-n bearbeitungen] [-s startwert]" << std::endl;
+        return 2;
+    }
+
+    std::vector<Program> programs;
+    Signal input;
+    if (!readCorpus(corpusPath, programs) || !readSignal(corpusPath + "/input.f32", input))
+    {
+        std::cerr << corpusPath << ": Korpus nicht lesbar" << std::endl;
+        return 1;
+    }
+
+    int numFailed = runSwapEquivalence(programs, input, engines);
+    numFailed += runStress(programs, input, numEdits, seed);
+    numFailed += runLifetime(programs, input);
+    return numFailed > 0 ? 1 : 0;
+}
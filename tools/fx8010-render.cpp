@@ -0,0 +1,690 @@
+// Copyright 2023 Klangraum
+// fx8010-render: WAV Dateien offline durch ein Programm rechnen (z.B. Stems im Stapel)
+//
+// Aufruf: fx8010-render [Optionen] programm.da|programm.dab eingabe.wav ausgabe.wav [eingabe.wav ausgabe.wav ...]
+//   -e   Engine: switch, decoded (Standard), jit, fixed
+//   -O0  ohne Optimierer (nur fuer .da)
+//   -f   Ausgabeformat: 16, 24, 32 (int) oder float, Standard wie die Eingabe
+//   -b   Frames je Block (Standard 8192)
+//   -j   Dateien gleichzeitig (Standard: Anzahl Hardware-Threads)
+//   -t   Nachlauf in Sekunden (Stille am Eingang, z.B. fuer Hall), Standard 0
+// Eingabe: PCM 16/24/32 Bit oder 32 Bit float, beliebig viele Kanaele (auch WAVE_FORMAT_EXTENSIBLE).
+// Das Programm bekommt so viele Kanaele wie die Datei, die Samplerate der Datei ist die Hostrate
+// (Resampler, siehe setHostSampleRate()), dessen Latenz wird ausgeglichen.
+//
+// Je Datei laufen drei Stufen ueberlappt: Lesen + PCM -> float, processBlock(), float -> PCM + Schreiben.
+// Zwischen den Stufen kreisen NUM_BLOCKS Bloecke (je Uebergabe doppelt gepuffert). Die Wandlung laeuft in
+// Stuecken zu SIMD_WIDTH Samples, die der Compiler vektorisiert (wie FX8010Resampler).
+// NOTE: WAV ist Little Endian, das Tool setzt einen Little Endian Rechner voraus (x86, ARM).
+//
+// Build (aus dem Repository-Verzeichnis):
+//   g++ -std=c++17 -O3 tools/fx8010-render.cpp source/[!m]*.cpp -o fx8010-render -lpthread
+
+#include "../include/FX8010.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using Klangraum::FX8010;
+
+namespace
+{
+    const int SIMD_WIDTH = 8;
+    const int NUM_BLOCKS = 4;
+    const uint16_t WAVE_FORMAT_PCM = 1;
+    const uint16_t WAVE_FORMAT_IEEE_FLOAT = 3;
+    const uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+    struct WavFormat
+    {
+        int channels = 0;
+        int sampleRate = 0;
+        int bits = 0;         // 16, 24, 32
+        bool isFloat = false; // nur mit 32 Bit
+        inline int getBytesPerFrame() const { return channels * bits / 8; }
+    };
+
+    inline uint16_t readU16(const uint8_t *p) { return static_cast<uint16_t>(p[0] | p[1] << 8); }
+    inline uint32_t readU32(const uint8_t *p) { return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24; }
+    inline void writeU16(uint8_t *p, uint32_t value)
+    {
+        p[0] = static_cast<uint8_t>(value);
+        p[1] = static_cast<uint8_t>(value >> 8);
+    }
+    inline void writeU32(uint8_t *p, uint32_t value)
+    {
+        writeU16(p, value);
+        writeU16(p + 2, value >> 16);
+    }
+
+    // WAV Datei lesen
+    //--------------------------------------------------------------------------------
+
+    class WavReader
+    {
+    public:
+        ~WavReader()
+        {
+            if (file != nullptr)
+                fclose(file);
+        }
+
+        bool open(const std::string &path, std::string &error)
+        {
+            file = fopen(path.c_str(), "rb");
+            if (file == nullptr)
+            {
+                error = "nicht lesbar";
+                return false;
+            }
+            uint8_t riff[12];
+            if (fread(riff, 1, sizeof(riff), file) != sizeof(riff) || memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0)
+            {
+                error = "keine WAV Datei";
+                return false;
+            }
+            // Chunks bis "data" durchgehen, "fmt " muss vorher kommen
+            bool hasFormat = false;
+            uint8_t chunk[8];
+            while (fread(chunk, 1, sizeof(chunk), file) == sizeof(chunk))
+            {
+                const uint32_t chunkSize = readU32(chunk + 4);
+                if (memcmp(chunk, "fmt ", 4) == 0)
+                {
+                    uint8_t fmt[40] = {};
+                    const uint32_t fmtSize = std::min<uint32_t>(chunkSize, sizeof(fmt));
+                    if (chunkSize < 16 || fread(fmt, 1, fmtSize, file) != fmtSize)
+                    {
+                        error = "fmt Chunk defekt";
+                        return false;
+                    }
+                    uint16_t tag = readU16(fmt);
+                    // Extensible: Format steht in den ersten zwei Bytes der SubFormat GUID
+                    if (tag == WAVE_FORMAT_EXTENSIBLE && chunkSize >= 26)
+                        tag = readU16(fmt + 24);
+                    format.channels = readU16(fmt + 2);
+                    format.sampleRate = static_cast<int>(readU32(fmt + 4));
+                    format.bits = readU16(fmt + 14);
+                    format.isFloat = tag == WAVE_FORMAT_IEEE_FLOAT;
+                    const bool supported = (tag == WAVE_FORMAT_PCM && (format.bits == 16 || format.bits == 24 || format.bits == 32)) || (format.isFloat && format.bits == 32);
+                    if (!supported || format.channels < 1 || format.sampleRate < 1)
+                    {
+                        error = "Format nicht unterstuetzt (Tag " + std::to_string(tag) + ", " + std::to_string(format.bits) + " Bit)";
+                        return false;
+                    }
+                    hasFormat = true;
+                    const uint32_t rest = chunkSize - fmtSize + (chunkSize & 1);
+                    if (rest > 0 && fseek(file, static_cast<long>(rest), SEEK_CUR) != 0)
+                        break;
+                }
+                else if (memcmp(chunk, "data", 4) == 0)
+                {
+                    if (!hasFormat)
+                    {
+                        error = "data vor fmt";
+                        return false;
+                    }
+                    framesLeft = chunkSize / format.getBytesPerFrame();
+                    numFrames = framesLeft;
+                    return true;
+                }
+                // Unbekannte Chunks ueberspringen (auf gerade Laenge aufgefuellt)
+                else if (fseek(file, static_cast<long>(chunkSize + (chunkSize & 1)), SEEK_CUR) != 0)
+                    break;
+            }
+            error = "kein data Chunk";
+            return false;
+        }
+
+        // Rueckgabe gelesene Frames, 0 am Ende
+        int read(uint8_t *pcm, int frames)
+        {
+            frames = static_cast<int>(std::min<uint64_t>(frames, framesLeft));
+            const size_t bytes = static_cast<size_t>(frames) * format.getBytesPerFrame();
+            const size_t got = fread(pcm, 1, bytes, file);
+            // Kuerzere Datei als im Header: Rest ist Stille
+            if (got < bytes)
+            {
+                memset(pcm + got, 0, bytes - got);
+                framesLeft = frames;
+            }
+            framesLeft -= frames;
+            return frames;
+        }
+
+        inline const WavFormat &getFormat() const { return format; }
+        inline uint64_t getNumFrames() const { return numFrames; }
+
+    private:
+        FILE *file = nullptr;
+        WavFormat format;
+        uint64_t numFrames = 0;
+        uint64_t framesLeft = 0;
+    };
+
+    // WAV Datei schreiben (Groessen werden in close() eingetragen)
+    //--------------------------------------------------------------------------------
+
+    class WavWriter
+    {
+    public:
+        ~WavWriter() { close(); }
+
+        bool open(const std::string &path, const WavFormat &format_)
+        {
+            format = format_;
+            file = fopen(path.c_str(), "wb");
+            if (file == nullptr)
+                return false;
+            uint8_t header[HEADER_SIZE] = {};
+            writeHeader(header, 0);
+            return fwrite(header, 1, sizeof(header), file) == sizeof(header);
+        }
+
+        bool write(const uint8_t *pcm, int frames)
+        {
+            const size_t bytes = static_cast<size_t>(frames) * format.getBytesPerFrame();
+            dataBytes += bytes;
+            return fwrite(pcm, 1, bytes, file) == bytes;
+        }
+
+        bool close()
+        {
+            if (file == nullptr)
+                return true;
+            bool success = dataBytes <= 0xFFFFFFFFULL - HEADER_SIZE;
+            if (dataBytes & 1)
+                success = success && fputc(0, file) != EOF;
+            uint8_t header[HEADER_SIZE];
+            writeHeader(header, static_cast<uint32_t>(dataBytes));
+            success = success && fseek(file, 0, SEEK_SET) == 0 && fwrite(header, 1, sizeof(header), file) == sizeof(header);
+            success = (fclose(file) == 0) && success;
+            file = nullptr;
+            return success;
+        }
+
+    private:
+        // RIFF, fmt (Extensible, 40 Bytes), data
+        static const int HEADER_SIZE = 12 + 8 + 40 + 8;
+
+        FILE *file = nullptr;
+        WavFormat format;
+        uint64_t dataBytes = 0;
+
+        void writeHeader(uint8_t *header, uint32_t dataSize)
+        {
+            // Sub-Format GUID xxxxxxxx-0000-0010-8000-00aa00389b71
+            static const uint8_t GUID_TAIL[14] = {0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+            const uint32_t blockAlign = format.getBytesPerFrame();
+            memcpy(header, "RIFF", 4);
+            writeU32(header + 4, HEADER_SIZE - 8 + dataSize + (dataSize & 1));
+            memcpy(header + 8, "WAVEfmt ", 8);
+            writeU32(header + 16, 40);
+            writeU16(header + 20, WAVE_FORMAT_EXTENSIBLE);
+            writeU16(header + 22, format.channels);
+            writeU32(header + 24, format.sampleRate);
+            writeU32(header + 28, format.sampleRate * blockAlign);
+            writeU16(header + 32, blockAlign);
+            writeU16(header + 34, format.bits);
+            writeU16(header + 36, 22);
+            writeU16(header + 38, format.bits);
+            writeU32(header + 40, 0); // Kanalmaske: keine Zuordnung
+            writeU16(header + 44, format.isFloat ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM);
+            memcpy(header + 46, GUID_TAIL, sizeof(GUID_TAIL));
+            memcpy(header + 60, "data", 4);
+            writeU32(header + 64, dataSize);
+        }
+    };
+
+    // PCM <-> float, interleaved
+    // Stuecke zu SIMD_WIDTH: memcpy in ein lokales Array (kein Aliasing), die innere Schleife
+    // hat keine Verzweigung und wird vektorisiert.
+    //--------------------------------------------------------------------------------
+
+    template <typename T>
+    void intToFloat(const uint8_t *pcm, float *samples, size_t n, float scale)
+    {
+        size_t i = 0;
+        for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+        {
+            T chunk[SIMD_WIDTH];
+            memcpy(chunk, pcm + i * sizeof(T), sizeof(chunk));
+            for (int l = 0; l < SIMD_WIDTH; l++)
+                samples[i + l] = static_cast<float>(chunk[l]) * scale;
+        }
+        for (; i < n; i++)
+        {
+            T sample;
+            memcpy(&sample, pcm + i * sizeof(T), sizeof(T));
+            samples[i] = static_cast<float>(sample) * scale;
+        }
+    }
+
+    void pcmToFloat(const uint8_t *pcm, float *samples, size_t n, const WavFormat &format)
+    {
+        if (format.isFloat)
+            memcpy(samples, pcm, n * sizeof(float));
+        else if (format.bits == 16)
+            intToFloat<int16_t>(pcm, samples, n, 1.0f / 32768.0f);
+        else if (format.bits == 32)
+            intToFloat<int32_t>(pcm, samples, n, 1.0f / 2147483648.0f);
+        else
+        {
+            // 24 Bit in die oberen Bytes eines int32 (Vorzeichen stimmt ohne Shift)
+            for (size_t i = 0; i < n; i++)
+            {
+                const uint8_t *p = pcm + i * 3;
+                const uint32_t value = static_cast<uint32_t>(p[0]) << 8 | static_cast<uint32_t>(p[1]) << 16 | static_cast<uint32_t>(p[2]) << 24;
+                samples[i] = static_cast<float>(static_cast<int32_t>(value)) * (1.0f / 2147483648.0f);
+            }
+        }
+    }
+
+    // Gleiche Skalierung wie beim Lesen (2^(Bits-1)), runden (halbe Werte von Null weg), dann auf den
+    // Wertebereich begrenzen: 16/24 Bit PCM -> float -> PCM ist verlustfrei
+    template <typename T, typename S>
+    inline T quantize(float sample, S scale, S maximum)
+    {
+        const S x = static_cast<S>(sample) * scale;
+        return static_cast<T>(std::min(std::max(x + (x < 0 ? S(-0.5) : S(0.5)), -scale), maximum));
+    }
+
+    template <typename T, typename S>
+    void floatToInt(const float *samples, uint8_t *pcm, size_t n, S scale)
+    {
+        const S maximum = scale - 1;
+        size_t i = 0;
+        for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+        {
+            T chunk[SIMD_WIDTH];
+            for (int l = 0; l < SIMD_WIDTH; l++)
+                chunk[l] = quantize<T, S>(samples[i + l], scale, maximum);
+            memcpy(pcm + i * sizeof(T), chunk, sizeof(chunk));
+        }
+        for (; i < n; i++)
+        {
+            const T sample = quantize<T, S>(samples[i], scale, maximum);
+            memcpy(pcm + i * sizeof(T), &sample, sizeof(T));
+        }
+    }
+
+    void floatToPcm(const float *samples, uint8_t *pcm, size_t n, const WavFormat &format)
+    {
+        if (format.isFloat)
+            memcpy(pcm, samples, n * sizeof(float));
+        else if (format.bits == 16)
+            floatToInt<int16_t, float>(samples, pcm, n, 32768.0f);
+        else if (format.bits == 32)
+            floatToInt<int32_t, double>(samples, pcm, n, 2147483648.0);
+        else
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                const int32_t value = quantize<int32_t, float>(samples[i], 8388608.0f, 8388607.0f);
+                pcm[i * 3] = static_cast<uint8_t>(value);
+                pcm[i * 3 + 1] = static_cast<uint8_t>(value >> 8);
+                pcm[i * 3 + 2] = static_cast<uint8_t>(value >> 16);
+            }
+        }
+    }
+
+    // Pipeline
+    //--------------------------------------------------------------------------------
+
+    struct Block
+    {
+        std::vector<uint8_t> pcm;
+        std::vector<float> interleaved;
+        std::vector<float> input; // planar, Kanal * blockFrames
+        std::vector<float> output;
+        int frames = 0; // 0: Ende
+    };
+
+    // Uebergabe zwischen zwei Stufen
+    class BlockQueue
+    {
+    public:
+        void push(Block *block)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                blocks.push_back(block);
+            }
+            signal.notify_one();
+        }
+
+        Block *pop()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            signal.wait(lock, [this]
+                        { return !blocks.empty(); });
+            Block *block = blocks.front();
+            blocks.pop_front();
+            return block;
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable signal;
+        std::deque<Block *> blocks;
+    };
+
+    struct Settings
+    {
+        FX8010::EngineType engineType = FX8010::ENGINE_DECODED;
+        int outputBits = 0; // 0: wie Eingabe, -1: float
+        int blockFrames = 8192;
+        double tailSeconds = 0.0;
+    };
+
+    struct Job
+    {
+        std::string inputPath;
+        std::string outputPath;
+        // Ergebnis
+        bool success = false;
+        std::string error = "";
+        uint64_t frames = 0;
+        int sampleRate = 0;
+        uint64_t instructions = 0;
+        double seconds = 0.0;
+    };
+
+    // CHECKED
+    void render(Job &job, const std::vector<uint8_t> &bytecode, const Settings &settings)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        WavReader reader;
+        if (!reader.open(job.inputPath, job.error))
+            return;
+        const WavFormat inputFormat = reader.getFormat();
+        WavFormat outputFormat = inputFormat;
+        if (settings.outputBits != 0)
+        {
+            outputFormat.isFloat = settings.outputBits < 0;
+            outputFormat.bits = outputFormat.isFloat ? 32 : settings.outputBits;
+        }
+        const int channels = inputFormat.channels;
+
+        FX8010 dsp(channels);
+        if (!dsp.setHostSampleRate(inputFormat.sampleRate))
+        {
+            job.error = "Samplerate " + std::to_string(inputFormat.sampleRate) + " nicht unterstuetzt";
+            return;
+        }
+        dsp.setEngineType(settings.engineType);
+        if (!dsp.loadBytecodeFromMemory(bytecode.data(), bytecode.size()))
+        {
+            const std::vector<FX8010::MyError> errors = dsp.getErrorList();
+            job.error = errors.back().errorDescription + " (" + std::to_string(channels) + " Kanaele)";
+            return;
+        }
+
+        WavWriter writer;
+        if (!writer.open(job.outputPath, outputFormat))
+        {
+            job.error = job.outputPath + " kann nicht geschrieben werden";
+            return;
+        }
+
+        // Nachlauf und Resampler-Latenz: Stille hinterher, die ersten latency Frames verwerfen
+        const uint64_t latency = static_cast<uint64_t>(dsp.getLatency());
+        const uint64_t outputFrames = reader.getNumFrames() + static_cast<uint64_t>(settings.tailSeconds * inputFormat.sampleRate);
+        const int blockFrames = settings.blockFrames;
+
+        Block blocks[NUM_BLOCKS];
+        BlockQueue freeBlocks, readBlocks, processedBlocks;
+        for (Block &block : blocks)
+        {
+            block.pcm.resize(static_cast<size_t>(blockFrames) * channels * 4);
+            block.interleaved.resize(static_cast<size_t>(blockFrames) * channels);
+            block.input.resize(static_cast<size_t>(blockFrames) * channels);
+            block.output.resize(static_cast<size_t>(blockFrames) * channels);
+            freeBlocks.push(&block);
+        }
+
+        // Stufe 1: Lesen, PCM -> float, deinterleave
+        std::thread readThread([&]
+                               {
+            uint64_t remaining = outputFrames + latency;
+            for (;;)
+            {
+                Block *block = freeBlocks.pop();
+                block->frames = static_cast<int>(std::min<uint64_t>(blockFrames, remaining));
+                remaining -= block->frames;
+                if (block->frames > 0)
+                {
+                    const int got = reader.read(block->pcm.data(), block->frames);
+                    pcmToFloat(block->pcm.data(), block->interleaved.data(), static_cast<size_t>(got) * channels, inputFormat);
+                    std::fill(block->interleaved.begin() + static_cast<size_t>(got) * channels, block->interleaved.begin() + static_cast<size_t>(block->frames) * channels, 0.0f);
+                    for (int c = 0; c < channels; c++)
+                    {
+                        float *planar = block->input.data() + static_cast<size_t>(c) * blockFrames;
+                        for (int i = 0; i < block->frames; i++)
+                            planar[i] = block->interleaved[static_cast<size_t>(i) * channels + c];
+                    }
+                }
+                // Nach push() gehoert der Block der naechsten Stufe
+                const bool last = block->frames == 0;
+                readBlocks.push(block);
+                if (last)
+                    break;
+            } });
+
+        // Stufe 3: interleave, float -> PCM, Schreiben
+        bool writeSuccess = true;
+        std::thread writeThread([&]
+                                {
+            uint64_t skip = latency;
+            for (;;)
+            {
+                Block *block = processedBlocks.pop();
+                const int frames = block->frames;
+                if (frames == 0)
+                    break;
+                const int first = static_cast<int>(std::min<uint64_t>(skip, frames));
+                skip -= first;
+                for (int c = 0; c < channels; c++)
+                {
+                    const float *planar = block->output.data() + static_cast<size_t>(c) * blockFrames;
+                    for (int i = first; i < frames; i++)
+                        block->interleaved[static_cast<size_t>(i - first) * channels + c] = planar[i];
+                }
+                floatToPcm(block->interleaved.data(), block->pcm.data(), static_cast<size_t>(frames - first) * channels, outputFormat);
+                writeSuccess = writer.write(block->pcm.data(), frames - first) && writeSuccess;
+                freeBlocks.push(block);
+            } });
+
+        // Stufe 2 (dieser Thread): Programm rechnen
+        std::vector<const float *> inputs(channels);
+        std::vector<float *> outputs(channels);
+        for (;;)
+        {
+            Block *block = readBlocks.pop();
+            if (block->frames > 0)
+            {
+                for (int c = 0; c < channels; c++)
+                {
+                    inputs[c] = block->input.data() + static_cast<size_t>(c) * blockFrames;
+                    outputs[c] = block->output.data() + static_cast<size_t>(c) * blockFrames;
+                }
+                // Zaehler ist int, die Differenz je Block passt
+                const uint32_t before = static_cast<uint32_t>(dsp.getInstructionCounter());
+                dsp.processBlock(inputs.data(), outputs.data(), block->frames);
+                job.instructions += static_cast<uint32_t>(static_cast<uint32_t>(dsp.getInstructionCounter()) - before);
+            }
+            const bool last = block->frames == 0;
+            processedBlocks.push(block);
+            if (last)
+                break;
+        }
+        readThread.join();
+        writeThread.join();
+
+        job.success = writer.close() && writeSuccess;
+        if (!job.success)
+            job.error = job.outputPath + " kann nicht geschrieben werden";
+        job.frames = outputFrames;
+        job.sampleRate = inputFormat.sampleRate;
+        auto end = std::chrono::high_resolution_clock::now();
+        job.seconds = std::chrono::duration<double>(end - start).count();
+    }
+
+    bool endsWith(const std::string &text, const std::string &suffix)
+    {
+        return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Settings settings;
+    bool optimize = true;
+    int numJobs = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::string> files;
+    bool valid = true;
+    for (int i = 1; i < argc && valid; i++)
+    {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (argument == "-O0")
+            optimize = false;
+        else if (argument == "-e" && hasValue)
+        {
+            const std::string engine = argv[++i];
+            if (engine == "switch")
+                settings.engineType = FX8010::ENGINE_SWITCH;
+            else if (engine == "decoded")
+                settings.engineType = FX8010::ENGINE_DECODED;
+            else if (engine == "jit")
+                settings.engineType = FX8010::ENGINE_JIT;
+            else if (engine == "fixed")
+                settings.engineType = FX8010::ENGINE_FIXED;
+            else
+                valid = false;
+        }
+        else if (argument == "-f" && hasValue)
+        {
+            const std::string format = argv[++i];
+            settings.outputBits = (format == "float") ? -1 : std::atoi(format.c_str());
+            valid = settings.outputBits == -1 || settings.outputBits == 16 || settings.outputBits == 24 || settings.outputBits == 32;
+        }
+        else if (argument == "-b" && hasValue)
+        {
+            settings.blockFrames = std::atoi(argv[++i]);
+            valid = settings.blockFrames > 0;
+        }
+        else if (argument == "-j" && hasValue)
+        {
+            numJobs = std::atoi(argv[++i]);
+            valid = numJobs > 0;
+        }
+        else if (argument == "-t" && hasValue)
+        {
+            settings.tailSeconds = std::atof(argv[++i]);
+            valid = settings.tailSeconds >= 0.0;
+        }
+        else
+            files.push_back(argument);
+    }
+    if (!valid || files.size() < 3 || files.size() % 2 != 1)
+    {
+        std::cerr << "Aufruf: fx8010-render [-e switch|decoded|jit|fixed] [-O0] [-f 16|24|32|float] [-b frames] [-j dateien] [-t sekunden]" << std::endl;
+        std::cerr << "                     programm.da|programm.dab eingabe.wav ausgabe.wav [eingabe.wav ausgabe.wav ...]" << std::endl;
+        return 2;
+    }
+
+    std::vector<Job> jobs(files.size() / 2);
+    int maxChannels = 1;
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        jobs[i].inputPath = files[1 + 2 * i];
+        jobs[i].outputPath = files[2 + 2 * i];
+        WavReader reader;
+        std::string error;
+        if (reader.open(jobs[i].inputPath, error))
+            maxChannels = std::max(maxChannels, reader.getFormat().channels);
+    }
+
+    // Programm einmal uebersetzen, jede Datei startet eine Instanz aus dem Bytecode. Die I/O Indizes
+    // prueft erst das Laden gegen die Kanalzahl der jeweiligen Datei.
+    std::vector<uint8_t> bytecode;
+    const std::string &programPath = files[0];
+    if (endsWith(programPath, ".dab"))
+    {
+        Klangraum::BytecodeFile file(programPath);
+        if (file.isOpen())
+        {
+            const uint8_t *bytes = static_cast<const uint8_t *>(file.data());
+            bytecode.assign(bytes, bytes + file.getSize());
+        }
+    }
+    else
+    {
+        FX8010 program(maxChannels);
+        program.setOptimizerEnabled(optimize);
+        if (program.loadFile(programPath))
+            bytecode = program.getBytecode();
+        else
+        {
+            const std::vector<FX8010::MyError> errors = program.getErrorList();
+            for (size_t i = 1; i < errors.size(); i++)
+                std::cerr << programPath << ":" << errors[i].errorRow << ": " << errors[i].errorDescription << std::endl;
+        }
+    }
+    if (bytecode.empty())
+    {
+        std::cerr << programPath << ": Programm kann nicht geladen werden" << std::endl;
+        return 1;
+    }
+
+    // Dateien gleichzeitig, je Datei ein Rechen-Thread plus Lese- und Schreib-Thread
+    auto start = std::chrono::high_resolution_clock::now();
+    std::atomic<size_t> nextJob{0};
+    std::mutex printMutex;
+    std::vector<std::thread> workers;
+    for (int w = 0; w < std::min<int>(numJobs, static_cast<int>(jobs.size())); w++)
+        workers.emplace_back([&]
+                             {
+            for (size_t i = nextJob++; i < jobs.size(); i = nextJob++)
+            {
+                Job &job = jobs[i];
+                render(job, bytecode, settings);
+                std::lock_guard<std::mutex> lock(printMutex);
+                if (job.success)
+                    std::cout << job.inputPath << " -> " << job.outputPath << ": " << static_cast<double>(job.frames) / job.sampleRate << " s, Echtzeitfaktor "
+                              << static_cast<double>(job.frames) / job.sampleRate / job.seconds << ", " << job.instructions / job.seconds / 1e6 << " MIPS" << std::endl;
+                else
+                    std::cerr << job.inputPath << ": " << job.error << std::endl;
+            } });
+    for (auto &worker : workers)
+        worker.join();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    // Summe: Audiodauer aller Dateien gegen die Wanduhr
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    double audioSeconds = 0.0;
+    uint64_t instructions = 0;
+    int numFailed = 0;
+    for (const Job &job : jobs)
+    {
+        if (!job.success)
+        {
+            numFailed++;
+            continue;
+        }
+        audioSeconds += static_cast<double>(job.frames) / job.sampleRate;
+        instructions += job.instructions;
+    }
+    std::cout << jobs.size() - numFailed << " von " << jobs.size() << " Dateien, " << audioSeconds << " s Audio in " << seconds << " s: Echtzeitfaktor "
+              << audioSeconds / seconds << ", " << instructions / seconds / 1e6 << " MIPS" << std::endl;
+    return (numFailed > 0) ? 1 : 0;
+}